@@ -0,0 +1,679 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Microbenchmarks of the hot paths of the plugin: frame, event and config
+ * serialization, the event queue, the config handlers, the channel stores
+ * and the cost of the metrics. Each runs until it has taken at least the
+ * minimum time and reports nanoseconds, heap bytes and heap allocations per
+ * operation.
+ * Allocations of every thread the benchmark uses are counted.
+ *
+ * Usage: bench_micro [--json] [--time seconds] [--baseline file] [filter]
+ * --json prints the results as JSON, --baseline compares them with a
+ * previous JSON run and only benchmarks whose name contains filter run.
+ */
+
+#include "allocation_stats.h"
+#include "config_handler.h"
+#include "event_queue.h"
+#include "json_telemetry_serializer.h"
+#include "metrics.h"
+#include "synthetic_config.h"
+#include "telemetry.h"
+#include "telemetry_channels.h"
+
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifndef TSTS_ALLOCATION_STATS
+#error "Needs the operator new replacement of TSTS_ALLOCATION_STATS"
+#endif
+
+bool frameChanged = false;
+
+namespace {
+
+#define DEFAULT_MIN_TIME 0.5
+#define MAX_ITERATIONS 1000000000ULL
+/* About the size of a frame with one trailer in the standard dialect */
+#define QUEUE_MESSAGE_SIZE 4096
+
+using Clock = std::chrono::steady_clock;
+
+void allocation_totals(uint64_t *allocations, uint64_t *bytes) {
+  AllocationThreadStats threads[ALLOCATION_MAX_THREADS];
+  const size_t count = AllocationStats::Collect(threads);
+  *allocations = 0;
+  *bytes = 0;
+  for (size_t i = 0; i < count; i++) {
+    for (const AllocationCounter &stage : threads[i].stages) {
+      *allocations += stage.allocations;
+      *bytes += stage.bytes;
+    }
+  }
+}
+
+/* Handed to every benchmark, which runs its setup before Start */
+class Timer {
+public:
+  explicit Timer(uint64_t iterations) : m_iterations(iterations) {}
+  uint64_t Iterations() const { return m_iterations; }
+  void Start() {
+    allocation_totals(&m_allocations, &m_bytes);
+    m_start = Clock::now();
+  }
+  void Stop() {
+    const auto stop = Clock::now();
+    uint64_t allocations, bytes;
+    allocation_totals(&allocations, &bytes);
+    m_nanoseconds =
+        std::chrono::duration<double, std::nano>(stop - m_start).count();
+    m_allocations = allocations - m_allocations;
+    m_bytes = bytes - m_bytes;
+  }
+  double Nanoseconds() const { return m_nanoseconds; }
+  uint64_t Allocations() const { return m_allocations; }
+  uint64_t Bytes() const { return m_bytes; }
+
+private:
+  uint64_t m_iterations;
+  Clock::time_point m_start;
+  double m_nanoseconds = 0.0;
+  uint64_t m_allocations = 0;
+  uint64_t m_bytes = 0;
+};
+
+struct Benchmark {
+  const char *name;
+  void (*run)(Timer &timer);
+};
+
+struct Result {
+  std::string name;
+  uint64_t iterations;
+  double nsPerOp;
+  double bytesPerOp;
+  double allocsPerOp;
+};
+
+/* Moves every value away from its default, like a frame on the road */
+void set_value(scs_value_t *value, scs_u32_t n) {
+  const double x = 1.5 + n;
+  switch (value->type) {
+  case SCS_VALUE_TYPE_bool:
+    value->value_bool.value = 1;
+    break;
+  case SCS_VALUE_TYPE_s32:
+    value->value_s32.value = static_cast<scs_s32_t>(n % 13) - 6;
+    break;
+  case SCS_VALUE_TYPE_u32:
+    value->value_u32.value = n + 1;
+    break;
+  case SCS_VALUE_TYPE_float:
+    value->value_float.value = static_cast<scs_float_t>(x * 0.37);
+    break;
+  case SCS_VALUE_TYPE_double:
+    value->value_double.value = x * 1234.5678;
+    break;
+  case SCS_VALUE_TYPE_dvector:
+    value->value_dvector = {x, -x, 0.25 * x};
+    break;
+  case SCS_VALUE_TYPE_dplacement:
+    value->value_dplacement.position = {12345.678 * x, 45.5, -9876.54 * x};
+    value->value_dplacement.orientation = {0.125f, 0.01f, -0.002f};
+    break;
+  default:
+    break;
+  }
+}
+
+struct Call {
+  scs_string_t name;
+  scs_u32_t index;
+  scs_telemetry_channel_callback_t callback;
+  scs_context_t context;
+  scs_value_t value;
+};
+
+/* The callbacks the game makes for a truck and the trailers in use */
+std::vector<Call> channel_calls(TelemetryFrame *frame, scs_u32_t trailers,
+                                scs_u32_t wheels) {
+  std::vector<Call> calls;
+  for (const ChannelEntry &channel : TelemetryChannels::Table) {
+    Call call = {};
+    call.name = channel.name;
+    call.callback = channel.callback;
+    call.value.type = channel.type;
+    const scs_u32_t vehicles =
+        TelemetryChannels::IsTrailerScope(channel.scope) ? trailers : 1;
+    const scs_u32_t count = channel.scope == ChannelScope::TruckWheel ||
+                                    channel.scope == ChannelScope::TrailerWheel
+                                ? wheels
+                                : 1;
+    for (scs_u32_t i = 0; i < vehicles; ++i) {
+      for (scs_u32_t j = 0; j < count; ++j) {
+        call.index = count > 1 ? j : SCS_U32_NIL;
+        call.context = channel.target(frame, i, j);
+        set_value(&call.value, static_cast<scs_u32_t>(calls.size()));
+        calls.push_back(call);
+      }
+    }
+  }
+  return calls;
+}
+
+/* A frame as the plugin has it after the configuration and one frame */
+void fill_frame(TelemetryFrame *frame, scs_u32_t trailers, scs_u32_t wheels) {
+  const SyntheticConfig::Attributes truck = SyntheticConfig::Truck(wheels);
+  const SyntheticConfig::Attributes trailer = SyntheticConfig::Trailer(wheels);
+  const SyntheticConfig::Attributes job = SyntheticConfig::Job();
+  const SyntheticConfig::Attributes controls = SyntheticConfig::Controls();
+  ConfigHandler::HandleTruckConfig(truck.data(), &frame->truck);
+  ConfigHandler::HandleControlConfig(controls.data(), &frame->truck);
+  ConfigHandler::HandleJobConfig(job.data(), &frame->job);
+  for (scs_u32_t i = 0; i < trailers; i++) {
+    ConfigHandler::HandleTrailerConfig(trailer.data(), &frame->trailer[i]);
+  }
+  for (const Call &call : channel_calls(frame, trailers, wheels)) {
+    call.callback(call.name, call.index, &call.value, call.context);
+  }
+}
+
+void serialize_frame(Timer &timer, scs_u32_t trailers, scs_u32_t wheels) {
+  static TelemetryFrame frame;
+  frame = TelemetryFrame{};
+  if (trailers > 0) {
+    fill_frame(&frame, trailers, wheels);
+  }
+  JsonTelemetrySerializer serializer;
+  /* Reused like the pooled message buffers */
+  std::string out;
+  serializer.SerializeFrame(&frame, &out);
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    serializer.SerializeFrame(&frame, &out);
+  }
+  timer.Stop();
+}
+
+void bench_serialize_frame_empty(Timer &timer) {
+  serialize_frame(timer, 0, 0);
+}
+
+void bench_serialize_frame_typical(Timer &timer) {
+  serialize_frame(timer, 1, 6);
+}
+
+void bench_serialize_frame_worst(Timer &timer) {
+  serialize_frame(timer, MAX_TRAILERS, MAX_WHEEL_COUNT);
+}
+
+void add_attribute(TelemetryGameplayEvent *event, std::string_view name,
+                   scs_value_t value) {
+  TelemetryGameplayAttribute &attribute =
+      event->attributes[event->attributeCount++];
+  attribute.name = name;
+  attribute.key = gameplay_attribute_key(name);
+  attribute.value = value;
+}
+
+scs_value_t string_value(scs_string_t text) {
+  scs_value_t value = {};
+  value.type = SCS_VALUE_TYPE_string;
+  value.value_string.value = text;
+  return value;
+}
+
+scs_value_t s64_value(scs_s64_t number) {
+  scs_value_t value = {};
+  value.type = SCS_VALUE_TYPE_s64;
+  value.value_s64.value = number;
+  return value;
+}
+
+void serialize_event(Timer &timer, const TelemetryGameplayEvent &source) {
+  TelemetryGameplayEvent event = source;
+  JsonTelemetrySerializer serializer;
+  std::string out;
+  out.reserve(GAMEPLAY_EVENT_RESERVE);
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    serializer.SerializeEvent(&event, &out);
+  }
+  timer.Stop();
+}
+
+void bench_serialize_event_fined(Timer &timer) {
+  TelemetryGameplayEvent event;
+  event.eventType = "player.fined";
+  add_attribute(&event, "fine.offence", string_value("speeding"));
+  add_attribute(&event, "fine.amount", s64_value(300));
+  serialize_event(timer, event);
+}
+
+void bench_serialize_event_ferry(Timer &timer) {
+  TelemetryGameplayEvent event;
+  event.eventType = "player.use.ferry";
+  add_attribute(&event, "pay.amount", s64_value(800));
+  add_attribute(&event, "source.name", string_value("Rostock"));
+  add_attribute(&event, "target.name", string_value("Trelleborg"));
+  add_attribute(&event, "source.id", string_value("rostock"));
+  add_attribute(&event, "target.id", string_value("trelleborg"));
+  serialize_event(timer, event);
+}
+
+void bench_serialize_config_truck(Timer &timer) {
+  static TelemetryFrame frame;
+  frame = TelemetryFrame{};
+  fill_frame(&frame, 1, 6);
+  JsonTelemetrySerializer serializer;
+  std::string out;
+  serializer.SerializeConfig(&frame, TelemetryConfigBlock::Truck, 0, &out);
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    serializer.SerializeConfig(&frame, TelemetryConfigBlock::Truck, 0, &out);
+  }
+  timer.Stop();
+}
+
+void push_message(EventQueue *queue) {
+  MessageRef message = queue->Acquire(QUEUE_MESSAGE_SIZE);
+  message->assign(QUEUE_MESSAGE_SIZE / 2, 'x');
+  queue->PushEvent(std::move(message), EVENT_FRAME);
+}
+
+void bench_event_queue_push_pop(Timer &timer) {
+  EventQueue queue;
+  push_message(&queue);
+  queue.PopEvent();
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    push_message(&queue);
+    queue.PopEvent();
+  }
+  timer.Stop();
+}
+
+/*
+ * One producer against consumers that keep polling the queue. The producer
+ * lets them catch up now and then, so the queue stays at its usual size.
+ */
+void event_queue_contended(Timer &timer, unsigned consumers) {
+  EventQueue queue;
+  std::atomic<bool> done = false;
+  std::vector<std::thread> threads;
+  for (unsigned c = 0; c < consumers; c++) {
+    threads.emplace_back([&]() {
+      AllocationScope scope(AllocationStage::Queue);
+      while (!done.load(std::memory_order_relaxed)) {
+        if (queue.PopEvent().type.empty()) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    push_message(&queue);
+    if (i % (EVENT_QUEUE_CAPACITY / 2) == EVENT_QUEUE_CAPACITY / 2 - 1) {
+      while (!queue.IsEmpty()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+  while (!queue.IsEmpty()) {
+    std::this_thread::yield();
+  }
+  timer.Stop();
+  done = true;
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+void bench_event_queue_contended_1(Timer &timer) {
+  event_queue_contended(timer, 1);
+}
+
+void bench_event_queue_contended_3(Timer &timer) {
+  event_queue_contended(timer, 3);
+}
+
+template <typename T>
+void handle_config(Timer &timer,
+                   void (*handle)(const scs_named_value_t *, T *),
+                   const SyntheticConfig::Attributes &attributes) {
+  static T target;
+  target = T{};
+  /* The first one sizes the strings, the game sends the same ones again */
+  handle(attributes.data(), &target);
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    handle(attributes.data(), &target);
+  }
+  timer.Stop();
+}
+
+void bench_config_truck(Timer &timer) {
+  handle_config(timer, ConfigHandler::HandleTruckConfig,
+                SyntheticConfig::Truck());
+}
+
+void bench_config_controls(Timer &timer) {
+  handle_config(timer, ConfigHandler::HandleControlConfig,
+                SyntheticConfig::Controls());
+}
+
+void bench_config_job(Timer &timer) {
+  handle_config(timer, ConfigHandler::HandleJobConfig, SyntheticConfig::Job());
+}
+
+void bench_config_trailer(Timer &timer) {
+  handle_config(timer, ConfigHandler::HandleTrailerConfig,
+                SyntheticConfig::Trailer());
+}
+
+/* Everything the game sends on load, with all ten trailers */
+void bench_config_burst(Timer &timer) {
+  static TelemetryFrame frame;
+  frame = TelemetryFrame{};
+  const SyntheticConfig::Attributes truck = SyntheticConfig::Truck();
+  const SyntheticConfig::Attributes trailer = SyntheticConfig::Trailer();
+  const SyntheticConfig::Attributes job = SyntheticConfig::Job();
+  const SyntheticConfig::Attributes controls = SyntheticConfig::Controls();
+  auto burst = [&]() {
+    ConfigHandler::HandleTruckConfig(truck.data(), &frame.truck);
+    ConfigHandler::HandleControlConfig(controls.data(), &frame.truck);
+    ConfigHandler::HandleJobConfig(job.data(), &frame.job);
+    for (TelemetryTrailer &t : frame.trailer) {
+      ConfigHandler::HandleTrailerConfig(trailer.data(), &t);
+    }
+  };
+  burst();
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    burst();
+  }
+  timer.Stop();
+}
+
+/* Called through a pointer the compiler can't see through, like the game */
+template <scs_value_type_t Type, typename T>
+void store(Timer &timer, const scs_value_t &value) {
+  static T target;
+  scs_telemetry_channel_callback_t volatile pointer =
+      ScsVariableSaver::StoreChannel<Type, T>;
+  const scs_telemetry_channel_callback_t callback = pointer;
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    callback("channel", SCS_U32_NIL, &value, &target);
+  }
+  timer.Stop();
+}
+
+template <scs_value_type_t Type, typename T> void store(Timer &timer) {
+  scs_value_t value = {};
+  value.type = Type;
+  set_value(&value, 7);
+  store<Type, T>(timer, value);
+}
+
+void bench_store_bool(Timer &timer) {
+  store<SCS_VALUE_TYPE_bool, bool>(timer);
+}
+
+void bench_store_s32(Timer &timer) {
+  store<SCS_VALUE_TYPE_s32, scs_s32_t>(timer);
+}
+
+void bench_store_u32(Timer &timer) {
+  store<SCS_VALUE_TYPE_u32, scs_u32_t>(timer);
+}
+
+void bench_store_float(Timer &timer) {
+  store<SCS_VALUE_TYPE_float, scs_double_t>(timer);
+}
+
+void bench_store_double(Timer &timer) {
+  store<SCS_VALUE_TYPE_double, scs_double_t>(timer);
+}
+
+void bench_store_dvector(Timer &timer) {
+  store<SCS_VALUE_TYPE_dvector, TelemetryVec3D>(timer);
+}
+
+void bench_store_dplacement(Timer &timer) {
+  store<SCS_VALUE_TYPE_dplacement, TelemetryPlacement>(timer);
+}
+
+void bench_store_string(Timer &timer) {
+  store<SCS_VALUE_TYPE_string, std::string>(timer,
+                                            string_value("vehicle.scania"));
+}
+
+/* One operation is one callback of the whole table, one trailer attached */
+void bench_store_channel_table(Timer &timer) {
+  static TelemetryFrame frame;
+  frame = TelemetryFrame{};
+  const std::vector<Call> calls = channel_calls(&frame, 1, 6);
+  size_t next = 0;
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    const Call &call = calls[next];
+    call.callback(call.name, call.index, &call.value, call.context);
+    next = next + 1 < calls.size() ? next + 1 : 0;
+  }
+  timer.Stop();
+}
+
+void bench_metrics_counter(Timer &timer) {
+  static MetricCounter counter;
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    counter.Add();
+  }
+  timer.Stop();
+}
+
+void bench_metrics_histogram(Timer &timer) {
+  static LatencyHistogram histogram;
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    histogram.Record(static_cast<int64_t>(1000 + (i & 0xffff)));
+  }
+  timer.Stop();
+}
+
+/* Everything the metrics add to a frame_end callback that emits a frame */
+void bench_metrics_frame_end(Timer &timer) {
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    CallbackTimer callback(MetricCallback::FrameEnd);
+    Metrics::Pipeline().framesEmitted.Add();
+    Metrics::CountMessage(MetricMessage::Frame, QUEUE_MESSAGE_SIZE, 1000,
+                          static_cast<int64_t>(41000 + (i & 0xfff)));
+  }
+  timer.Stop();
+}
+
+/* The part of a scrape that doesn't depend on the network thread */
+void bench_metrics_render(Timer &timer) {
+  std::string text;
+  timer.Start();
+  for (uint64_t i = 0; i < timer.Iterations(); i++) {
+    text.clear();
+    PrometheusWriter writer(&text);
+    Metrics::Render(&writer);
+  }
+  timer.Stop();
+}
+
+const Benchmark benchmarks[] = {
+    {"serialize_frame/empty", bench_serialize_frame_empty},
+    {"serialize_frame/typical", bench_serialize_frame_typical},
+    {"serialize_frame/worst", bench_serialize_frame_worst},
+    {"serialize_event/fined", bench_serialize_event_fined},
+    {"serialize_event/ferry", bench_serialize_event_ferry},
+    {"serialize_config/truck", bench_serialize_config_truck},
+    {"event_queue/push_pop", bench_event_queue_push_pop},
+    {"event_queue/contended/1", bench_event_queue_contended_1},
+    {"event_queue/contended/3", bench_event_queue_contended_3},
+    {"config/truck", bench_config_truck},
+    {"config/controls", bench_config_controls},
+    {"config/job", bench_config_job},
+    {"config/trailer", bench_config_trailer},
+    {"config/burst", bench_config_burst},
+    {"store/bool", bench_store_bool},
+    {"store/s32", bench_store_s32},
+    {"store/u32", bench_store_u32},
+    {"store/float", bench_store_float},
+    {"store/double", bench_store_double},
+    {"store/dvector", bench_store_dvector},
+    {"store/dplacement", bench_store_dplacement},
+    {"store/string", bench_store_string},
+    {"store/channel_table", bench_store_channel_table},
+    {"metrics/counter", bench_metrics_counter},
+    {"metrics/histogram", bench_metrics_histogram},
+    {"metrics/frame_end", bench_metrics_frame_end},
+    {"metrics/render", bench_metrics_render},
+};
+
+/* Grows the iteration count until a run takes the minimum time */
+Result run(const Benchmark &benchmark, double minTime) {
+  uint64_t iterations = 1;
+  for (;;) {
+    Timer timer(iterations);
+    benchmark.run(timer);
+    const double seconds = timer.Nanoseconds() / 1e9;
+    if (seconds >= minTime || iterations >= MAX_ITERATIONS) {
+      const double n = static_cast<double>(iterations);
+      return {benchmark.name, iterations, timer.Nanoseconds() / n,
+              static_cast<double>(timer.Bytes()) / n,
+              static_cast<double>(timer.Allocations()) / n};
+    }
+    /* Aim a fifth past the minimum, but at most a hundred times as many */
+    const double predicted =
+        seconds > 0.0 ? static_cast<double>(iterations) * minTime * 1.2 /
+                            seconds
+                      : static_cast<double>(iterations) * 100.0;
+    uint64_t next = static_cast<uint64_t>(predicted);
+    next = std::min(next, iterations * 100);
+    next = std::max(next, iterations + 1);
+    iterations = std::min<uint64_t>(next, MAX_ITERATIONS);
+  }
+}
+
+/* ns/op of a previous --json run, by name */
+std::map<std::string, double> load_baseline(const char *path) {
+  std::map<std::string, double> baseline;
+  std::ifstream file(path);
+  const nlohmann::json results = nlohmann::json::parse(file, nullptr, false);
+  if (!results.is_object() || !results.contains("benchmarks")) {
+    fprintf(stderr, "can't read the results in %s\n", path);
+    exit(1);
+  }
+  for (const nlohmann::json &result : results["benchmarks"]) {
+    baseline[result.value("name", "")] = result.value("ns_per_op", 0.0);
+  }
+  return baseline;
+}
+
+void print_text(const Result &result,
+                const std::map<std::string, double> &baseline) {
+  printf("%-26s %12llu %12.2f ns/op %10.1f B/op %8.2f allocs/op",
+         result.name.c_str(),
+         static_cast<unsigned long long>(result.iterations), result.nsPerOp,
+         result.bytesPerOp, result.allocsPerOp);
+  auto before = baseline.find(result.name);
+  if (before != baseline.end() && before->second > 0.0) {
+    printf(" %+7.1f%%", (result.nsPerOp / before->second - 1.0) * 100.0);
+  }
+  printf("\n");
+}
+
+void print_json(const std::vector<Result> &results,
+                const std::map<std::string, double> &baseline) {
+  printf("{\n  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &result = results[i];
+    printf("    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, "
+           "\"bytes_per_op\": %.3f, \"allocs_per_op\": %.4f",
+           result.name.c_str(),
+           static_cast<unsigned long long>(result.iterations), result.nsPerOp,
+           result.bytesPerOp, result.allocsPerOp);
+    auto before = baseline.find(result.name);
+    if (before != baseline.end()) {
+      printf(", \"baseline_ns_per_op\": %.3f", before->second);
+    }
+    printf("}%s\n", i + 1 < results.size() ? "," : "");
+  }
+  printf("  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bool json = false;
+  double minTime = DEFAULT_MIN_TIME;
+  const char *filter = "";
+  std::map<std::string, double> baseline;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+      minTime = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baseline = load_baseline(argv[++i]);
+    } else {
+      filter = argv[i];
+    }
+  }
+
+  /* Counts what the benchmarks allocate on this thread */
+  AllocationScope scope(AllocationStage::Other);
+  std::vector<Result> results;
+  for (const Benchmark &benchmark : benchmarks) {
+    if (strstr(benchmark.name, filter) == nullptr) {
+      continue;
+    }
+    results.push_back(run(benchmark, minTime));
+    if (!json) {
+      print_text(results.back(), baseline);
+      fflush(stdout);
+    }
+  }
+  if (json) {
+    print_json(results, baseline);
+  }
+  return 0;
+}
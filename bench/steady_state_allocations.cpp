@@ -0,0 +1,350 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Loads the plugin as the game does and drives it through its SDK
+ * callbacks with a synthetic drive: the channels, frame start and end with
+ * the frame scheduler, the shared frame and tracing, a configuration burst
+ * and a gameplay event now and then. The network thread sends the frames
+ * to local clients: one that keeps up, a compressed one, one in a compact
+ * dialect, a rate limited one and one that reads slowly, so messages wait
+ * in outboxes. Counts the allocations the game thread and the send path of
+ * the network thread make once they have warmed up and fails if there are
+ * any. Also fails if the frame JsonWriter writes differs from what
+ * json::dump makes of it, as JsonWriter formats numbers with nlohmann
+ * internals.
+ *
+ * Usage: bench_steady_state_allocations [frames] [warmup frames]
+ */
+
+#include "allocation_stats.h"
+#include "drive_profile.h"
+#include "event_queue.h"
+#include "json_writer.h"
+#include "network_handler.h"
+#include "sdk_stub.h"
+#include "telemetry.h"
+#include "telemetry_json.h"
+
+#include "scs_sdk/scssdk_telemetry.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifndef TSTS_ALLOCATION_STATS
+#error "Needs the operator new replacement of TSTS_ALLOCATION_STATS"
+#endif
+
+/* The state of the plugin, see ts_telemetry_server.cpp */
+extern EventQueue eventQueue;
+extern TelemetryFrame telemetryData;
+
+namespace {
+
+/* As often as in a regular session at 60 frames per second */
+#define CONFIG_INTERVAL 600
+#define GAMEPLAY_INTERVAL 150
+/*
+ * The replay ring holds on to the buffers of gameplay events and configs
+ * until it's full, with the intervals above it takes about 22000 frames
+ */
+#define WARMUP_FRAMES 25000
+/* Bytes per second of the rate limited client, less than the frames need */
+#define CLIENT_RATE "1048576"
+#define FRAME_SECONDS (1.0 / 60)
+
+const DriveProfile profile = {
+    "steady-state", "the motorway with configuration and gameplay events",
+    2, 6, CONFIG_INTERVAL, GAMEPLAY_INTERVAL, false};
+
+void set_option(const char *name, const char *value) {
+#ifdef _WIN32
+  _putenv_s(name, value);
+#else
+  setenv(name, value, 1);
+#endif
+}
+
+/*
+ * Lets the network thread finish the events, so it has always let go of
+ * the replay ring entries the next one replaces when the game acquires
+ * its buffer. Otherwise the pool would grow whenever it lags behind.
+ */
+void catch_up() {
+  while (!eventQueue.IsDrained()) {
+    std::this_thread::yield();
+  }
+}
+
+/*
+ * Also lets the slow and rate limited clients take the events. The bench
+ * runs the game much faster than 60 fps, without this the events would
+ * pile up in their outboxes further than in any session and the send
+ * pool would keep growing to new peaks.
+ */
+void deliver() {
+  catch_up();
+  while (NetworkHandler::GetQueuedMessages() != 0) {
+    std::this_thread::yield();
+    catch_up();
+  }
+}
+
+/* One frame the way the game calls the plugin, returns the channel calls */
+size_t drive_frame(const DriveSimulation &drive) {
+  for (const DriveEvent &config : drive.Configuration()) {
+    SdkStub::SendConfiguration(config);
+    deliver();
+  }
+  scs_telemetry_frame_start_t frameInfo = {};
+  frameInfo.flags =
+      drive.Frame() == 0 ? SCS_TELEMETRY_FRAME_START_FLAG_timer_restart : 0;
+  const auto time = static_cast<scs_timestamp_t>(drive.Time() * 1e6);
+  frameInfo.render_time = time;
+  frameInfo.simulation_time = time;
+  frameInfo.paused_simulation_time = time;
+  SdkStub::Fire(SCS_TELEMETRY_EVENT_frame_start, &frameInfo);
+  if (const DriveEvent *gameplay = drive.Gameplay()) {
+    SdkStub::SendGameplay(*gameplay);
+    deliver();
+  }
+  const size_t calls = SdkStub::SendChannels(drive);
+  SdkStub::Fire(SCS_TELEMETRY_EVENT_frame_end, nullptr);
+  /* The network thread keeps up with the game, as it does at 60 fps */
+  catch_up();
+  return calls;
+}
+
+/* JsonWriter has to match json::dump byte for byte */
+bool matches_dump(const TelemetryFrame &frame) {
+  std::string written;
+  JsonWriter::AppendFrame(&written, frame);
+  const std::string dumped = nlohmann::json(frame).dump();
+  if (written == dumped) {
+    return true;
+  }
+  size_t at = 0;
+  while (at < written.size() && at < dumped.size() &&
+         written[at] == dumped[at]) {
+    at++;
+  }
+  printf("JsonWriter differs from json::dump at byte %zu:\n%.60s\n%.60s\n",
+         at, written.c_str() + (at > 20 ? at - 20 : 0),
+         dumped.c_str() + (at > 20 ? at - 20 : 0));
+  return false;
+}
+
+AllocationCounter thread_stage(std::string_view thread,
+                               AllocationStage stage) {
+  AllocationThreadStats threads[ALLOCATION_MAX_THREADS];
+  const size_t count = AllocationStats::Collect(threads);
+  for (size_t i = 0; i < count; i++) {
+    if (threads[i].name != nullptr && threads[i].name == thread) {
+      return threads[i].stages[static_cast<size_t>(stage)];
+    }
+  }
+  return {};
+}
+
+/*
+ * Stages of the network thread that handle every event. The snapshot
+ * parses the rare gameplay events and configs, the rest is connections.
+ */
+bool counts_on_network(AllocationStage stage) {
+  return stage == AllocationStage::Queue || stage == AllocationStage::Send;
+}
+
+#ifndef _WIN32
+struct Client {
+  const char *command;
+  /* Pause between reads, so the socket fills up */
+  std::chrono::milliseconds delay;
+};
+
+/* Reads until stop, the data is thrown away */
+void run_client(Client client, const std::atomic<bool> *stop) {
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(PORT);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int s = socket(AF_INET, SOCK_STREAM, 0);
+  if (connect(s, reinterpret_cast<sockaddr *>(&address), sizeof(address)) !=
+      0) {
+    fprintf(stderr, "unable to connect a client\n");
+    close(s);
+    return;
+  }
+  if (client.command != nullptr) {
+    send(s, client.command, strlen(client.command) + 1, 0);
+  }
+  struct timeval timeout = {0, 100000};
+  setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  std::vector<char> buffer(16 * 1024);
+  while (!stop->load()) {
+    if (recv(s, buffer.data(), buffer.size(), 0) == 0) {
+      break;
+    }
+    std::this_thread::sleep_for(client.delay);
+  }
+  close(s);
+}
+#endif
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const int frames = argc > 1 ? atoi(argv[1]) : 20000;
+  const int warmup = argc > 2 ? atoi(argv[2]) : WARMUP_FRAMES;
+
+  set_option("TSTS_BEST_EFFORT_RATE", CLIENT_RATE);
+  set_option("TSTS_TIMESTAMPS", "1");
+  set_option("TSTS_TRACE", "1");
+#ifndef _WIN32
+  set_option("TSTS_SHM_NAME", "/tsts_bench_allocations");
+#endif
+  scs_telemetry_init_params_v101_t params;
+  SdkStub::FillParams(&params);
+  if (scs_telemetry_init(SCS_TELEMETRY_VERSION_1_01, &params) !=
+      SCS_RESULT_ok) {
+    printf("FAIL: scs_telemetry_init failed\n");
+    return 1;
+  }
+  std::atomic<bool> done = false;
+  std::vector<std::thread> clients;
+#ifndef _WIN32
+  /*
+   * The tiers are pinned, following congestion they would change with the
+   * timing of the run and so would the sizes of the frames that wait
+   */
+  const Client setups[] = {
+      {"{\"lod\":\"full\"}", std::chrono::milliseconds(0)},
+      {"{\"compression\":\"zstd\",\"lod\":\"full\"}",
+       std::chrono::milliseconds(0)},
+      {"{\"dialect\":\"short\",\"lod\":\"full\"}",
+       std::chrono::milliseconds(0)},
+      {"{\"qos\":\"best-effort\",\"lod\":\"gauges\"}",
+       std::chrono::milliseconds(0)},
+      {"{\"lod\":\"truck\"}", std::chrono::milliseconds(5)},
+  };
+  for (const Client &client : setups) {
+    clients.emplace_back(run_client, client, &done);
+  }
+  while (NetworkHandler::GetSubscriberCount() < clients.size()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+#endif
+
+  DriveSimulation drive(profile, FRAME_SECONDS);
+  size_t channelCalls = 0;
+  SdkStub::Fire(SCS_TELEMETRY_EVENT_started, nullptr);
+  AllocationCounter before[ALLOCATION_STAGE_COUNT];
+  AllocationCounter networkBefore[ALLOCATION_STAGE_COUNT];
+  for (int f = 0; f < warmup + frames; f++) {
+    if (f == warmup) {
+      for (size_t stage = 0; stage < ALLOCATION_STAGE_COUNT; stage++) {
+        const AllocationStage s = static_cast<AllocationStage>(stage);
+        before[stage] = thread_stage("game", s);
+        networkBefore[stage] = thread_stage("network", s);
+      }
+    }
+    const size_t calls = drive_frame(drive);
+    if (f >= warmup) {
+      channelCalls += calls;
+    }
+    drive.Advance();
+  }
+  AllocationCounter networkAfter[ALLOCATION_STAGE_COUNT];
+  for (size_t stage = 0; stage < ALLOCATION_STAGE_COUNT; stage++) {
+    networkAfter[stage] =
+        thread_stage("network", static_cast<AllocationStage>(stage));
+  }
+  AllocationCounter after[ALLOCATION_STAGE_COUNT];
+  for (size_t stage = 0; stage < ALLOCATION_STAGE_COUNT; stage++) {
+    after[stage] = thread_stage("game", static_cast<AllocationStage>(stage));
+  }
+  SdkStub::Fire(SCS_TELEMETRY_EVENT_paused, nullptr);
+  done = true;
+  for (std::thread &client : clients) {
+    client.join();
+  }
+  const bool matches = matches_dump(telemetryData);
+  scs_telemetry_shutdown();
+
+  printf("%d frames after %d warmup frames, %.1f channel callbacks each, "
+         "%zu clients\n",
+         frames, warmup,
+         frames > 0 ? static_cast<double>(channelCalls) / frames : 0.0,
+         clients.size());
+  uint64_t total = 0;
+  uint64_t networkTotal = 0;
+  for (size_t stage = 0; stage < ALLOCATION_STAGE_COUNT; stage++) {
+    const AllocationStage s = static_cast<AllocationStage>(stage);
+    const uint64_t allocations =
+        after[stage].allocations - before[stage].allocations;
+    const uint64_t bytes = after[stage].bytes - before[stage].bytes;
+    total += allocations;
+    printf("game    %-9s %8llu allocations %10llu bytes\n",
+           AllocationStats::StageName(s),
+           static_cast<unsigned long long>(allocations),
+           static_cast<unsigned long long>(bytes));
+  }
+  for (size_t stage = 0; stage < ALLOCATION_STAGE_COUNT; stage++) {
+    const AllocationStage s = static_cast<AllocationStage>(stage);
+    if (!counts_on_network(s)) {
+      continue;
+    }
+    const uint64_t allocations =
+        networkAfter[stage].allocations - networkBefore[stage].allocations;
+    const uint64_t bytes =
+        networkAfter[stage].bytes - networkBefore[stage].bytes;
+    networkTotal += allocations;
+    printf("network %-9s %8llu allocations %10llu bytes\n",
+           AllocationStats::StageName(s),
+           static_cast<unsigned long long>(allocations),
+           static_cast<unsigned long long>(bytes));
+  }
+  const MessagePoolStats pool = eventQueue.PoolStats();
+  printf("message pool: %llu allocated, %llu recycled\n",
+         static_cast<unsigned long long>(pool.allocated),
+         static_cast<unsigned long long>(pool.recycled));
+  if (total != 0) {
+    printf("FAIL: the game thread allocates in steady state\n");
+    return 1;
+  }
+  if (networkTotal != 0) {
+    printf("FAIL: the network thread allocates sending in steady state\n");
+    return 1;
+  }
+  if (!matches) {
+    printf("FAIL: JsonWriter does not write what json::dump does\n");
+    return 1;
+  }
+  printf("OK: no allocations on the game thread in steady state\n");
+  printf("OK: no allocations sending on the network thread\n");
+  printf("OK: JsonWriter writes the frame as json::dump does\n");
+  return 0;
+}
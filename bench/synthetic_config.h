@@ -0,0 +1,212 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SYNTHETIC_CONFIG_H
+#define SYNTHETIC_CONFIG_H
+
+#include "scs_sdk/common/scssdk_telemetry_common_configs.h"
+#include "scs_sdk/scssdk_value.h"
+
+#include <vector>
+
+/*
+ * Configuration attribute lists shaped like the ones the game sends, each
+ * terminated by an attribute with a NULL name.
+ */
+namespace SyntheticConfig {
+
+typedef std::vector<scs_named_value_t> Attributes;
+
+inline void String(Attributes &out, scs_string_t name, scs_string_t value,
+                   scs_u32_t index = SCS_U32_NIL) {
+  scs_named_value_t attr = {};
+  attr.name = name;
+  attr.index = index;
+  attr.value.type = SCS_VALUE_TYPE_string;
+  attr.value.value_string.value = value;
+  out.push_back(attr);
+}
+
+inline void Float(Attributes &out, scs_string_t name, scs_float_t value,
+                  scs_u32_t index = SCS_U32_NIL) {
+  scs_named_value_t attr = {};
+  attr.name = name;
+  attr.index = index;
+  attr.value.type = SCS_VALUE_TYPE_float;
+  attr.value.value_float.value = value;
+  out.push_back(attr);
+}
+
+inline void U32(Attributes &out, scs_string_t name, scs_u32_t value,
+                scs_u32_t index = SCS_U32_NIL) {
+  scs_named_value_t attr = {};
+  attr.name = name;
+  attr.index = index;
+  attr.value.type = SCS_VALUE_TYPE_u32;
+  attr.value.value_u32.value = value;
+  out.push_back(attr);
+}
+
+inline void U64(Attributes &out, scs_string_t name, scs_u64_t value) {
+  scs_named_value_t attr = {};
+  attr.name = name;
+  attr.index = SCS_U32_NIL;
+  attr.value.type = SCS_VALUE_TYPE_u64;
+  attr.value.value_u64.value = value;
+  out.push_back(attr);
+}
+
+inline void Bool(Attributes &out, scs_string_t name, bool value,
+                 scs_u32_t index = SCS_U32_NIL) {
+  scs_named_value_t attr = {};
+  attr.name = name;
+  attr.index = index;
+  attr.value.type = SCS_VALUE_TYPE_bool;
+  attr.value.value_bool.value = value ? 1 : 0;
+  out.push_back(attr);
+}
+
+inline void Vector(Attributes &out, scs_string_t name, scs_float_t x,
+                   scs_float_t y, scs_float_t z,
+                   scs_u32_t index = SCS_U32_NIL) {
+  scs_named_value_t attr = {};
+  attr.name = name;
+  attr.index = index;
+  attr.value.type = SCS_VALUE_TYPE_fvector;
+  attr.value.value_fvector.x = x;
+  attr.value.value_fvector.y = y;
+  attr.value.value_fvector.z = z;
+  out.push_back(attr);
+}
+
+inline void Terminate(Attributes &out) { out.push_back(scs_named_value_t{}); }
+
+inline void Wheels(Attributes &out, scs_u32_t count) {
+  U32(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_wheel_count, count);
+  for (scs_u32_t i = 0; i < count; ++i) {
+    Vector(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_wheel_position,
+           i % 2 ? 1.0f : -1.0f, 0.5f, -1.5f * static_cast<float>(i / 2), i);
+    Bool(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_wheel_steerable, i < 2, i);
+    Bool(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_wheel_simulated, true, i);
+    Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_wheel_radius, 0.52f, i);
+    Bool(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_wheel_powered, i >= 2 && i < 6,
+         i);
+    Bool(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_wheel_liftable, i >= 6, i);
+  }
+}
+
+inline Attributes Truck(scs_u32_t wheelCount = 6) {
+  Attributes out;
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_brand_id, "scania");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_brand, "Scania");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_id, "vehicle.scania.s_2016");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_name, "S");
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_fuel_capacity, 1400.0f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_fuel_warning_factor, 0.15f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_adblue_capacity, 80.0f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_adblue_warning_factor, 0.15f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_air_pressure_warning, 65.0f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_air_pressure_emergency, 35.0f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_oil_pressure_warning, 10.0f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_water_temperature_warning, 105.0f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_battery_voltage_warning, 22.0f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_rpm_limit, 2500.0f);
+  U32(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_forward_gear_count, 12);
+  U32(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_reverse_gear_count, 4);
+  U32(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_retarder_step_count, 3);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_differential_ratio, 2.59f);
+  for (scs_u32_t i = 0; i < 12; ++i) {
+    Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_forward_ratio,
+          11.32f / static_cast<float>(i + 1), i);
+  }
+  for (scs_u32_t i = 0; i < 4; ++i) {
+    Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_reverse_ratio,
+          -11.32f / static_cast<float>(i + 1), i);
+  }
+  Vector(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_cabin_position, 0.0f, 1.6f, -0.7f);
+  Vector(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_head_position, -0.6f, 1.3f, 0.4f);
+  Vector(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_hook_position, 0.0f, 1.0f, 0.8f);
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_license_plate, "ABC-123");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_license_plate_country, "Finland");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_license_plate_country_id,
+         "finland");
+  Wheels(out, wheelCount);
+  Terminate(out);
+  return out;
+}
+
+inline Attributes Trailer(scs_u32_t wheelCount = 6) {
+  Attributes out;
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_id,
+         "scs_box.dry_van.chassis_stwx2esii");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_cargo_accessory_id,
+         "cargo.empty_palet");
+  Vector(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_hook_position, 0.0f, 1.0f, -5.0f);
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_brand_id, "schwarzmuller");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_brand, "Schwarzmüller");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_name, "Dry Van");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_chain_type, "single");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_body_type, "dryvan");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_license_plate, "DEÄ-881");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_license_plate_country, "Finland");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_license_plate_country_id,
+         "finland");
+  Wheels(out, wheelCount);
+  Terminate(out);
+  return out;
+}
+
+inline Attributes Job() {
+  Attributes out;
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_cargo_id, "empty_palet");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_cargo, "Empty Pallets");
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_cargo_mass, 22073.7f);
+  Float(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_cargo_unit_mass, 668.9f);
+  U32(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_cargo_unit_count, 33);
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_destination_city_id, "tampere");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_destination_city, "Tampere");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_destination_company_id, "renar");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_destination_company,
+         "Renar Logistik");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_source_city_id, "tampere");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_source_city, "Tampere");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_source_company_id, "viljo_paper");
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_source_company,
+         "Viljo paperitehdas Oy");
+  U64(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_income, 1205);
+  U32(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_delivery_time, 971);
+  U32(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_planned_distance_km, 74);
+  Bool(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_is_cargo_loaded, true);
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_job_market, "quick_job");
+  Bool(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_special_job, false);
+  Terminate(out);
+  return out;
+}
+
+inline Attributes Controls() {
+  Attributes out;
+  String(out, SCS_TELEMETRY_CONFIG_ATTRIBUTE_shifter_type, "arcade");
+  Terminate(out);
+  return out;
+}
+
+} // namespace SyntheticConfig
+
+#endif
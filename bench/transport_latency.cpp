@@ -0,0 +1,195 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Pushes frame-sized events through the network thread and measures the
+ * time until local clients hold the whole message, over loopback TCP or the
+ * Unix domain socket. Usage: bench_transport_latency tcp|unix [clients]
+ * [frames]. CPU time covers the whole process, server and clients alike.
+ */
+
+#include "network_handler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+#define BENCH_SOCKET_PATH "/tmp/tsts_bench.sock"
+/* About the size of a serialized frame with a trailer attached */
+#define BENCH_FRAME_SIZE (60 * 1024)
+#define BENCH_FRAME_INTERVAL_US 1000
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+double cpu_seconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+         static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) /
+             1e6;
+}
+
+int connect_client(bool unixSocket) {
+  if (unixSocket) {
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, BENCH_SOCKET_PATH);
+    /* Same order as the server: SOCK_SEQPACKET, then a byte stream */
+    for (int type : {SOCK_SEQPACKET, SOCK_STREAM}) {
+      int s = socket(AF_UNIX, type, 0);
+      if (s >= 0 && connect(s, reinterpret_cast<sockaddr *>(&address),
+                            sizeof(address)) == 0) {
+        return s;
+      }
+      if (s >= 0) {
+        close(s);
+      }
+    }
+    return -1;
+  }
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(PORT);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int s = socket(AF_INET, SOCK_STREAM, 0);
+  if (connect(s, reinterpret_cast<sockaddr *>(&address), sizeof(address)) !=
+      0) {
+    close(s);
+    return -1;
+  }
+  return s;
+}
+
+/* Each event starts with its push time so the client can stamp arrival */
+void read_events(int s, int frames, std::vector<int64_t> *latencies) {
+  int type = SOCK_STREAM;
+  socklen_t length = sizeof(type);
+  getsockopt(s, SOL_SOCKET, SO_TYPE, &type, &length);
+  std::vector<char> buffer(4 * BENCH_FRAME_SIZE);
+  std::string pending;
+  while (static_cast<int>(latencies->size()) < frames) {
+    ssize_t received = recv(s, buffer.data(), buffer.size(), 0);
+    if (received <= 0) {
+      return;
+    }
+    if (type == SOCK_SEQPACKET) {
+      latencies->push_back(now_ns() - atoll(buffer.data()));
+      continue;
+    }
+    pending.append(buffer.data(), static_cast<size_t>(received));
+    size_t end;
+    while ((end = pending.find('\0')) != std::string::npos) {
+      if (end > 0) {
+        latencies->push_back(now_ns() - atoll(pending.c_str()));
+      }
+      pending.erase(0, end + 1);
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const bool unixSocket = argc > 1 && strcmp(argv[1], "unix") == 0;
+  const int clients = argc > 2 ? atoi(argv[2]) : 1;
+  const int frames = argc > 3 ? atoi(argv[3]) : 5000;
+
+  EventQueue queue;
+  PluginOptions options;
+  if (unixSocket) {
+    options.unixSocketPath = BENCH_SOCKET_PATH;
+  }
+  std::jthread *server = NetworkHandler::GetEventThread(&queue, options);
+
+  std::vector<int> sockets;
+  for (int c = 0; c < clients; ++c) {
+    int s = connect_client(unixSocket);
+    if (s < 0) {
+      fprintf(stderr, "unable to connect client %d\n", c);
+      return 1;
+    }
+    sockets.push_back(s);
+  }
+  while (NetworkHandler::GetSubscriberCount() < sockets.size()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std::vector<std::vector<int64_t>> latencies(sockets.size());
+  std::vector<std::jthread> readers;
+  for (size_t c = 0; c < sockets.size(); ++c) {
+    latencies[c].reserve(static_cast<size_t>(frames));
+    readers.emplace_back(read_events, sockets[c], frames, &latencies[c]);
+  }
+
+  std::string frame(BENCH_FRAME_SIZE, 'x');
+  const double cpuStart = cpu_seconds();
+  auto next = Clock::now();
+  for (int f = 0; f < frames; ++f) {
+    next += std::chrono::microseconds(BENCH_FRAME_INTERVAL_US);
+    std::this_thread::sleep_until(next);
+    const std::string stamp = std::to_string(now_ns());
+    frame.replace(0, stamp.size(), stamp);
+    frame[stamp.size()] = ' ';
+    queue.PushEvent(frame, EVENT_FRAME);
+  }
+  readers.clear();
+  const double cpu = cpu_seconds() - cpuStart;
+
+  std::vector<int64_t> all;
+  for (const std::vector<int64_t> &l : latencies) {
+    all.insert(all.end(), l.begin(), l.end());
+  }
+  std::sort(all.begin(), all.end());
+  if (all.empty()) {
+    fprintf(stderr, "no events received\n");
+    return 1;
+  }
+  auto percentile = [&](double p) {
+    const double rank = p * static_cast<double>(all.size() - 1);
+    return static_cast<double>(all[static_cast<size_t>(rank)]) / 1000.0;
+  };
+  printf("%s, %zu clients, %zu/%d events received\n",
+         unixSocket ? "unix" : "tcp", sockets.size(), all.size(),
+         frames * clients);
+  printf("latency p50 %.1f us, p99 %.1f us, max %.1f us\n", percentile(0.5),
+         percentile(0.99), percentile(1.0));
+  printf("process CPU %.1f us/frame\n", cpu * 1e6 / frames);
+
+  for (int s : sockets) {
+    close(s);
+  }
+  server->request_stop();
+  delete server;
+  NetworkHandler::Cleanup();
+  return 0;
+}
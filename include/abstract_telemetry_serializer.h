@@ -26,8 +26,11 @@ If not, see <https://www.gnu.org/licenses/>.
 
 class AbstractTelemetrySerializer{
         public:
-                virtual std::string SerializeFrame(TelemetryFrame*) = 0;
-                virtual std::string SerializeEvent(TelemetryGameplayEvent*) = 0;
+                /* Each one replaces out with the message, keeping its capacity */
+                virtual void SerializeFrame(TelemetryFrame*,std::string* out) = 0;
+                virtual void SerializeEvent(TelemetryGameplayEvent*,std::string* out) = 0;
+                /* The block of the frame that changed, index picks the trailer */
+                virtual void SerializeConfig(TelemetryFrame*,TelemetryConfigBlock block,size_t index,std::string* out) = 0;
                 virtual ~AbstractTelemetrySerializer(){}
 };
 
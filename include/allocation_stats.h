@@ -0,0 +1,97 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef ALLOCATION_STATS_H
+#define ALLOCATION_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Heap allocations per thread and per stage of the pipeline, counted by
+ * replacements of the global operator new and delete. Only builds
+ * configured with -DTSTS_ALLOCATION_STATS=ON have them, in the others the
+ * scopes below compile to nothing.
+ *
+ * Allocations are only counted inside an AllocationScope, so what the game
+ * allocates on the threads that call into the plugin is left out. The
+ * stage is the one of the innermost scope of the thread.
+ */
+
+enum class AllocationStage { Other, Store, Snapshot, Encode, Queue, Send };
+#define ALLOCATION_STAGE_COUNT 6
+/* Threads beyond it share the last slot */
+#define ALLOCATION_MAX_THREADS 8
+
+struct AllocationCounter {
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+  uint64_t frees = 0;
+};
+
+struct AllocationThreadStats {
+  /* nullptr for threads that weren't named */
+  const char *name = nullptr;
+  AllocationCounter stages[ALLOCATION_STAGE_COUNT];
+};
+
+namespace AllocationStats {
+constexpr bool Enabled() {
+#ifdef TSTS_ALLOCATION_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+const char *StageName(AllocationStage stage);
+#ifdef TSTS_ALLOCATION_STATS
+/* The name must outlive the counters, e.g. a string literal */
+void NameThread(const char *name);
+/* Copies the counters of the threads seen so far, returns their number */
+size_t Collect(AllocationThreadStats *threads);
+#else
+inline void NameThread(const char *) {}
+inline size_t Collect(AllocationThreadStats *) { return 0; }
+#endif
+} // namespace AllocationStats
+
+/* Counts the allocations of the thread towards a stage while it's alive */
+class AllocationScope {
+public:
+#ifdef TSTS_ALLOCATION_STATS
+  explicit AllocationScope(AllocationStage stage);
+  ~AllocationScope();
+  /* Moves on to the next stage without opening another scope */
+  void Enter(AllocationStage stage);
+#else
+  explicit AllocationScope(AllocationStage) {}
+  void Enter(AllocationStage) {}
+#endif
+  AllocationScope(const AllocationScope &) = delete;
+  AllocationScope &operator=(const AllocationScope &) = delete;
+
+#ifdef TSTS_ALLOCATION_STATS
+private:
+  int m_previous;
+#endif
+};
+
+#endif
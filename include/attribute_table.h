@@ -0,0 +1,98 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ATTRIBUTE_TABLE_H
+#define ATTRIBUTE_TABLE_H
+
+#include "scs_sdk/scssdk_value.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+template <typename Context> struct ConfigAttribute {
+  std::string_view name;
+  void (*handler)(const scs_value_t *value, scs_u32_t index, Context *context);
+};
+
+/*
+ * Perfect hash over a fixed set of attribute names. The constructor searches
+ * a seed at compile time for which no two names share a slot, so a lookup is
+ * one hash of the name, one slot and one string compare, without allocating.
+ */
+template <typename Context, size_t N> class AttributeTable {
+public:
+  /* Four slots per name keep the seed search short */
+  static constexpr size_t SLOT_COUNT = std::bit_ceil(N * 4);
+  static constexpr uint8_t EMPTY = 0xff;
+  static_assert(N < EMPTY, "Too many attributes for one table");
+
+  constexpr AttributeTable(const ConfigAttribute<Context> (&attributes)[N]) {
+    for (size_t i = 0; i < N; ++i) {
+      m_attributes[i] = attributes[i];
+    }
+    for (uint32_t seed = 0; seed < 100000; ++seed) {
+      if (tryBuild(seed)) {
+        m_seed = seed;
+        return;
+      }
+    }
+    throw std::logic_error("No perfect hash seed found");
+  }
+
+  constexpr const ConfigAttribute<Context> *Find(std::string_view name) const {
+    const uint8_t i = m_slots[slot(m_seed, name)];
+    if (i == EMPTY || m_attributes[i].name != name) {
+      return nullptr;
+    }
+    return &m_attributes[i];
+  }
+
+private:
+  static constexpr size_t slot(uint32_t seed, std::string_view name) {
+    /* FNV-1a with the seed folded into the offset basis */
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : name) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return (hash ^ (hash >> 15)) & (SLOT_COUNT - 1);
+  }
+
+  constexpr bool tryBuild(uint32_t seed) {
+    m_slots.fill(EMPTY);
+    for (size_t i = 0; i < N; ++i) {
+      uint8_t &target = m_slots[slot(seed, m_attributes[i].name)];
+      if (target != EMPTY) {
+        return false;
+      }
+      target = static_cast<uint8_t>(i);
+    }
+    return true;
+  }
+
+  std::array<ConfigAttribute<Context>, N> m_attributes = {};
+  std::array<uint8_t, SLOT_COUNT> m_slots = {};
+  uint32_t m_seed = 0;
+};
+
+#endif
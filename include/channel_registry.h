@@ -0,0 +1,80 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHANNEL_REGISTRY_H
+#define CHANNEL_REGISTRY_H
+
+#include "scs_sdk/scssdk_telemetry_channel.h"
+#include "telemetry.h"
+#include "telemetry_channels.h"
+
+#include <cstddef>
+
+/* What the consumers of the plugin currently read from the frame */
+struct ChannelDemand {
+  bool truck = false;
+  bool wheels = false;
+  bool trailers = false;
+};
+
+/*
+ * Keeps the SDK channel registrations in line with the demand. Required
+ * channels are always registered, truck channels only while someone
+ * consumes them, wheel channels only for the configured wheel count and
+ * trailer channels only for connected trailers.
+ *
+ * The SDK only allows (un)registering from init, shutdown and event
+ * callbacks, so Update has to be called from one of those.
+ */
+class ChannelRegistry {
+public:
+  ChannelRegistry(scs_telemetry_register_for_channel_t registerChannel,
+                  scs_telemetry_unregister_from_channel_t unregisterChannel,
+                  TelemetryFrame *frame);
+  /* Returns true if the registered set changed */
+  bool Update(const ChannelDemand &demand);
+
+private:
+  static constexpr size_t TRAILER_CHANNEL_COUNT =
+      TelemetryChannels::CountScope(ChannelScope::Trailer) +
+      TelemetryChannels::CountScope(ChannelScope::TrailerWheel);
+
+  char *trailerName(scs_u32_t trailer, size_t channel);
+  void setRegistered(size_t channel, scs_string_t name, scs_u32_t index,
+                     scs_u32_t trailer, scs_u32_t wheel, bool registered);
+  /* Each returns true if the group had to be (un)registered */
+  bool setTruck(bool registered);
+  bool setTruckWheel(scs_u32_t wheel, bool registered);
+  bool setTrailer(scs_u32_t trailer, bool registered);
+  bool setTrailerWheel(scs_u32_t trailer, scs_u32_t wheel, bool registered);
+
+  scs_telemetry_register_for_channel_t m_register;
+  scs_telemetry_unregister_from_channel_t m_unregister;
+  TelemetryFrame *m_frame;
+  bool m_truck = false;
+  bool m_truckWheels[MAX_WHEEL_COUNT] = {};
+  bool m_trailers[MAX_TRAILERS] = {};
+  bool m_trailerWheels[MAX_TRAILERS][MAX_WHEEL_COUNT] = {};
+  /* Trailer channel names with the trailer index spliced in */
+  char m_trailerNames[MAX_TRAILERS][TRAILER_CHANNEL_COUNT]
+                     [TelemetryChannels::TRAILER_CHANNEL_NAME_SIZE];
+};
+
+#endif
@@ -0,0 +1,80 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/*
+ * Streaming compression of the messages sent to a subscriber. All
+ * subscribers that asked for the same compression share one stream, every
+ * message is compressed once and flushed so it can be decoded on arrival.
+ *
+ * Each compressed message starts with a flag byte. With
+ * COMPRESSION_FLAG_RESET set the stream starts over: decoders discard their
+ * state and reload the dictionary before decoding it. The stream starts
+ * over whenever a subscriber joins, so the newcomer can decode it.
+ * Messages meant for one subscriber only are sent uncompressed with
+ * COMPRESSION_FLAG_RAW instead and leave the stream alone.
+ *
+ * Both codecs are primed with the frame dictionary in
+ * dictionaries/frame_v2.zdict, zlib uses it as a preset dictionary.
+ */
+
+#define COMPRESSION_FLAG_RESET 0x01
+/* Not part of the stream, the rest is the message as is */
+#define COMPRESSION_FLAG_RAW 0x02
+#define COMPRESSION_DEFLATE_LEVEL 1
+#define COMPRESSION_ZSTD_LEVEL 3
+
+enum class Compression { None, Deflate, Zstd };
+#define COMPRESSION_COUNT 3
+
+/* The trained dictionary, generated from dictionaries/frame_v2.zdict */
+extern const unsigned char FrameDictionary[];
+extern const size_t FrameDictionarySize;
+/* Clients can check it against the one they have */
+#define FRAME_DICTIONARY_ID 2
+
+class MessageCompressor {
+public:
+  /* Returns nullptr if the plugin was built without the codec */
+  static std::unique_ptr<MessageCompressor> Create(Compression compression);
+  /* Parses "none", "deflate" or "zstd", false for anything else */
+  static bool Parse(std::string_view name, Compression *compression);
+  static const char *Name(Compression compression);
+
+  virtual ~MessageCompressor() = default;
+  /*
+   * Replaces out with the flag byte and the compressed message. With reset
+   * the message starts a new stream.
+   */
+  virtual bool Compress(std::string_view message, bool reset,
+                        std::string *out) = 0;
+  /* The room Compress takes for a message of size, for pooled buffers */
+  virtual size_t Bound(size_t size) = 0;
+};
+
+#endif
@@ -24,8 +24,6 @@ If not, see <https://www.gnu.org/licenses/>.
 #include "scs_sdk/scssdk_value.h"
 #include "telemetry.h"
 
-#include <map>
-
 namespace ConfigHandler{
     void HandleTruckConfig(const scs_named_value_t* attributes,TelemetryTruck* context);
     void HandleTrailerConfig(const scs_named_value_t* attributes,TelemetryTrailer* context);
@@ -22,27 +22,79 @@ If not, see <https://www.gnu.org/licenses/>.
 #ifndef EVENT_QUEUE_H
 #define EVENT_QUEUE_H
 
-#include <queue>
+#include "message_pool.h"
+
 #include <string>
+#include <string_view>
 #include <mutex>
+#include <vector>
 
 #define EVENT_FRAME "frame"
 #define EVENT_GAMEPLAY "gameplay"
+#define EVENT_CONFIG "config"
+/* Events the queue holds before it has to grow */
+#define EVENT_QUEUE_CAPACITY 64
 
 struct EventInfo{
-        std::string event;
+        MessageRef event;
         std::string type;
 };
 
+struct EventQueueStats{
+        size_t depth = 0;
+        /* The most events it held at once */
+        size_t peak = 0;
+};
+
+/*
+ * Hands the serialized events from the game thread to the network thread.
+ * The messages live in buffers of the queue's pool and the queue itself is
+ * a ring, so neither allocates once they've grown to the usual load.
+ *
+ * The consumer may sleep on WakeDescriptor between PrepareWait and
+ * FinishWait, a push makes it readable then. Windows has no descriptor
+ * select could wait on, the consumer keeps polling there.
+ */
 class EventQueue
 {
 public:
-        void PushEvent(std::string eventInfo,const char* type);
+        EventQueue();
+        ~EventQueue();
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+        /* An empty message buffer with room for at least size bytes */
+        MessageRef Acquire(size_t size);
+        void PushEvent(MessageRef event,const char* type);
+        /* Copies the event into a pooled buffer */
+        void PushEvent(std::string_view event,const char* type);
+        /* An event with an empty type if there is none */
         EventInfo PopEvent();
         bool IsEmpty();
+        /*
+         * Empty and the consumer is waiting again, done with what it took.
+         * Where it can't wait, just empty. Only for tools and benchmarks.
+         */
+        bool IsDrained();
+        MessagePoolStats PoolStats() const;
+        EventQueueStats Stats();
+        /* Readable while a waiting consumer should wake up, -1 if unsupported */
+        int WakeDescriptor() const;
+        /* False if there are events already or waiting isn't supported */
+        bool PrepareWait();
+        void FinishWait();
+        /* Wakes the consumer even without events, e.g. to stop it */
+        void Wake();
 private:
-        std::queue<EventInfo> m_serializedEvents;
+        /* Declared first, so the queued events go back before it's gone */
+        MessagePool m_pool;
+        std::vector<EventInfo> m_events;
+        size_t m_head = 0;
+        size_t m_count = 0;
+        size_t m_peak = 0;
         std::mutex m_mutex;
+        /* The consumer is between PrepareWait and FinishWait */
+        bool m_waiting = false;
+        int m_wakePipe[2] = {-1,-1};
 };
 
 #endif
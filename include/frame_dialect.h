@@ -0,0 +1,85 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+#ifndef FRAME_DIALECT_H
+#define FRAME_DIALECT_H
+
+#include "frame_lod.h"
+
+#include <string>
+#include <string_view>
+
+/*
+ * Encodings of frames for clients that stay on JSON. Most of a frame is
+ * key names repeated for every wheel and trailer, the compact dialects cut
+ * them down:
+ *
+ * Standard: the frame as serialized.
+ * Short: every key of the payload is replaced by an alias of one or two
+ *   characters, the most frequent keys get the shortest ones.
+ * Positional: every object of the payload is an array of its values in the
+ *   schema order of telemetry_schema.h, a missing field is null.
+ * Fixed: the frame with the fixed arrays of older versions, MAX_TRAILERS
+ *   trailers and MAX_WHEEL_COUNT wheels per vehicle. The slots that aren't
+ *   in use hold default values.
+ *
+ * The envelope, i.e. payloadType, seq and lod, and other messages stay as
+ * they are. Clients learn how to read a dialect from its header, sent when
+ * they switch to it:
+ *   {"payload":{"dialect":"short","keys":{"<alias>":"<key>",...}},
+ *    "payloadType":"dialect"}
+ *   {"payload":{"dialect":"positional","schema":[...]},
+ *    "payloadType":"dialect"}
+ * The schema lists the fields of the frame, a field is a key for plain
+ * values, {"<key>":[<fields>]} for objects and {"<key>":[[<fields>]]} for
+ * arrays of objects.
+ */
+enum class FrameDialect { Standard, Short, Positional, Fixed };
+#define DIALECT_COUNT 4
+
+namespace Dialect {
+/* Parses "standard", "short", "positional" or "fixed" */
+bool Parse(std::string_view name, FrameDialect *dialect);
+const char *Name(FrameDialect dialect);
+/* The message that tells a client how to read the dialect */
+const std::string &Header(FrameDialect dialect);
+/* How JsonWriter::AppendFrame writes the payload in the dialect */
+JsonWriter::FrameFormat Format(FrameDialect dialect);
+} // namespace Dialect
+
+/*
+ * The current frame in each dialect and tier, encoded on first use and
+ * shared by every subscriber that reads it.
+ */
+class FrameDialects {
+public:
+  /* tiers has to hold the current frame until the next call */
+  void SetFrame(FrameTiers *tiers);
+  /* nullptr if the tier can't be written, see FrameTiers::Get */
+  const std::string *Get(LodTier tier, FrameDialect dialect);
+
+private:
+  FrameTiers *m_tiers = nullptr;
+  /* Other dialects than the standard one, by tier */
+  bool m_encoded[LOD_TIER_COUNT][DIALECT_COUNT] = {};
+  std::string m_messages[LOD_TIER_COUNT][DIALECT_COUNT];
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef FRAME_LOD_H
+#define FRAME_LOD_H
+
+#include "json_writer.h"
+#include "message_pool.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*
+ * Detail tiers of frames for congested subscribers, each one a subset of
+ * the one before:
+ *
+ * Full: the frame as serialized.
+ * NoWheels: without the wheel arrays of the truck and the trailers.
+ * TruckCore: without the trailers as well.
+ * Gauges: game time, pause and idle state, the config version and what a
+ *   dashboard shows, i.e. speed, engine, gear, fuel, lights and navigation.
+ *
+ * Frames of the lower tiers carry their tier as "lod", the lowest two
+ * are sent at most every LOD_TRUCK_INTERVAL_MS and LOD_GAUGES_INTERVAL_MS.
+ */
+enum class LodTier { Full, NoWheels, TruckCore, Gauges };
+#define LOD_TIER_COUNT 4
+#define LOD_TRUCK_INTERVAL_MS 50
+#define LOD_GAUGES_INTERVAL_MS 100
+
+namespace Lod {
+/* Parses "full", "no-wheels", "truck" or "gauges" */
+bool Parse(std::string_view name, LodTier *tier);
+const char *Name(LodTier tier);
+/* Minimum time between two frames of the tier */
+int IntervalMs(LodTier tier);
+/* The FRAME_FIELDS_* groups of json_writer.h the tier leaves out */
+uint32_t Omitted(LodTier tier);
+} // namespace Lod
+
+/*
+ * The tiers of the current frame. They are written from the frame the
+ * game kept with the message on first use, once per frame, and shared by
+ * every subscriber on the tier.
+ */
+class FrameTiers {
+public:
+  /* The message as ReplayRing::Stamp left it */
+  void SetFrame(const MessageRef &frame);
+  /* nullptr if the game didn't keep the frame with the message */
+  const std::string *Get(LodTier tier);
+  /*
+   * Replaces out with the current frame message in the tier, its payload
+   * written in format, for other encodings. The frame has to be kept.
+   */
+  void Encode(LodTier tier, JsonWriter::FrameFormat format,
+              std::string *out) const;
+  const MessageRef &Message() const { return m_frame; }
+
+private:
+  MessageRef m_frame;
+  /* What ReplayRing::Stamp appended, from ,"seq" on */
+  std::string_view m_stamp;
+  bool m_written[LOD_TIER_COUNT] = {};
+  std::string m_tiers[LOD_TIER_COUNT];
+};
+
+#endif
@@ -0,0 +1,53 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include "telemetry.h"
+
+#include <chrono>
+
+/* Rate of frames sent while the game is paused or the truck is parked */
+#define IDLE_HEARTBEAT_MS 1000
+/* How long the truck has to stay parked before switching to idle mode */
+#define IDLE_SETTLE_MS 1000
+#define IDLE_SPEED_EPSILON 0.01
+#define IDLE_INPUT_EPSILON 0.001
+
+/*
+ * Decides which frames are worth sending. While driving every changed frame
+ * goes out, while idle only a heartbeat does. Any activity switches back to
+ * full rate on the very next frame.
+ */
+class FrameScheduler {
+public:
+  /* Updates frame->idle and returns whether the frame should be sent */
+  bool ShouldEmit(TelemetryFrame *frame, bool changed, bool forced);
+
+private:
+  bool isParked(const TelemetryFrame *frame);
+  bool m_idle = false;
+  TelemetryTruckInput m_lastInput = {};
+  std::chrono::steady_clock::time_point m_parkedSince = {};
+  std::chrono::steady_clock::time_point m_lastEmit = {};
+};
+
+#endif
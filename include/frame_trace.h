@@ -0,0 +1,90 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef FRAME_TRACE_H
+#define FRAME_TRACE_H
+
+#include "latency_histogram.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Where the time of a frame goes on its way from the frame_end callback to
+ * the sockets. Each message carries the time it passed the points of the
+ * pipeline, and once a frame went out the network thread adds the time
+ * between consecutive points to the histogram of the stage ending there.
+ * The histogram of FrameEnd holds the whole way to the last write.
+ */
+enum class TracePoint {
+  /* The game called frame_end */
+  FrameEnd,
+  /* The shared frame is published, a buffer for the frame is due */
+  Snapshot,
+  /* Got the buffer from the pool */
+  EncodeStart,
+  EncodeEnd,
+  /* The queue took the message, after waiting for its lock */
+  Enqueue,
+  Dequeue,
+  /* The first and the last subscriber whose socket took the whole frame */
+  FirstWrite,
+  LastWrite
+};
+#define TRACE_POINT_COUNT 8
+
+/*
+ * The clock of message timestamps, in nanoseconds. It's the monotonic
+ * clock on Linux, so other processes on the machine can compare against it.
+ */
+inline int64_t message_clock_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/* The points a message passed, 0 for the ones it didn't */
+struct MessageTrace {
+  int64_t points[TRACE_POINT_COUNT] = {};
+
+  void Mark(TracePoint point) {
+    points[static_cast<size_t>(point)] = message_clock_ns();
+  }
+  int64_t At(TracePoint point) const {
+    return points[static_cast<size_t>(point)];
+  }
+  void Reset() {
+    for (int64_t &point : points) {
+      point = 0;
+    }
+  }
+};
+
+namespace FrameTracing {
+/* e.g. "encodeEnd", the name of the key in embedded traces */
+const char *PointName(TracePoint point);
+/* Adds the stages of a frame that went out */
+void Record(const MessageTrace &trace);
+const LatencyHistogram &Stage(TracePoint point);
+} // namespace FrameTracing
+
+#endif
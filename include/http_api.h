@@ -0,0 +1,99 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HTTP_API_H
+#define HTTP_API_H
+
+#include "http_request.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json_fwd.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/* Distinct subtrees kept between frames, the cache starts over beyond */
+#define HTTP_MAX_PROJECTIONS 64
+/* Polling clients keep the channels registered for this long */
+#define HTTP_PULL_LINGER_MS 30000
+
+/*
+ * The pull side of the HTTP port. GET /frame returns the latest frame as
+ * sent to the stream clients but without its sequence number, timestamp
+ * and trace, GET /frame/<path> the subtree of its payload at that JSON
+ * pointer, e.g. /frame/truck/engine. GET /config returns the latest config
+ * message of each block as a JSON array, GET /stats the counters of the
+ * network thread and GET /metrics the counters of the whole pipeline for
+ * Prometheus. Responses carry an ETag derived from their content, so
+ * If-None-Match gets a 304 as long as the data didn't change.
+ */
+class HttpApi {
+public:
+  HttpApi();
+  ~HttpApi();
+  /* The frame changed, version has to differ from the previous one */
+  void SetFrame(const std::string *frame, uint64_t version);
+  /* The config messages changed */
+  void SetConfig(const std::string *config);
+  /* Set right before a GET /stats is answered */
+  void SetStats(std::string stats);
+  /* Likewise for GET /metrics, in the Prometheus text format */
+  void SetMetrics(std::string metrics);
+  /* A complete response, the connection is closed after it */
+  std::string Respond(const HttpRequest &request);
+
+  /* True for GET /stream, which is served as Server-Sent Events */
+  static bool IsEventStream(const HttpRequest &request);
+  static bool IsStats(const HttpRequest &request);
+  static bool IsMetrics(const HttpRequest &request);
+  static std::string NotFound();
+  /* The value of ?<name>=<value> in the target, empty if it's missing */
+  static std::string_view QueryParameter(const HttpRequest &request,
+                                         std::string_view name);
+  /* Minimum time between frames asked for with ?rate=<Hz>, 0 for all */
+  static std::chrono::milliseconds StreamInterval(const HttpRequest &request);
+  static std::string EventStreamHeaders();
+  /* Appends one event of the stream, type is the event queue type */
+  static void AppendStreamEvent(std::string *out, std::string_view type,
+                                std::string_view event);
+
+private:
+  struct Projection {
+    uint64_t version = 0;
+    bool found = false;
+    std::string body;
+    std::string etag;
+  };
+  const std::string *m_frame = nullptr;
+  const std::string *m_config = nullptr;
+  std::string m_configEtag;
+  std::string m_stats;
+  std::string m_metrics;
+  uint64_t m_version = 0;
+  std::unordered_map<std::string, Projection> m_projections;
+  /* The frame parsed for projections, once per version */
+  std::unique_ptr<nlohmann::json> m_parsed;
+  uint64_t m_parsedVersion = 0;
+  const Projection &project(std::string_view path);
+};
+
+#endif
@@ -0,0 +1,53 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HTTP_REQUEST_H
+#define HTTP_REQUEST_H
+
+#include <cstddef>
+#include <string_view>
+
+/* Longer requests are refused, clients only ever send a few headers */
+#define HTTP_MAX_REQUEST 8192
+
+/*
+ * Just enough HTTP/1.1 to read the request head of a client. The views
+ * point into the buffer the request was parsed from.
+ */
+struct HttpRequest {
+  std::string_view method;
+  std::string_view target;
+  std::string_view headers;
+  /* Value of the first header called name, empty if missing */
+  std::string_view Header(std::string_view name) const;
+  /* True if the comma separated header contains token, ignoring case */
+  bool HeaderHasToken(std::string_view name, std::string_view token) const;
+};
+
+namespace HttpParser {
+/* Size of the request head including the blank line, 0 if incomplete */
+size_t HeadSize(std::string_view buffer);
+/* Returns false for malformed request lines */
+bool Parse(std::string_view head, HttpRequest *request);
+bool EqualsIgnoreCase(std::string_view a, std::string_view b);
+std::string_view Trim(std::string_view value);
+} // namespace HttpParser
+
+#endif
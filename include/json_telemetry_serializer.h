@@ -25,10 +25,14 @@ If not, see <https://www.gnu.org/licenses/>.
 #include "abstract_telemetry_serializer.h"
 #include "telemetry.h"
 
+/* Enough for every gameplay event the SDK documents */
+#define GAMEPLAY_EVENT_RESERVE 512
+
 class JsonTelemetrySerializer: public AbstractTelemetrySerializer{
 public:
-        virtual std::string SerializeFrame(TelemetryFrame*) override;
-        virtual std::string SerializeEvent(TelemetryGameplayEvent*) override;
+        virtual void SerializeFrame(TelemetryFrame*,std::string* out) override;
+        virtual void SerializeEvent(TelemetryGameplayEvent*,std::string* out) override;
+        virtual void SerializeConfig(TelemetryFrame*,TelemetryConfigBlock block,size_t index,std::string* out) override;
         virtual ~JsonTelemetrySerializer() override;
 };
 
@@ -0,0 +1,83 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include "telemetry.h"
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Groups of fields a frame can be written without, see AppendFrame */
+#define FRAME_FIELDS_WHEELS 0x1u
+#define FRAME_FIELDS_TRAILERS 0x2u
+/* All but the game state and the dashboard values of the truck */
+#define FRAME_FIELDS_NON_GAUGES 0x4u
+
+/*
+ * Appends JSON to a string without building json objects first, for the
+ * messages sent all the time. The output is byte for byte what json::dump
+ * makes of the same values: keys sorted, strings escaped the same way,
+ * floating point numbers in the same shortest form and non-finite ones as
+ * null.
+ */
+namespace JsonWriter {
+/* The contents of a JSON string, without the quotes */
+void AppendEscaped(std::string *out, std::string_view text);
+void AppendString(std::string *out, std::string_view text);
+void AppendDouble(std::string *out, double value);
+template <typename T> void AppendInteger(std::string *out, T value) {
+  char buffer[24];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out->append(buffer, static_cast<size_t>(result.ptr - buffer));
+}
+/* How AppendFrame writes a frame, by default as json::dump does */
+struct FrameFormat {
+  /* The FRAME_FIELDS_* groups left out */
+  uint32_t omit = 0;
+  /* Keys in place of the field names by KeyIndex, nullptr for the names */
+  const std::vector<std::string> *keys = nullptr;
+  /*
+   * Objects as arrays of their values in the order of telemetry_schema.h,
+   * with null for the fields left out
+   */
+  bool positional = false;
+  /* Wheel and trailer arrays filled up to their size with default values */
+  bool fixed = false;
+};
+/*
+ * A number for each field name of the telemetry types, for keys above. The
+ * name is kept, so it has to be a literal.
+ */
+size_t KeyIndex(std::string_view name);
+/* The payload of a frame, as to_json in telemetry_json.h has it */
+void AppendFrame(std::string *out, const TelemetryFrame &frame,
+                 const FrameFormat &format = FrameFormat());
+/* The payload of a config message, see config_to_json in telemetry_json.h */
+void AppendConfig(std::string *out, const TelemetryFrame &frame,
+                  TelemetryConfigBlock block, size_t index);
+} // namespace JsonWriter
+
+#endif
@@ -0,0 +1,85 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/*
+ * Nanosecond latencies in log-linear buckets: every power of two is split
+ * into LATENCY_SUB_BUCKETS, so percentiles are within 1/16 of the real
+ * value whatever the range.
+ */
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS (64 * LATENCY_SUB_BUCKETS)
+
+struct LatencySummary {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+  /* Upper bounds of the buckets holding them */
+  uint64_t p50 = 0;
+  uint64_t p90 = 0;
+  uint64_t p99 = 0;
+  uint64_t p999 = 0;
+};
+
+/*
+ * Recording is a few relaxed atomic adds and never allocates, so one
+ * thread can record while others read without a lock; a reader may see a
+ * sample in the sum before it sees its bucket. Percentiles are the upper
+ * bound of the bucket holding the sample of rank ceil(q * count).
+ */
+class LatencyHistogram {
+public:
+  /* Negative values, e.g. from clocks of different cores, count as 0 */
+  void Record(int64_t nanoseconds);
+  void Merge(const LatencyHistogram &other);
+
+  uint64_t Count() const;
+  uint64_t Sum() const { return m_sum.load(std::memory_order_relaxed); }
+  uint64_t Max() const { return m_max.load(std::memory_order_relaxed); }
+  double Mean() const;
+  /* q in [0, 1] */
+  uint64_t Percentile(double q) const;
+  LatencySummary Summarize() const;
+  /* A summary line and a bar per power of two */
+  void Print(FILE *out, const char *title) const;
+
+  /* The upper bound of a bucket in nanoseconds */
+  static uint64_t UpperBound(size_t bucket);
+  uint64_t Bucket(size_t bucket) const {
+    return m_buckets[bucket].load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> m_buckets[LATENCY_BUCKETS] = {};
+  std::atomic<uint64_t> m_sum{0};
+  std::atomic<uint64_t> m_max{0};
+};
+
+#endif
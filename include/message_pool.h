@@ -0,0 +1,135 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef MESSAGE_POOL_H
+#define MESSAGE_POOL_H
+
+#include "frame_trace.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Size classes are powers of two from 256 bytes to 8 MB */
+#define MESSAGE_POOL_MIN_SHIFT 8
+#define MESSAGE_POOL_CLASSES 16
+/* Free buffers kept per class, the ones beyond are freed */
+#define MESSAGE_POOL_MAX_FREE 32
+
+class MessagePool;
+struct TelemetryFrame;
+
+struct MessageBuffer {
+  std::string data;
+  /* When the game produced the message, 0 if it wasn't timed */
+  int64_t timestamp = 0;
+  MessageTrace trace;
+  /* The frame a frame message was encoded from, if hasFrame is set */
+  std::unique_ptr<TelemetryFrame> frame;
+  bool hasFrame = false;
+  std::atomic<uint32_t> references{0};
+  MessagePool *pool = nullptr;
+};
+
+/*
+ * A counted reference to a pooled message. Copies share the buffer, which
+ * goes back to its pool once the last one is gone, with its capacity left
+ * as it was.
+ */
+class MessageRef {
+public:
+  MessageRef() = default;
+  MessageRef(const MessageRef &other) noexcept;
+  MessageRef(MessageRef &&other) noexcept : m_buffer(other.m_buffer) {
+    other.m_buffer = nullptr;
+  }
+  MessageRef &operator=(const MessageRef &other) noexcept;
+  MessageRef &operator=(MessageRef &&other) noexcept;
+  ~MessageRef() { reset(); }
+
+  std::string &operator*() const { return m_buffer->data; }
+  std::string *operator->() const { return &m_buffer->data; }
+  explicit operator bool() const { return m_buffer != nullptr; }
+  int64_t Timestamp() const { return m_buffer->timestamp; }
+  void SetTimestamp(int64_t timestamp) const {
+    m_buffer->timestamp = timestamp;
+  }
+  MessageTrace &Trace() const { return m_buffer->trace; }
+  void Mark(TracePoint point) const { m_buffer->trace.Mark(point); }
+  /*
+   * Keeps a copy of the frame along with the message, for encodings the
+   * network thread derives from it. The copy is kept with the buffer, so
+   * it only allocates until the pool has warmed up.
+   */
+  void KeepFrame(const TelemetryFrame &frame) const;
+  /* The frame kept with the message, nullptr if there is none */
+  const TelemetryFrame *Frame() const {
+    return m_buffer->hasFrame ? m_buffer->frame.get() : nullptr;
+  }
+  void reset() noexcept;
+
+private:
+  friend class MessagePool;
+  explicit MessageRef(MessageBuffer *buffer) noexcept;
+  MessageBuffer *m_buffer = nullptr;
+};
+
+struct MessagePoolStats {
+  /* Buffers that had to be allocated */
+  uint64_t allocated = 0;
+  /* Buffers handed out again */
+  uint64_t recycled = 0;
+  /* Buffers freed because their class had enough */
+  uint64_t freed = 0;
+  size_t free = 0;
+};
+
+/*
+ * Recycles the buffers of the messages the game thread hands to the
+ * network thread. Buffers are kept by size class, so a frame finds one
+ * that already has room for it and, once the pool has warmed up, neither
+ * thread allocates for the messages themselves. Safe to use from any
+ * thread; the pool has to outlive the references it handed out.
+ */
+class MessagePool {
+public:
+  MessagePool();
+  ~MessagePool();
+  MessagePool(const MessagePool &) = delete;
+  MessagePool &operator=(const MessagePool &) = delete;
+  /* An empty buffer with room for at least size bytes */
+  MessageRef Acquire(size_t size);
+  MessagePoolStats Stats() const;
+
+private:
+  friend class MessageRef;
+  void release(MessageBuffer *buffer);
+
+  mutable std::mutex m_mutex;
+  std::vector<MessageBuffer *> m_free[MESSAGE_POOL_CLASSES];
+  MessagePoolStats m_stats;
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "frame_trace.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*
+ * Counters and histograms of the pipeline for GET /metrics, in the
+ * Prometheus text format. Recording is a relaxed atomic add, it never
+ * locks or allocates, so the game thread records on every callback and the
+ * network thread reads them when it's scraped.
+ */
+
+/* Histogram buckets go from 2^METRICS_FIRST_OCTAVE ns, about 1 us... */
+#define METRICS_FIRST_OCTAVE 10
+/* ...to 2^METRICS_LAST_OCTAVE ns, about a second */
+#define METRICS_LAST_OCTAVE 30
+
+class MetricCounter {
+public:
+  void Add(uint64_t value = 1) {
+    m_value.fetch_add(value, std::memory_order_relaxed);
+  }
+  uint64_t Value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint64_t> m_value{0};
+};
+
+/* The SDK callbacks that are timed, the channel callbacks are too short */
+enum class MetricCallback { FrameStart, FrameEnd, Configuration, Gameplay };
+#define METRIC_CALLBACK_COUNT 4
+enum class MetricMessage { Frame, Config, Gameplay };
+#define METRIC_MESSAGE_COUNT 3
+
+/* What the game thread records */
+struct PipelineMetrics {
+  /* Frames the scheduler let through and the ones it held back */
+  MetricCounter framesEmitted;
+  MetricCounter framesSuppressed;
+  MetricCounter messages[METRIC_MESSAGE_COUNT];
+  MetricCounter encodedBytes[METRIC_MESSAGE_COUNT];
+  LatencyHistogram encode[METRIC_MESSAGE_COUNT];
+  LatencyHistogram callbacks[METRIC_CALLBACK_COUNT];
+};
+
+/* Writes the text exposition format, version 0.0.4 */
+class PrometheusWriter {
+public:
+  explicit PrometheusWriter(std::string *out) : m_out(out) {}
+  /* The HELP and TYPE lines, before the samples of the metric */
+  void Describe(const char *name, const char *type, const char *help);
+  /* labels are pairs without the braces, e.g. qos="realtime", or empty */
+  void Sample(const char *name, std::string_view labels, uint64_t value);
+  void Sample(const char *name, std::string_view labels, double value);
+  /* The _bucket, _sum and _count series of a histogram, in seconds */
+  void Histogram(const char *name, std::string_view labels,
+                 const LatencyHistogram &histogram);
+
+private:
+  void begin(const char *name, const char *suffix, std::string_view labels,
+             std::string_view extra);
+  std::string *m_out;
+};
+
+namespace Metrics {
+PipelineMetrics &Pipeline();
+void CountMessage(MetricMessage message, size_t bytes, int64_t encodeStart,
+                  int64_t encodeEnd);
+/* The metrics of the pipeline, the frame trace and the allocations */
+void Render(PrometheusWriter *writer);
+} // namespace Metrics
+
+/* Adds the time until it's destroyed to the histogram of a callback */
+class CallbackTimer {
+public:
+  explicit CallbackTimer(MetricCallback callback)
+      : m_callback(callback), m_start(message_clock_ns()) {}
+  ~CallbackTimer() {
+    Metrics::Pipeline()
+        .callbacks[static_cast<size_t>(m_callback)]
+        .Record(message_clock_ns() - m_start);
+  }
+  CallbackTimer(const CallbackTimer &) = delete;
+  CallbackTimer &operator=(const CallbackTimer &) = delete;
+
+private:
+  MetricCallback m_callback;
+  int64_t m_start;
+};
+
+#endif
@@ -21,12 +21,28 @@ If not, see <https://www.gnu.org/licenses/>.
 #ifndef NETWORK_HANDLER_H
 #define NETWORK_HANDLER_H
 
+#include "compression.h"
 #include "event_queue.h"
+#include "frame_dialect.h"
+#include "frame_lod.h"
+#include "frame_trace.h"
+#include "http_api.h"
+#include "message_pool.h"
+#include "metrics.h"
+#include "plugin_options.h"
+#include "qos.h"
+#include "replay_ring.h"
+#include "snapshot.h"
+#include "websocket.h"
 
+#include <atomic>
+#include <chrono>
 #include <list>
+#include <memory>
 #include <string>
 #include <thread>
 #include <stop_token>
+#include <vector>
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -43,38 +59,294 @@ typedef long ssize_t;
 #include <sys/types.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <sys/un.h>
 #define INVALID_SOCKET -1
 #define SOCKET int
 #define CLOSE_SOCKET close
 #endif
 #define MAX_CLIENTS 8
+/* A subscriber that can't take anything for this long is dropped */
 #define TIMEOUT_SEND_SEC 5
+/* Or once this much is waiting for it */
+#define SUBSCRIBER_MAX_BACKLOG (8 * 1024 * 1024)
 #define PORT 3101
+/* The longest the network thread sleeps with nothing to do */
+#define NETWORK_WAIT_MAX_MS 100
+/* How long a new connection may send commands, a resume above all, before its bundle goes out */
+#define BOOTSTRAP_WAIT_MS 50
+/* Commands of stream clients are short, longer ones are refused */
+#define COMMAND_MAX_SIZE 4096
+/* Large enough for a whole frame in one SOCK_SEQPACKET message */
+#define UNIX_SEND_BUFFER (1024 * 1024)
+/* Frames in a row a subscriber has to fall behind on to lose a tier */
+#define LOD_CONGESTED_FRAMES 3
+/* Time a subscriber has to keep up before trying the next tier up */
+#define LOD_PROBE_MS 2000
+#define LOD_PROBE_MAX_MS 32000
+
+enum class Transport{
+        Tcp,
+        /* Message boundaries come from the socket, no NUL separator */
+        UnixSeqPacket,
+        /* Fallback where SOCK_SEQPACKET isn't supported, framed like TCP */
+        UnixStream,
+        /* Connected to the HTTP port, waiting for the request */
+        HttpPending,
+        /* Upgraded, every event is a text message */
+        WebSocket,
+        /* GET /stream, Server-Sent Events */
+        EventStream
+};
+#define TRANSPORT_COUNT 6
+
+/* Why the plugin hung up on a subscriber, for the metrics */
+enum class DisconnectReason{
+        /* The client closed the connection or sent something invalid */
+        Client,
+        /* The socket failed */
+        Error,
+        /* More than the limit of its QoS class was waiting */
+        Backlog,
+        /* Took nothing for TIMEOUT_SEND_SEC */
+        Timeout,
+        /* Turned away at MAX_CLIENTS */
+        Refused
+};
+#define DISCONNECT_REASON_COUNT 5
+
+/* A message the socket didn't take yet */
+struct OutboxMessage{
+        /* Shared with the other outboxes that queued the same message */
+        MessageRef data;
+        /* The bytes to send, a stream terminator may follow the string */
+        size_t size = 0;
+        /* When the game ended the frame it holds, 0 for other messages */
+        int64_t origin = 0;
+};
+
+/*
+ * Queue of one subscriber's messages. A ring that keeps its slots, so a
+ * subscriber that is always a few messages behind doesn't allocate.
+ */
+class OutboxLane{
+public:
+        bool empty() const{ return m_count == 0; }
+        size_t size() const{ return m_count; }
+        OutboxMessage& front(){ return m_slots[m_head]; }
+        OutboxMessage& back(){ return m_slots[(m_head + m_count - 1) % m_slots.size()]; }
+        void push_back(OutboxMessage message){
+                if(m_count == m_slots.size()){
+                        /* Unroll the ring into a bigger one */
+                        std::vector<OutboxMessage> slots(m_slots.empty() ? 4 : m_slots.size() * 2);
+                        for(size_t i = 0; i < m_count; i++){
+                                slots[i] = std::move(m_slots[(m_head + i) % m_slots.size()]);
+                        }
+                        m_slots = std::move(slots);
+                        m_head = 0;
+                }
+                m_slots[(m_head + m_count) % m_slots.size()] = std::move(message);
+                m_count++;
+        }
+        /* The buffers go back to their pool right away */
+        void pop_front(){
+                m_slots[m_head].data.reset();
+                m_head = (m_head + 1) % m_slots.size();
+                m_count--;
+        }
+        void pop_back(){
+                back().data.reset();
+                m_count--;
+        }
+private:
+        std::vector<OutboxMessage> m_slots;
+        size_t m_head = 0;
+        size_t m_count = 0;
+};
+
+struct Subscriber{
+        SOCKET socket;
+        Transport transport;
+        /* Numbers the connections since the plugin was loaded */
+        uint64_t id = 0;
+        /* Connected to the metrics port */
+        bool metricsOnly = false;
+        /* Unparsed input of HTTP and WebSocket clients */
+        std::string input;
+        /* Set if the client negotiated permessage-deflate */
+        std::unique_ptr<MessageDeflater> deflater;
+        /* Frame rate limit of event stream clients */
+        std::chrono::milliseconds interval{0};
+        std::chrono::steady_clock::time_point nextFrame;
+        Compression compression = Compression::None;
+        /* Got the start of the compressed stream, see compression.h */
+        bool synced = false;
+        QosClass qos = QosClass::Realtime;
+        TokenBucket bucket;
+        /* What the socket didn't take yet, one entry per message */
+        OutboxLane outbox;
+        /* Frames wait here so that everything else can overtake them */
+        OutboxLane frameOutbox;
+        /* The front of a lane is partly sent and has to be finished first */
+        bool inFlight = false;
+        bool frameInFlight = false;
+        size_t outboxOffset = 0;
+        size_t outboxSize = 0;
+        std::chrono::steady_clock::time_point lastProgress;
+        /* Has queued messages but no tokens, left out of the write set */
+        bool throttled = false;
+        /* Hang up once the outbox is empty, after an HTTP response */
+        bool closing = false;
+        /* Gets nothing until its bundle is out at bootstrapAt, or after a resume */
+        bool bootstrapPending = false;
+        std::chrono::steady_clock::time_point bootstrapAt;
+        /* Resumed before the bundle, which then only brings the frame */
+        bool resumed = false;
+        /* The last sequence number covered by the bootstrap bundle */
+        uint64_t joinedAt = 0;
+        LodTier tier = LodTier::Full;
+        /* The tier follows congestion unless the client picked one */
+        bool adaptive = true;
+        int congestedFrames = 0;
+        std::chrono::steady_clock::time_point clearSince;
+        std::chrono::steady_clock::time_point lastProbe;
+        std::chrono::milliseconds probeDelay{LOD_PROBE_MS};
+        FrameDialect dialect = FrameDialect::Standard;
+        /* From frame_end until the socket took the whole frame */
+        std::unique_ptr<LatencyHistogram> latency = std::make_unique<LatencyHistogram>();
+};
+
+/* Subscribers with the same compression, dialect and tier share the stream */
+struct CompressionGroup{
+        std::unique_ptr<MessageCompressor> compressor;
+        /* Somebody joined, the next message starts the stream over */
+        bool resetPending = false;
+        /* The current event, compressed once and framed per transport */
+        bool ready = false;
+        MessageRef message;
+        MessageRef streamMessage;
+        MessageRef webSocketMessage;
+};
+
+class UdpPublisher;
 
 class NetworkHandler{
         public:
-                static std::jthread* GetEventThread(EventQueue* queue);
+                static std::jthread* GetEventThread(EventQueue* queue,const PluginOptions& options);
                 void EventLoop(std::stop_token stopToken);
                 static void Cleanup();
+                /* Safe to call from any thread. Only for tools, channel registration follows GetTierDemand */
+                static size_t GetSubscriberCount();
+                /* Safe to call from any thread. Only for tools, the messages waiting in outboxes but frames */
+                static size_t GetQueuedMessages();
+                /* The tiers frames are read in, 1 << LodTier each; HTTP polling reads the full tier */
+                static uint32_t GetTierDemand();
+                /* Whether someone reads frames in another tier or dialect than the full standard one */
+                static bool GetVariantDemand();
         private:
                 #ifdef _WIN32
                 WSAData m_wsaData;
                 #endif
                 SOCKET m_maxSocket = INVALID_SOCKET;
                 SOCKET m_topSocket = INVALID_SOCKET;
-                std::list<SOCKET> m_subscribers;
-                NetworkHandler(EventQueue* queue);
+                SOCKET m_unixSocket = INVALID_SOCKET;
+                SOCKET m_httpSocket = INVALID_SOCKET;
+                SOCKET m_metricsSocket = INVALID_SOCKET;
+                Transport m_unixTransport = Transport::UnixSeqPacket;
+                std::string m_unixSocketPath;
+                /* Buffers of the messages that wait in outboxes, has to outlive them */
+                MessagePool m_sendPool;
+                std::list<Subscriber> m_subscribers;
+                UdpPublisher* m_udpPublisher = nullptr;
+                std::atomic<size_t> m_subscriberCount = 0;
+                std::atomic<size_t> m_queuedMessages = 0;
+                std::atomic<uint32_t> m_tierDemand = 0;
+                std::atomic<bool> m_variantDemand = false;
+                int m_qosRates[QOS_CLASS_COUNT];
+                NetworkHandler(EventQueue* queue,const PluginOptions& options);
                 ~NetworkHandler();
                 EventQueue* m_eventQueue;
                 int m_port;
-                struct timeval m_send_timeout;
                 struct timeval m_select_timeout;
+                /* When the first throttled subscriber may send again or a bundle is due */
+                std::chrono::steady_clock::time_point m_nextRefill;
                 struct sockaddr_in address;
                 fd_set m_subscriberSet;
-                std::string m_lastSentFrame;
-                int sendMessage(SOCKET socket,const char* msg,ssize_t size);
-                void newConnection();
+                fd_set m_writableSet;
+                ReplayRing m_replay;
+                SnapshotService m_snapshot{m_replay.Session()};
+                /* The bundle framed per transport, for stream transports */
+                MessageRef m_bootstrapMessages[TRANSPORT_COUNT];
+                uint64_t m_bootstrapVersion = 0;
+                /* The current event framed for uncompressed WebSocket clients, per dialect and tier */
+                MessageRef m_webSocketMessage[DIALECT_COUNT * LOD_TIER_COUNT];
+                std::string m_compressedMessage;
+                /* Scratch buffers of sendPrivate and setTier, they keep their capacity */
+                std::string m_privateMessage;
+                std::string m_lodNotice;
+                /* The current event as Server-Sent Event, per dialect and tier */
+                MessageRef m_eventStreamMessage[DIALECT_COUNT * LOD_TIER_COUNT];
+                /*
+                 * The current event as is, per dialect and tier, copied once the first outbox
+                 * needs it. Slow subscribers don't hold on to the buffers of the game thread.
+                 */
+                MessageRef m_plainMessage[DIALECT_COUNT * LOD_TIER_COUNT];
+                CompressionGroup m_compressionGroups[COMPRESSION_COUNT * DIALECT_COUNT * LOD_TIER_COUNT];
+                FrameTiers m_frameTiers;
+                FrameDialects m_frameDialects;
+                /* Whether the current frame goes out on the tier, see Lod::IntervalMs */
+                bool m_tierDue[LOD_TIER_COUNT] = {true,true,true,true};
+                std::chrono::steady_clock::time_point m_nextTierFrame[LOD_TIER_COUNT];
+                HttpApi m_httpApi;
+                uint64_t m_frameVersion = 0;
+                /* The frame being sent to the subscribers, if it is one */
+                MessageTrace* m_trace = nullptr;
+                uint64_t m_nextSubscriberId = 0;
+                /* By transport, dialect and compression of the subscriber */
+                MetricCounter m_sentBytes[TRANSPORT_COUNT * DIALECT_COUNT * COMPRESSION_COUNT];
+                /* Frames dropped from outboxes, by QoS class */
+                MetricCounter m_droppedFrames[QOS_CLASS_COUNT];
+                MetricCounter m_disconnects[DISCONNECT_REASON_COUNT];
+                std::chrono::steady_clock::time_point m_lastPull;
+                /*
+                 * If it has to wait, the outbox shares *shared, which holds msg or is
+                 * filled with a copy the first time. Without it the outbox gets its own.
+                 */
+                int sendMessage(Subscriber& subscriber,const char* msg,size_t size,bool frame = false,MessageRef* shared = nullptr);
+                int sendMessage(Subscriber& subscriber,MessageRef& message,size_t size,bool frame = false);
+                bool flushOutbox(Subscriber& subscriber);
+                void traceWrite(Subscriber& subscriber,int64_t origin);
+                void countSent(const Subscriber& subscriber,size_t bytes);
+                /* Backlog if the subscriber was over its limit, Error otherwise */
+                static DisconnectReason failureOf(const Subscriber& subscriber);
+                void disconnect(Subscriber& subscriber,DisconnectReason reason,std::vector<SOCKET>* deadSockets);
+                static bool canReorder(const Subscriber& subscriber);
+                void setQos(Subscriber& subscriber,QosClass qos);
+                static void deferBootstrap(Subscriber& subscriber);
+                int sendBootstrap(Subscriber& subscriber);
+                void sendDueBootstraps();
+                int sendEvent(Subscriber& subscriber,const std::string& event,const std::string& type);
+                int sendCompressed(Subscriber& subscriber,const std::string& event);
+                int sendPrivate(Subscriber& subscriber,const std::string& message,const char* type);
+                CompressionGroup& compressionGroup(Compression compression,FrameDialect dialect,LodTier tier);
+                void joinCompressionGroup(Subscriber& subscriber);
+                static void appendCompressedFraming(const Subscriber& subscriber,std::string* message);
+                bool setTier(Subscriber& subscriber,LodTier tier,const char* reason);
+                bool setDialect(Subscriber& subscriber,FrameDialect dialect);
+                bool adaptTier(Subscriber& subscriber,std::chrono::steady_clock::time_point now);
+                void clearMessageCaches();
+                bool handleCommand(Subscriber& subscriber,std::string_view command);
+                void openUnixSocket();
+                static SOCKET openHttpSocket(int port);
+                bool readClient(Subscriber& subscriber);
+                bool handleRequest(Subscriber& subscriber,size_t headSize);
+                /* What GET /stats returns */
+                std::string stats() const;
+                /* What GET /metrics returns */
+                std::string metrics();
+                int sendWebSocketControl(Subscriber& subscriber,uint8_t opcode,std::string_view payload);
+                void newConnection(SOCKET listener,Transport transport);
                 void checkDeadConnections();
+                void flushSubscribers();
                 void checkQueue();
                 void fdReset();
                 static NetworkHandler* m_instance;
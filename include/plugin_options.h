@@ -0,0 +1,58 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PLUGIN_OPTIONS_H
+#define PLUGIN_OPTIONS_H
+
+#include <string>
+
+/*
+ * Optional features are configured through environment variables, which
+ * can be set in the launch options of the game, e.g.
+ * TSTS_SHM_NAME=/tstelemetry %command%
+ */
+struct PluginOptions {
+  /* Name of the shared memory frame, disabled if empty */
+  std::string sharedMemoryName;
+  /* Path of the Unix domain socket, disabled if empty */
+  std::string unixSocketPath;
+  /* Multicast group or broadcast address:port for UDP, disabled if empty */
+  std::string udpTarget;
+  /* Extra copies of each gameplay event sent over UDP */
+  int udpRedundancy = 0;
+  /* Port for HTTP and WebSocket clients, disabled if 0 */
+  int httpPort = 0;
+  /* Port that only answers GET /metrics, disabled if 0 */
+  int metricsPort = 0;
+  /* Byte rate limits of the QoS classes, see qos.h, unlimited if 0 */
+  int realtimeRate = 0;
+  int reliableRate = 0;
+  int bestEffortRate = 0;
+  /* Messages carry the time the game produced them, for latency tests */
+  bool timestamps = false;
+  /* Frames carry the times they passed the stages of the plugin */
+  bool trace = false;
+};
+
+namespace PluginOptionsLoader {
+PluginOptions Load();
+}
+
+#endif
@@ -0,0 +1,127 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef QOS_H
+#define QOS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/*
+ * Quality of service classes of subscribers, in the order the network
+ * thread serves them:
+ *
+ * Realtime: lowest latency. A subscriber that falls behind skips to the
+ *   latest frame, gameplay events are never skipped.
+ * Reliable: nothing is skipped and the backlog may grow to
+ *   QOS_RELIABLE_MAX_BACKLOG before the subscriber is dropped.
+ * BestEffort: served last, skips frames like realtime.
+ *
+ * Each class can have a byte rate limit. Everything but frames overtakes
+ * queued frames, unless the messages depend on each other, as with
+ * compression.
+ */
+enum class QosClass { Realtime, Reliable, BestEffort };
+#define QOS_CLASS_COUNT 3
+#define QOS_RELIABLE_MAX_BACKLOG (64 * 1024 * 1024)
+/* Unsent bytes the kernel may hold for the classes that skip frames */
+#define QOS_UNSENT_LIMIT (128 * 1024)
+
+namespace Qos {
+/* Parses "realtime", "reliable" or "best-effort" */
+inline bool Parse(std::string_view name, QosClass *qos) {
+  if (name == "realtime") {
+    *qos = QosClass::Realtime;
+  } else if (name == "reliable") {
+    *qos = QosClass::Reliable;
+  } else if (name == "best-effort") {
+    *qos = QosClass::BestEffort;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+inline const char *Name(QosClass qos) {
+  switch (qos) {
+  case QosClass::Reliable:
+    return "reliable";
+  case QosClass::BestEffort:
+    return "best-effort";
+  default:
+    return "realtime";
+  }
+}
+} // namespace Qos
+
+/*
+ * Byte rate limit that allows bursts of one second. A message may take
+ * more than is left, the bucket pays it back before the next one.
+ */
+class TokenBucket {
+public:
+  /* 0 disables the limit */
+  void SetRate(uint32_t bytesPerSecond) {
+    m_rate = bytesPerSecond;
+    m_tokens = bytesPerSecond;
+    m_last = std::chrono::steady_clock::now();
+  }
+
+  bool Ready(std::chrono::steady_clock::time_point now) {
+    if (m_rate == 0) {
+      return true;
+    }
+    const double elapsed =
+        std::chrono::duration<double>(now - m_last).count();
+    m_last = now;
+    m_tokens += elapsed * m_rate;
+    if (m_tokens > m_rate) {
+      m_tokens = m_rate;
+    }
+    return m_tokens > 0;
+  }
+
+  /* When Ready turns true again, as of the last call to Ready */
+  std::chrono::steady_clock::time_point RefillAt() const {
+    if (m_rate == 0 || m_tokens > 0) {
+      return m_last;
+    }
+    return m_last +
+           std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+               std::chrono::duration<double>(-m_tokens / m_rate)) +
+           std::chrono::microseconds(1);
+  }
+
+  void Take(size_t bytes) {
+    if (m_rate != 0) {
+      m_tokens -= static_cast<double>(bytes);
+    }
+  }
+
+private:
+  double m_rate = 0;
+  double m_tokens = 0;
+  std::chrono::steady_clock::time_point m_last;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef REPLAY_RING_H
+#define REPLAY_RING_H
+
+#include "message_pool.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Gameplay events and config messages kept for resuming clients */
+#define REPLAY_RING_SIZE 256
+
+/*
+ * Numbers every event the network thread sends and keeps the recent
+ * gameplay events and config messages. Frames are numbered on their own,
+ * subscribers skip some of them by design, so a gap in the numbers of the
+ * other messages is a loss and one in those of frames isn't. Both start
+ * at 1 when the plugin is loaded; the session tells one load from the
+ * next.
+ *
+ * Frames aren't kept, each one holds the whole state, so a client that
+ * missed some only needs the latest one. That makes the ring cover hours
+ * of gameplay events in a few kilobytes. Its slots are allocated once.
+ */
+class ReplayRing {
+public:
+  ReplayRing();
+  /*
+   * Appends the next sequence number of its kind, frame or not, to the
+   * JSON object in event as "seq", and the timestamp of timed events after
+   * it as "timestamp", so the keys stay sorted. Frames also get the points
+   * of their trace they passed so far as "trace" if traces are embedded.
+   * Keeps everything but frames.
+   */
+  uint64_t Stamp(const MessageRef &event, const std::string &type);
+  void EmbedTraces(bool embed) { m_embedTraces = embed; }
+  /* The last number of the messages that aren't frames */
+  uint64_t Sequence() const { return m_sequence; }
+  uint64_t Session() const { return m_session; }
+  /* Messages after this one can be replayed */
+  uint64_t Oldest() const { return m_evicted; }
+  struct Entry {
+    uint64_t sequence;
+    std::string type;
+    MessageRef event;
+  };
+  /*
+   * Collects the messages after the sequence number after, up to and
+   * including until. False if some of them were dropped already.
+   */
+  bool Replay(uint64_t after, uint64_t until,
+              std::vector<const Entry *> *out) const;
+
+private:
+  uint64_t m_session;
+  uint64_t m_sequence = 0;
+  uint64_t m_frames = 0;
+  uint64_t m_evicted = 0;
+  bool m_embedTraces = false;
+  /* A ring of REPLAY_RING_SIZE, oldest at m_head */
+  std::vector<Entry> m_events;
+  size_t m_head = 0;
+  size_t m_count = 0;
+};
+
+#endif
@@ -23,22 +23,70 @@ If not, see <https://www.gnu.org/licenses/>.
 #define SCS_VARIABLE_SAVER_H
 #include "scs_sdk/scssdk.h"
 #include "scs_sdk/scssdk_value.h"
+#include "scs_sdk/scssdk_telemetry_channel.h"
+#include "allocation_stats.h"
+#include "telemetry_common.h"
 
+#include <string>
+
+/* Defined by the plugin, set by every channel callback */
+extern bool frameChanged;
 
 /*
- * Namespace containing all functions for storing channel variables
+ * Namespace containing all functions for storing channel variables.
+ * The SCS type is a template parameter so every channel gets a callback
+ * that is typed at compile time instead of switching on value->type.
  */
 namespace ScsVariableSaver{
-        void StoreScsOrientation(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsVector(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsPlacement(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsDouble(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsFloat(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsString(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsU32(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsU64(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsS32(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsS64(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
-        void StoreScsBool(const scs_string_t name, const scs_u32_t index,const scs_value_t *const value, const scs_context_t context);
+        void StoreScsString(const scs_value_t *const value, std::string *target);
+
+        template <scs_value_type_t Type, typename T>
+        inline void Store(const scs_value_t *const value, T *target)
+        {
+                if constexpr (Type == SCS_VALUE_TYPE_bool) {
+                        *target = value->value_bool.value != 0;
+                } else if constexpr (Type == SCS_VALUE_TYPE_s32) {
+                        *target = value->value_s32.value;
+                } else if constexpr (Type == SCS_VALUE_TYPE_u32) {
+                        *target = value->value_u32.value;
+                } else if constexpr (Type == SCS_VALUE_TYPE_s64) {
+                        *target = value->value_s64.value;
+                } else if constexpr (Type == SCS_VALUE_TYPE_u64) {
+                        *target = value->value_u64.value;
+                } else if constexpr (Type == SCS_VALUE_TYPE_float) {
+                        *target = value->value_float.value;
+                } else if constexpr (Type == SCS_VALUE_TYPE_double) {
+                        *target = value->value_double.value;
+                } else if constexpr (Type == SCS_VALUE_TYPE_string) {
+                        StoreScsString(value, target);
+                } else if constexpr (Type == SCS_VALUE_TYPE_dvector) {
+                        target->x = value->value_dvector.x;
+                        target->y = value->value_dvector.y;
+                        target->z = value->value_dvector.z;
+                } else if constexpr (Type == SCS_VALUE_TYPE_euler) {
+                        target->heading = value->value_euler.heading * 360.0f;
+                        target->pitch = value->value_euler.pitch * 360.0f;
+                        target->roll = value->value_euler.roll * 360.0f;
+                } else if constexpr (Type == SCS_VALUE_TYPE_dplacement) {
+                        const scs_value_dplacement_t &source = value->value_dplacement;
+                        target->orientation.heading = source.orientation.heading * 360.0f;
+                        target->orientation.pitch = source.orientation.pitch * 360.0f;
+                        target->orientation.roll = source.orientation.roll * 360.0f;
+                        target->position.x = source.position.x;
+                        target->position.y = source.position.y;
+                        target->position.z = source.position.z;
+                } else {
+                        static_assert(Type == SCS_VALUE_TYPE_bool, "Unsupported channel type");
+                }
+        }
+
+        /* Channel callback, the context points straight at the target field */
+        template <scs_value_type_t Type, typename T>
+        SCSAPI_VOID StoreChannel(const scs_string_t, const scs_u32_t, const scs_value_t *const value, const scs_context_t context)
+        {
+                AllocationScope scope(AllocationStage::Store);
+                Store<Type>(value, static_cast<T*>(context));
+                frameChanged = true;
+        }
 };
-#endif
\ No newline at end of file
+#endif
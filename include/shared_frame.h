@@ -0,0 +1,177 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHARED_FRAME_H
+#define SHARED_FRAME_H
+
+#include "telemetry.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Layout of the shared memory frame. The region starts with a
+ * SharedFrameHeader, followed by a SharedTelemetryFrame at frameOffset.
+ *
+ * The frame is published under a seqlock: the sequence is odd while the
+ * plugin writes and is bumped to the next even value once the frame is
+ * complete. Readers copy the frame and retry if the sequence was odd or
+ * changed meanwhile, see SharedFrameRead. Readers wait for the next frame
+ * with SharedFrameWait, on Linux it sleeps on the sequence with FUTEX_WAIT
+ * after incrementing waiters, the plugin only issues a FUTEX_WAKE when
+ * someone waits.
+ */
+
+#define SHARED_FRAME_MAGIC 0x53545354u /* "TSTS" */
+#define SHARED_FRAME_VERSION 1u
+/*
+ * Times SharedFrameRead tries before giving up. A publish takes well under
+ * a microsecond, the sequence only stays odd if the plugin died in it.
+ */
+#define SHARED_FRAME_READ_RETRIES 10000
+
+/* The channel data of TelemetryFrame, config and job strings left out */
+struct SharedTelemetryFrame {
+  scs_u32_t gameTime;
+  scs_double_t localScale;
+  scs_s32_t multiplayerTimeOffset;
+  scs_s32_t restStop;
+  bool paused;
+  bool idle;
+  scs_double_t jobCargoDamage;
+  TelemetryTruckState truck;
+  TelemetryTrailerState trailer[MAX_TRAILERS];
+};
+
+struct SharedFrameHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t headerSize;
+  uint32_t frameOffset;
+  uint32_t frameSize;
+  /* Offsets inside the frame for readers that don't share these headers */
+  uint32_t gameTimeOffset;
+  uint32_t pausedOffset;
+  uint32_t idleOffset;
+  uint32_t jobCargoDamageOffset;
+  uint32_t truckOffset;
+  uint32_t truckSize;
+  uint32_t truckWheelsOffset;
+  uint32_t trailerOffset;
+  uint32_t trailerSize;
+  uint32_t trailerCount;
+  uint32_t trailerWheelsOffset;
+  uint32_t wheelSize;
+  uint32_t wheelCount;
+  /* Odd while the plugin writes the frame */
+  std::atomic<uint32_t> sequence;
+  /* Readers blocked on the sequence */
+  std::atomic<uint32_t> waiters;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "The seqlock has to work across processes");
+
+/*
+ * Copies the latest consistent frame, returns false if the layout doesn't
+ * match or no consistent frame could be read within
+ * SHARED_FRAME_READ_RETRIES tries. The sequence of the copied frame is
+ * stored in sequence if given.
+ */
+inline bool SharedFrameRead(const SharedFrameHeader *header,
+                            SharedTelemetryFrame *out,
+                            uint32_t *sequence = nullptr) {
+  if (header->magic != SHARED_FRAME_MAGIC ||
+      header->version != SHARED_FRAME_VERSION ||
+      header->frameSize != sizeof(SharedTelemetryFrame)) {
+    return false;
+  }
+  const auto *frame = reinterpret_cast<const unsigned char *>(header) +
+                      header->frameOffset;
+  for (int attempt = 0; attempt < SHARED_FRAME_READ_RETRIES; ++attempt) {
+    if (attempt > 0) {
+      /* Let the plugin finish the frame */
+      std::this_thread::yield();
+    }
+    const uint32_t before = header->sequence.load(std::memory_order_acquire);
+    if (before & 1u) {
+      continue;
+    }
+    memcpy(static_cast<void *>(out), frame, sizeof(SharedTelemetryFrame));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->sequence.load(std::memory_order_relaxed) == before) {
+      if (sequence != nullptr) {
+        *sequence = before;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Blocks until the sequence moves on from sequence, i.e. the plugin
+ * started the next frame, or timeout passes. Returns whether it moved on,
+ * read the frame with SharedFrameRead then. Other platforms than Linux
+ * poll the sequence every millisecond instead.
+ */
+inline bool SharedFrameWait(SharedFrameHeader *header, uint32_t sequence,
+                            std::chrono::milliseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+#ifdef __linux__
+  header->waiters.fetch_add(1, std::memory_order_seq_cst);
+#endif
+  bool moved;
+  while (!(moved = header->sequence.load(std::memory_order_seq_cst) !=
+                   sequence)) {
+    const auto left = deadline - std::chrono::steady_clock::now();
+    if (left <= std::chrono::steady_clock::duration::zero()) {
+      break;
+    }
+#ifdef __linux__
+    const auto nanoseconds =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+    struct timespec wait;
+    wait.tv_sec = static_cast<time_t>(nanoseconds / 1000000000);
+    wait.tv_nsec = static_cast<long>(nanoseconds % 1000000000);
+    /* Returns right away if the sequence isn't sequence any more */
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&header->sequence),
+            FUTEX_WAIT, sequence, &wait, nullptr, 0);
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+  }
+#ifdef __linux__
+  header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+#endif
+  return moved;
+}
+
+#endif
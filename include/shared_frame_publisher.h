@@ -0,0 +1,52 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHARED_FRAME_PUBLISHER_H
+#define SHARED_FRAME_PUBLISHER_H
+
+#include "shared_frame.h"
+#include "telemetry.h"
+
+#include <cstddef>
+#include <string>
+
+/*
+ * Publishes the channel data of every frame in a POSIX shared memory
+ * object for local consumers, see shared_frame.h for the layout.
+ */
+class SharedFramePublisher {
+public:
+  /* Throws std::runtime_error if the region can't be created */
+  explicit SharedFramePublisher(const std::string &name);
+  ~SharedFramePublisher();
+  SharedFramePublisher(const SharedFramePublisher &) = delete;
+  SharedFramePublisher &operator=(const SharedFramePublisher &) = delete;
+  /* Called on the game thread, costs a copy of the frame */
+  void Publish(const TelemetryFrame &frame);
+
+private:
+  std::string m_name;
+  size_t m_size = 0;
+  void *m_region = nullptr;
+  SharedFrameHeader *m_header = nullptr;
+  SharedTelemetryFrame *m_frame = nullptr;
+};
+
+#endif
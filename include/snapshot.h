@@ -0,0 +1,84 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "message_pool.h"
+
+#include <cstdint>
+#include <nlohmann/json_fwd.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Kinds of gameplay events kept, the oldest one is dropped beyond */
+#define SNAPSHOT_MAX_EVENTS 16
+#define EVENT_SNAPSHOT "snapshot"
+
+struct SnapshotMessage {
+  const std::string *event;
+  const char *type;
+};
+
+/*
+ * What a subscriber needs to pick up the stream halfway through. Fed with
+ * every event the network thread sends, it keeps the latest frame, the
+ * latest config message of each block and the latest gameplay event of
+ * each type.
+ *
+ * The bundle starts with a message listing those events,
+ *   {"payload":{"events":[...],"session":...},"payloadType":"snapshot"}
+ * followed by the config messages and the frame as they were sent.
+ * Everything sent after the bundle follows on from it. The session is the
+ * one of the ReplayRing.
+ */
+class SnapshotService {
+public:
+  explicit SnapshotService(uint64_t session) : m_session(session) {}
+  /* Keeps a reference to the messages it needs, doesn't copy them */
+  void Update(const MessageRef &event, const std::string &type);
+  /* Changes whenever the bundle does */
+  uint64_t Version() const { return m_version; }
+  /* Empty until the first frame */
+  const std::string &Keyframe() const;
+  /* The bootstrap messages in order, empty until the first frame */
+  const std::vector<SnapshotMessage> &Bundle();
+  /* The config messages as a JSON array */
+  const std::string &Config();
+
+private:
+  uint64_t m_session;
+  uint64_t m_version = 0;
+  MessageRef m_keyframe;
+  /* By event type, oldest first */
+  std::vector<std::pair<std::string, MessageRef>> m_events;
+  /* By block, "truck", "job" or "trailer.<index>" */
+  std::vector<std::pair<std::string, MessageRef>> m_configs;
+  /* Built on demand, empty after a change */
+  std::string m_config;
+  std::string m_summary;
+  std::vector<SnapshotMessage> m_bundle;
+  uint64_t m_bundleVersion = 0;
+  void updateConfig(const nlohmann::json &parsed, const MessageRef &event);
+};
+
+#endif
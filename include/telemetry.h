@@ -21,19 +21,52 @@ If not, see <https://www.gnu.org/licenses/>.
 #ifndef TELEMETRY_H
 #define TELEMETRY_H
 #include "scs_sdk/common/scssdk_telemetry_common_configs.h"
+#include "scs_sdk/common/scssdk_telemetry_common_gameplay_events.h"
 #include "scs_sdk/scssdk.h"
+#include "scs_sdk/scssdk_value.h"
 #include "telemetry_job.h"
 #include "telemetry_trailer.h"
 #include "telemetry_truck.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <string>
-#include <unordered_map>
-#include <variant>
+#include <string_view>
 
 #define MAX_TRAILERS SCS_TELEMETRY_trailers_count
+/* The SDK sends a handful per event, the rest would be dropped */
+#define MAX_GAMEPLAY_ATTRIBUTES 32
+#define GAMEPLAY_ATTRIBUTE_UNKNOWN 0xff
 
-#define GAMEPLAY_ATTR_VARIANT                                                  \
-  std::variant<std::string, scs_float_t, scs_double_t, scs_s32_t, scs_s64_t,   \
-               scs_u32_t, scs_u64_t, bool>
+/* The attribute names the SDK documents, sorted */
+inline constexpr std::string_view GameplayAttributeNames[] = {
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_auto_load_used,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_auto_park_used,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_cancel_penalty,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_cargo_damage,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_delivery_time,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_distance_km,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_earned_xp,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_fine_amount,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_fine_offence,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_pay_amount,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_revenue,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_source_id,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_source_name,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_target_id,
+    SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_target_name};
+static_assert(std::is_sorted(std::begin(GameplayAttributeNames),
+                             std::end(GameplayAttributeNames)));
+
+/* The index of name in GameplayAttributeNames */
+inline uint8_t gameplay_attribute_key(std::string_view name) {
+  const auto found = std::lower_bound(std::begin(GameplayAttributeNames),
+                                      std::end(GameplayAttributeNames), name);
+  if (found == std::end(GameplayAttributeNames) || *found != name) {
+    return GAMEPLAY_ATTRIBUTE_UNKNOWN;
+  }
+  return static_cast<uint8_t>(found - std::begin(GameplayAttributeNames));
+}
 
 struct TelemetryFrame {
   scs_u32_t gameTime = scs_u32_t(0);
@@ -41,13 +74,31 @@ struct TelemetryFrame {
   scs_s32_t multiplayerTimeOffset = scs_s32_t(0);
   scs_s32_t restStop = scs_s32_t(0);
   bool paused = true;
+  /* Set while the server only sends heartbeat frames */
+  bool idle = false;
   TelemetryTruck truck = {};
   TelemetryTrailer trailer[MAX_TRAILERS] = {};
   TelemetryJob job = {};
+  /* Bumped with every config message, frames carry the latest one */
+  scs_u64_t configVersion = scs_u64_t(0);
+};
+/* The configuration that changed, see SerializeConfig */
+enum class TelemetryConfigBlock { Truck, Trailer, Job };
+struct TelemetryGameplayAttribute {
+  /* GAMEPLAY_ATTRIBUTE_UNKNOWN if the name isn't in GameplayAttributeNames */
+  uint8_t key;
+  std::string_view name;
+  scs_value_t value;
 };
+/*
+ * A gameplay event as the SDK sent it, copied without allocating. The
+ * event type, unknown names and string values point into the SDK's memory,
+ * so the event has to be serialized before the callback returns.
+ */
 struct TelemetryGameplayEvent {
-  std::string eventType;
-  std::unordered_map<std::string, GAMEPLAY_ATTR_VARIANT> attributes;
+  std::string_view eventType;
+  size_t attributeCount = 0;
+  TelemetryGameplayAttribute attributes[MAX_GAMEPLAY_ATTRIBUTES];
 };
 
 template <typename T> struct TelemetryPayload {
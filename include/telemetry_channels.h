@@ -0,0 +1,390 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TELEMETRY_CHANNELS_H
+#define TELEMETRY_CHANNELS_H
+
+#include "scs_sdk/common/scssdk_telemetry_common_channels.h"
+#include "scs_sdk/common/scssdk_telemetry_job_common_channels.h"
+#include "scs_sdk/common/scssdk_telemetry_trailer_common_channels.h"
+#include "scs_sdk/common/scssdk_telemetry_truck_common_channels.h"
+#include "scs_sdk/scssdk_telemetry_channel.h"
+#include "scs_variable_saver.h"
+#include "telemetry.h"
+
+#include <cstddef>
+#include <cstdio>
+
+/* Which part of the frame a channel is stored in, and how it is indexed */
+enum class ChannelScope {
+  /* Stored directly in the frame, not indexed */
+  Frame,
+  /* Indexed by truck wheel */
+  TruckWheel,
+  /* Name is prefixed by the trailer index, not indexed */
+  Trailer,
+  /* Name is prefixed by the trailer index, indexed by trailer wheel */
+  TrailerWheel
+};
+
+/* Resolves the field a channel is stored in */
+typedef void *(*ChannelTarget)(TelemetryFrame *frame, scs_u32_t trailer,
+                               scs_u32_t wheel);
+
+struct ChannelEntry {
+  scs_string_t name;
+  ChannelScope scope;
+  scs_value_type_t type;
+  scs_telemetry_channel_callback_t callback;
+  ChannelTarget target;
+  /* Needed by the plugin itself, registered even without consumers */
+  bool required = false;
+};
+
+namespace TelemetryChannels {
+
+/* Walks a chain of member pointers, starting from the scope's owner */
+template <ChannelScope Scope, auto... Members>
+void *Target(TelemetryFrame *frame, scs_u32_t trailer, scs_u32_t wheel) {
+  if constexpr (Scope == ChannelScope::Frame) {
+    return &(*frame .* ... .* Members);
+  } else if constexpr (Scope == ChannelScope::TruckWheel) {
+    return &(frame->truck.wheels[wheel] .* ... .* Members);
+  } else if constexpr (Scope == ChannelScope::Trailer) {
+    return &(frame->trailer[trailer] .* ... .* Members);
+  } else {
+    return &(frame->trailer[trailer].wheels[wheel] .* ... .* Members);
+  }
+}
+
+template <typename M> struct MemberType;
+template <typename C, typename T> struct MemberType<T C::*> {
+  typedef T type;
+};
+
+template <ChannelScope Scope, scs_value_type_t Type, auto... Members>
+constexpr ChannelEntry Channel(scs_string_t name) {
+  /* The last member pointer of the chain names the stored type */
+  typedef typename MemberType<decltype((Members, ...))>::type Stored;
+  return {name, Scope, Type, &ScsVariableSaver::StoreChannel<Type, Stored>,
+          &Target<Scope, Members...>};
+}
+
+constexpr ChannelEntry Required(ChannelEntry entry) {
+  entry.required = true;
+  return entry;
+}
+
+template <scs_value_type_t Type, auto... Members>
+constexpr ChannelEntry Global(scs_string_t name) {
+  return Channel<ChannelScope::Frame, Type, Members...>(name);
+}
+template <scs_value_type_t Type, auto... Members>
+constexpr ChannelEntry Truck(scs_string_t name) {
+  return Channel<ChannelScope::Frame, Type, &TelemetryFrame::truck,
+                 Members...>(name);
+}
+template <scs_value_type_t Type, auto... Members>
+constexpr ChannelEntry TruckWheel(scs_string_t name) {
+  return Channel<ChannelScope::TruckWheel, Type, Members...>(name);
+}
+template <scs_value_type_t Type, auto... Members>
+constexpr ChannelEntry Trailer(scs_string_t name) {
+  return Channel<ChannelScope::Trailer, Type, Members...>(name);
+}
+template <scs_value_type_t Type, auto... Members>
+constexpr ChannelEntry TrailerWheel(scs_string_t name) {
+  return Channel<ChannelScope::TrailerWheel, Type, Members...>(name);
+}
+
+#define CH_BOOL SCS_VALUE_TYPE_bool
+#define CH_U32 SCS_VALUE_TYPE_u32
+#define CH_S32 SCS_VALUE_TYPE_s32
+#define CH_FLOAT SCS_VALUE_TYPE_float
+#define CH_DOUBLE SCS_VALUE_TYPE_double
+#define CH_VECTOR SCS_VALUE_TYPE_dvector
+#define CH_PLACEMENT SCS_VALUE_TYPE_dplacement
+
+typedef TelemetryTruck TK;
+typedef TelemetryTrailer TL;
+typedef TelemetryWheel WH;
+
+/*
+ * Every channel the plugin stores. Required channels drive the idle mode and
+ * the demand tracking in ChannelRegistry, the rest is only registered while
+ * someone consumes it.
+ */
+inline constexpr ChannelEntry Table[] = {
+    /* General channels */
+    Global<CH_U32, &TelemetryFrame::gameTime>(SCS_TELEMETRY_CHANNEL_game_time),
+    Global<CH_DOUBLE, &TelemetryFrame::localScale>(
+        SCS_TELEMETRY_CHANNEL_local_scale),
+    Global<CH_S32, &TelemetryFrame::multiplayerTimeOffset>(
+        SCS_TELEMETRY_CHANNEL_multiplayer_time_offset),
+    Global<CH_S32, &TelemetryFrame::restStop>(
+        SCS_TELEMETRY_CHANNEL_next_rest_stop),
+
+    /* Non-indexed truck channels */
+    Truck<CH_PLACEMENT, &TK::worldPlacement>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_world_placement),
+    Truck<CH_VECTOR, &TK::localLinearVelocity>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_local_linear_velocity),
+    Truck<CH_VECTOR, &TK::localLinearAcceleration>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_local_linear_acceleration),
+    Truck<CH_VECTOR, &TK::localAngularAcceleration>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_local_angular_acceleration),
+    Truck<CH_VECTOR, &TK::localAngularVelocity>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_local_angular_velocity),
+    Truck<CH_PLACEMENT, &TK::cabin, &TelemetryTruckCabin::offset>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_cabin_offset),
+    Truck<CH_VECTOR, &TK::cabin, &TelemetryTruckCabin::angularAcceleration>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_cabin_angular_acceleration),
+    Truck<CH_VECTOR, &TK::cabin, &TelemetryTruckCabin::angularVelocity>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_cabin_angular_velocity),
+    Truck<CH_PLACEMENT, &TK::headOffset>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_head_offset),
+    Required(
+        Truck<CH_DOUBLE, &TK::speed>(SCS_TELEMETRY_TRUCK_CHANNEL_speed)),
+    Truck<CH_DOUBLE, &TK::engine, &TelemetryTruckEngine::rpm>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_engine_rpm),
+    Truck<CH_S32, &TK::engine, &TelemetryTruckEngine::gear>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_engine_gear),
+    Required(Truck<CH_BOOL, &TK::engine, &TelemetryTruckEngine::enabled>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_engine_enabled)),
+    Truck<CH_S32, &TK::displayedGear>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_displayed_gear),
+    Required(Truck<CH_DOUBLE, &TK::input, &TelemetryTruckInput::steering>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_input_steering)),
+    Required(Truck<CH_DOUBLE, &TK::input, &TelemetryTruckInput::brake>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_input_brake)),
+    Required(Truck<CH_DOUBLE, &TK::input, &TelemetryTruckInput::throttle>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_input_throttle)),
+    Required(Truck<CH_DOUBLE, &TK::input, &TelemetryTruckInput::clutch>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_input_clutch)),
+    Truck<CH_DOUBLE, &TK::effective, &TelemetryTruckInput::steering>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_effective_steering),
+    Truck<CH_DOUBLE, &TK::effective, &TelemetryTruckInput::brake>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_effective_brake),
+    Truck<CH_DOUBLE, &TK::effective, &TelemetryTruckInput::throttle>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_effective_throttle),
+    Truck<CH_DOUBLE, &TK::effective, &TelemetryTruckInput::clutch>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_effective_clutch),
+    Truck<CH_DOUBLE, &TK::cruiseControl>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_cruise_control),
+    Truck<CH_BOOL, &TK::brake, &TelemetryTruckBrake::parking>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_parking_brake),
+    Truck<CH_BOOL, &TK::brake, &TelemetryTruckBrake::motor>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_motor_brake),
+    Truck<CH_U32, &TK::brake, &TelemetryTruckBrake::retarder>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_retarder_level),
+    Truck<CH_DOUBLE, &TK::brake, &TelemetryTruckBrake::airPressure>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_brake_air_pressure),
+    Truck<CH_BOOL, &TK::brake, &TelemetryTruckBrake::airPressureWarning>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_brake_air_pressure_warning),
+    Truck<CH_BOOL, &TK::brake, &TelemetryTruckBrake::airPressureEmergency>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_brake_air_pressure_emergency),
+    Truck<CH_DOUBLE, &TK::brake, &TelemetryTruckBrake::temperature>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_brake_temperature),
+    Truck<CH_DOUBLE, &TK::fuel, &TelemetryTruckFuel::amount>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_fuel),
+    Truck<CH_DOUBLE, &TK::fuel, &TelemetryTruckFuel::averageConsumption>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_fuel_average_consumption),
+    Truck<CH_DOUBLE, &TK::fuel, &TelemetryTruckFuel::range>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_fuel_range),
+    Truck<CH_BOOL, &TK::fuel, &TelemetryTruckFuel::warning>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_fuel_warning),
+    Truck<CH_DOUBLE, &TK::adblue, &TelemetryTruckAdblue::amount>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_adblue),
+    /* Not supported by the latest game version (yet) */
+    Truck<CH_DOUBLE, &TK::adblue, &TelemetryTruckAdblue::averageConsumption>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_adblue_average_consumption),
+    Truck<CH_BOOL, &TK::adblue, &TelemetryTruckAdblue::warning>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_adblue_warning),
+    Truck<CH_DOUBLE, &TK::oil, &TelemetryTruckOil::pressure>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_oil_pressure),
+    Truck<CH_DOUBLE, &TK::oil, &TelemetryTruckOil::temperature>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_oil_temperature),
+    Truck<CH_BOOL, &TK::oil, &TelemetryTruckOil::pressureWarning>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_oil_pressure_warning),
+    Truck<CH_DOUBLE, &TK::waterTemperature>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_water_temperature),
+    Truck<CH_BOOL, &TK::waterTemperatureWarning>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_water_temperature_warning),
+    Truck<CH_DOUBLE, &TK::batteryVoltage>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_battery_voltage),
+    Truck<CH_BOOL, &TK::batteryVoltageWarning>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_battery_voltage_warning),
+    Truck<CH_BOOL, &TK::electricEnabled>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_electric_enabled),
+    Truck<CH_BOOL, &TK::leftBlinker>(SCS_TELEMETRY_TRUCK_CHANNEL_lblinker),
+    Truck<CH_BOOL, &TK::rightBlinker>(SCS_TELEMETRY_TRUCK_CHANNEL_rblinker),
+    Truck<CH_BOOL, &TK::hazardWarning>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_hazard_warning),
+    Truck<CH_BOOL, &TK::light, &TelemetryTruckLight::leftBlinker>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_lblinker),
+    Truck<CH_BOOL, &TK::light, &TelemetryTruckLight::rightBlinker>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_rblinker),
+    Truck<CH_BOOL, &TK::light, &TelemetryTruckLight::parking>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_parking),
+    Truck<CH_BOOL, &TK::light, &TelemetryTruckLight::lowBeam>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_low_beam),
+    Truck<CH_BOOL, &TK::light, &TelemetryTruckLight::highBeam>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_high_beam),
+    Truck<CH_U32, &TK::light, &TelemetryTruckLight::auxFront>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_aux_front),
+    Truck<CH_U32, &TK::light, &TelemetryTruckLight::auxRoof>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_aux_roof),
+    Truck<CH_BOOL, &TK::light, &TelemetryTruckLight::beacon>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_beacon),
+    Truck<CH_BOOL, &TK::light, &TelemetryTruckLight::brake>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_brake),
+    Truck<CH_BOOL, &TK::light, &TelemetryTruckLight::reverse>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_light_reverse),
+    Truck<CH_BOOL, &TK::wipers>(SCS_TELEMETRY_TRUCK_CHANNEL_wipers),
+    Truck<CH_DOUBLE, &TK::dashboardBacklight>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_dashboard_backlight),
+    Truck<CH_BOOL, &TK::differentialLock>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_differential_lock),
+    Truck<CH_BOOL, &TK::liftAxle>(SCS_TELEMETRY_TRUCK_CHANNEL_lift_axle),
+    Truck<CH_BOOL, &TK::liftAxleIndicator>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_lift_axle_indicator),
+    Truck<CH_BOOL, &TK::trailerLiftAxle>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_trailer_lift_axle),
+    Truck<CH_BOOL, &TK::trailerLiftAxleIndicator>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_trailer_lift_axle_indicator),
+    Truck<CH_DOUBLE, &TK::wear, &TelemetryTruckWear::cabin>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wear_cabin),
+    Truck<CH_DOUBLE, &TK::wear, &TelemetryTruckWear::chassis>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wear_chassis),
+    Truck<CH_DOUBLE, &TK::wear, &TelemetryTruckWear::engine>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wear_engine),
+    Truck<CH_DOUBLE, &TK::wear, &TelemetryTruckWear::transmission>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wear_transmission),
+    Truck<CH_DOUBLE, &TK::wear, &TelemetryTruckWear::wheels>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wear_wheels),
+    Truck<CH_DOUBLE, &TK::odometer>(SCS_TELEMETRY_TRUCK_CHANNEL_odometer),
+    Truck<CH_DOUBLE, &TK::navigation, &TelemetryTruckNavigation::distance>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_navigation_distance),
+    Truck<CH_DOUBLE, &TK::navigation, &TelemetryTruckNavigation::speed_limit>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_navigation_speed_limit),
+    Truck<CH_DOUBLE, &TK::navigation, &TelemetryTruckNavigation::time>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_navigation_time),
+
+    /* Indexed truck channels */
+    TruckWheel<CH_DOUBLE, &WH::suspensionDeflection>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wheel_susp_deflection),
+    TruckWheel<CH_DOUBLE, &WH::rotation>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wheel_rotation),
+    TruckWheel<CH_DOUBLE, &WH::velocity>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wheel_velocity),
+    TruckWheel<CH_DOUBLE, &WH::steering>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wheel_steering),
+    TruckWheel<CH_DOUBLE, &WH::lift>(SCS_TELEMETRY_TRUCK_CHANNEL_wheel_lift),
+    TruckWheel<CH_DOUBLE, &WH::liftOffset>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wheel_lift_offset),
+    TruckWheel<CH_BOOL, &WH::isOnGround>(
+        SCS_TELEMETRY_TRUCK_CHANNEL_wheel_on_ground),
+
+    /* Trailer channels */
+    Required(Trailer<CH_BOOL, &TL::connected>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_connected)),
+    Trailer<CH_DOUBLE, &TL::cargoDamage>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_cargo_damage),
+    Trailer<CH_PLACEMENT, &TL::worldPlacement>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_world_placement),
+    Trailer<CH_VECTOR, &TL::localLinearVelocity>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_local_linear_velocity),
+    Trailer<CH_VECTOR, &TL::localLinearAcceleration>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_local_linear_acceleration),
+    Trailer<CH_VECTOR, &TL::localAngularAcceleration>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_local_angular_acceleration),
+    Trailer<CH_DOUBLE, &TL::wear, &TelemetryTrailerWear::body>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wear_body),
+    Trailer<CH_DOUBLE, &TL::wear, &TelemetryTrailerWear::chassis>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wear_chassis),
+    Trailer<CH_DOUBLE, &TL::wear, &TelemetryTrailerWear::wheels>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wear_wheels),
+
+    /* Indexed(what?!) trailer channels */
+    TrailerWheel<CH_DOUBLE, &WH::suspensionDeflection>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wheel_susp_deflection),
+    TrailerWheel<CH_DOUBLE, &WH::rotation>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wheel_rotation),
+    TrailerWheel<CH_DOUBLE, &WH::velocity>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wheel_velocity),
+    TrailerWheel<CH_DOUBLE, &WH::steering>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wheel_steering),
+    TrailerWheel<CH_DOUBLE, &WH::lift>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wheel_lift),
+    TrailerWheel<CH_DOUBLE, &WH::liftOffset>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wheel_lift_offset),
+    TrailerWheel<CH_BOOL, &WH::isOnGround>(
+        SCS_TELEMETRY_TRAILER_CHANNEL_wheel_on_ground),
+
+    /* Job channels, the game only provides the damage as a float */
+    Global<CH_FLOAT, &TelemetryFrame::job, &TelemetryJob::cargoDamage>(
+        SCS_TELEMETRY_JOB_CHANNEL_cargo_damage),
+};
+
+#undef CH_BOOL
+#undef CH_U32
+#undef CH_S32
+#undef CH_FLOAT
+#undef CH_DOUBLE
+#undef CH_VECTOR
+#undef CH_PLACEMENT
+
+constexpr size_t CountScope(ChannelScope scope) {
+  size_t count = 0;
+  for (const ChannelEntry &entry : Table) {
+    count += entry.scope == scope ? 1 : 0;
+  }
+  return count;
+}
+
+constexpr bool IsTrailerScope(ChannelScope scope) {
+  return scope == ChannelScope::Trailer || scope == ChannelScope::TrailerWheel;
+}
+
+/* Position of a table entry among the trailer scoped entries */
+constexpr size_t TrailerSlot(size_t entry) {
+  size_t slot = 0;
+  for (size_t i = 0; i < entry; ++i) {
+    slot += IsTrailerScope(Table[i].scope) ? 1 : 0;
+  }
+  return slot;
+}
+
+/* Longest trailer channel name with the index spliced in, plus the NUL */
+constexpr size_t TRAILER_CHANNEL_NAME_SIZE = 64;
+
+/*
+ * Builds "trailer.<index>.<rest>" from a "trailer.<rest>" channel name.
+ * The buffer must outlive the registration.
+ */
+inline void TrailerChannelName(char *buffer, scs_string_t name,
+                               scs_u32_t trailer) {
+  snprintf(buffer, TRAILER_CHANNEL_NAME_SIZE, "trailer.%u%s",
+           static_cast<unsigned>(trailer), name + 7);
+}
+
+} // namespace TelemetryChannels
+
+#endif
@@ -21,115 +21,133 @@ If not, see <https://www.gnu.org/licenses/>.
 #ifndef TELEMETRY_JSON_H
 #define TELEMETRY_JSON_H
 #include "telemetry.h"
+#include "telemetry_schema.h"
 #include <nlohmann/json.hpp>
 
+/*
+ * Trucks and trailers only serialize the wheels they have and frames the
+ * trailers up to the last one in use, instead of the whole fixed arrays.
+ * Clients that rely on the fixed shape can ask for it, see frame_dialect.h.
+ */
+template <typename T>
+inline void telemetry_to_json(nlohmann::json &j, const T &value, size_t) {
+  j = value;
+}
+
+template <typename T, size_t N>
+inline void telemetry_to_json(nlohmann::json &j, const T (&values)[N],
+                              size_t count) {
+  j = nlohmann::json::array();
+  for (size_t i = 0; i < count && i < N; i++) {
+    j.push_back(values[i]);
+  }
+}
+
+#define TELEMETRY_JSON_TO(field)                                               \
+  telemetry_to_json(nlohmann_json_j[#field], nlohmann_json_t.field,            \
+                    telemetry_count);
+/* Like NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE, arrays stop after count */
+#define TELEMETRY_DEFINE_TO_JSON(Type, count, ...)                             \
+  inline void to_json(nlohmann::json &nlohmann_json_j,                         \
+                      const Type &nlohmann_json_t) {                           \
+    const size_t telemetry_count = count;                                      \
+    NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(TELEMETRY_JSON_TO, __VA_ARGS__))  \
+  }
+
+/* Trailers past the last connected or configured one are left out */
+inline size_t trailers_in_use(const TelemetryFrame &frame) {
+  size_t count = MAX_TRAILERS;
+  while (count > 0 && !frame.trailer[count - 1].connected &&
+         frame.trailer[count - 1].config.id.empty()) {
+    count--;
+  }
+  return count;
+}
+
 /* Common types */
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryVec3D, x, y, z)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryOrientation, heading, pitch, roll)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryPlacement, position, orientation)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryVec3D, TELEMETRY_VEC3D_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryOrientation,
+                                   TELEMETRY_ORIENTATION_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryPlacement,
+                                   TELEMETRY_PLACEMENT_FIELDS)
 
 /* Wheels */
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryWheelConfig, isLiftable, position,
-                                   isPowered, radius, isSimulated, isSteerable)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryWheel, lift, liftOffset, isOnGround,
-                                   rotation, steering, substance,
-                                   suspensionDeflection, velocity, config)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryWheelConfig,
+                                   TELEMETRY_WHEEL_CONFIG_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryWheel, TELEMETRY_WHEEL_FIELDS)
 
 /* Truck */
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckCabin, offset,
-                                   angularAcceleration, angularVelocity)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckInput, brake, throttle, clutch,
-                                   steering)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckBrake, retarder, parking,
-                                   motor, airPressure, airPressureWarning,
-                                   airPressureEmergency, temperature)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckFuel, amount, range,
-                                   averageConsumption, warning)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckEngine, rpm, gear, enabled)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckOil, pressure, temperature,
-                                   pressureWarning)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckAdblue, amount,
-                                   averageConsumption, warning)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckLight, leftBlinker,
-                                   rightBlinker, parking, lowBeam, highBeam,
-                                   auxFront, auxRoof, beacon, brake, reverse)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckWear, engine, transmission,
-                                   cabin, chassis, wheels)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckNavigation, distance, time,
-                                   speed_limit)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(
-    TelemetryTruckConfig, brand, brandId, id, name, fuelCapacity,
-    fuelWarningFactor, adblueCapacity, adblueWarningFactor, airPressureWarning,
-    airPressureEmergency, oilPressureWarning, waterTemperatureWarning,
-    batteryVoltageWarning, rpmLimit, forwardGearCount, reverseGearCount,
-    forwardGearRatios, reverseGearRatios, differentialRation, retarderStepCount,
-    cabinPosition, hookPosition, headPosition, licensePlate,
-    licensePlateCountry, licensePlateCountryId, wheelCount, shifterType)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(
-    TelemetryTruck, config, worldPlacement, localLinearVelocity,
-    localLinearAcceleration, localAngularVelocity, localAngularAcceleration,
-    cabin, headOffset, speed, engine, displayedGear, input, effective,
-    cruiseControl, brake, fuel, adblue, oil, waterTemperature,
-    waterTemperatureWarning, batteryVoltage, batteryVoltageWarning,
-    electricEnabled, leftBlinker, rightBlinker, hazardWarning, differentialLock,
-    light, wipers, dashboardBacklight, liftAxle, liftAxleIndicator,
-    trailerLiftAxle, trailerLiftAxleIndicator, wheels, wear, odometer,
-    navigation)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckCabin,
+                                   TELEMETRY_TRUCK_CABIN_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckInput,
+                                   TELEMETRY_TRUCK_INPUT_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckBrake,
+                                   TELEMETRY_TRUCK_BRAKE_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckFuel,
+                                   TELEMETRY_TRUCK_FUEL_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckEngine,
+                                   TELEMETRY_TRUCK_ENGINE_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckOil,
+                                   TELEMETRY_TRUCK_OIL_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckAdblue,
+                                   TELEMETRY_TRUCK_ADBLUE_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckLight,
+                                   TELEMETRY_TRUCK_LIGHT_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckWear,
+                                   TELEMETRY_TRUCK_WEAR_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckNavigation,
+                                   TELEMETRY_TRUCK_NAVIGATION_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTruckConfig,
+                                   TELEMETRY_TRUCK_CONFIG_FIELDS)
+TELEMETRY_DEFINE_TO_JSON(TelemetryTruck, nlohmann_json_t.config.wheelCount,
+                         TELEMETRY_TRUCK_FIELDS)
 
 /* Trailer */
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTrailerConfig, id, cargoAccessoryId,
-                                   hookPosition, brandId, brand, name,
-                                   licensePlate, licensePlateCountry,
-                                   licensePlateCountryId, chainType, bodyType,
-                                   wheelCount)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTrailerWear, body, chassis, wheels)
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTrailer, config, worldPlacement,
-                                   localLinearVelocity, localLinearAcceleration,
-                                   localAngularVelocity,
-                                   localAngularAcceleration, wear, connected,
-                                   cargoDamage, wheels)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTrailerConfig,
+                                   TELEMETRY_TRAILER_CONFIG_FIELDS)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryTrailerWear,
+                                   TELEMETRY_TRAILER_WEAR_FIELDS)
+TELEMETRY_DEFINE_TO_JSON(TelemetryTrailer, nlohmann_json_t.config.wheelCount,
+                         TELEMETRY_TRAILER_FIELDS)
 
 /* Job */
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryJob, cargo, cargoId, cargoUnitCount,
-                                   cargoMass, cargoUnitMass, deliveryTime,
-                                   plannedDistance, income, destinationCity,
-                                   destinationCityId, sourceCity, sourceCityId,
-                                   destinationCompany, destinationCompanyId,
-                                   sourceCompany, sourceCompanyId, jobMarket,
-                                   isCargoLoaded, isSpecialJob, cargoDamage)
-
-/* Frame and gameplay events */
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryFrame, gameTime, localScale,
-                                   multiplayerTimeOffset, restStop, paused,
-                                   truck, trailer, job)
-
-/* Gameplay events are ugly */
-void to_json(nlohmann::json &j, const TelemetryGameplayEvent &gameplayEvent) {
-  j = nlohmann::json();
-  j["eventType"] = gameplayEvent.eventType;
-  nlohmann::json attributes = nlohmann::json();
-  for (auto const &[name, value] : gameplayEvent.attributes) {
-    if (std::holds_alternative<std::string>(value)) {
-      attributes[name] = std::get<std::string>(value);
-    } else if (std::holds_alternative<scs_float_t>(value)) {
-      attributes[name] = std::get<scs_float_t>(value);
-    } else if (std::holds_alternative<scs_double_t>(value)) {
-      attributes[name] = std::get<scs_double_t>(value);
-    } else if (std::holds_alternative<scs_s32_t>(value)) {
-      attributes[name] = std::get<scs_s32_t>(value);
-    } else if (std::holds_alternative<scs_s64_t>(value)) {
-      attributes[name] = std::get<scs_s64_t>(value);
-    } else if (std::holds_alternative<scs_u32_t>(value)) {
-      attributes[name] = std::get<scs_u32_t>(value);
-    } else if (std::holds_alternative<scs_u64_t>(value)) {
-      attributes[name] = std::get<scs_u64_t>(value);
-    } else if (std::holds_alternative<bool>(value)) {
-      attributes[name] = std::get<bool>(value);
-    } else {
-      attributes[name] = 0;
-    }
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelemetryJob, TELEMETRY_JOB_FIELDS)
+
+/*
+ * The payloads of config messages. Trucks and trailers send their config
+ * along with the config of each wheel.
+ */
+template <typename Vehicle>
+inline void vehicle_config_to_json(nlohmann::json &j, const Vehicle &vehicle) {
+  j["config"] = vehicle.config;
+  j["wheels"] = nlohmann::json::array();
+  for (size_t i = 0; i < vehicle.config.wheelCount && i < MAX_WHEEL_COUNT;
+       i++) {
+    j["wheels"].push_back(vehicle.wheels[i].config);
   }
-  j["attributes"] = attributes;
 }
 
+inline void config_to_json(nlohmann::json &j, const TelemetryTruck &truck) {
+  vehicle_config_to_json(j, truck);
+}
+
+inline void config_to_json(nlohmann::json &j, const TelemetryTrailer &trailer) {
+  vehicle_config_to_json(j, trailer);
+}
+
+/* All of the job but the cargo damage, which is a channel */
+inline void job_config_to_json(nlohmann::json &nlohmann_json_j,
+                               const TelemetryJob &nlohmann_json_t) {
+  NLOHMANN_JSON_EXPAND(
+      NLOHMANN_JSON_PASTE(NLOHMANN_JSON_TO, TELEMETRY_JOB_CONFIG_FIELDS))
+}
+
+inline void config_to_json(nlohmann::json &j, const TelemetryJob &job) {
+  job_config_to_json(j["config"], job);
+}
+
+/* Frame */
+TELEMETRY_DEFINE_TO_JSON(TelemetryFrame, trailers_in_use(nlohmann_json_t),
+                         TELEMETRY_FRAME_FIELDS)
+
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+#ifndef TELEMETRY_SCHEMA_H
+#define TELEMETRY_SCHEMA_H
+
+/*
+ * The serialized fields of each telemetry type, in schema order. Frames
+ * are serialized from these lists in telemetry_json.h and the positional
+ * dialect of frame_dialect.h lays its arrays out in the same order.
+ *
+ * Configuration doesn't change from frame to frame, it's sent in config
+ * messages instead: the *_CONFIG_FIELDS types and the job except for its
+ * cargo damage.
+ */
+
+/* Common types */
+#define TELEMETRY_VEC3D_FIELDS x, y, z
+#define TELEMETRY_ORIENTATION_FIELDS heading, pitch, roll
+#define TELEMETRY_PLACEMENT_FIELDS position, orientation
+
+/* Wheels */
+#define TELEMETRY_WHEEL_CONFIG_FIELDS                                          \
+  isLiftable, position, isPowered, radius, isSimulated, isSteerable
+#define TELEMETRY_WHEEL_FIELDS                                                 \
+  lift, liftOffset, isOnGround, rotation, steering, substance,                 \
+      suspensionDeflection, velocity
+
+/* Truck */
+#define TELEMETRY_TRUCK_CABIN_FIELDS                                           \
+  offset, angularAcceleration, angularVelocity
+#define TELEMETRY_TRUCK_INPUT_FIELDS brake, throttle, clutch, steering
+#define TELEMETRY_TRUCK_BRAKE_FIELDS                                           \
+  retarder, parking, motor, airPressure, airPressureWarning,                   \
+      airPressureEmergency, temperature
+#define TELEMETRY_TRUCK_FUEL_FIELDS amount, range, averageConsumption, warning
+#define TELEMETRY_TRUCK_ENGINE_FIELDS rpm, gear, enabled
+#define TELEMETRY_TRUCK_OIL_FIELDS pressure, temperature, pressureWarning
+#define TELEMETRY_TRUCK_ADBLUE_FIELDS amount, averageConsumption, warning
+#define TELEMETRY_TRUCK_LIGHT_FIELDS                                           \
+  leftBlinker, rightBlinker, parking, lowBeam, highBeam, auxFront, auxRoof,    \
+      beacon, brake, reverse
+#define TELEMETRY_TRUCK_WEAR_FIELDS                                            \
+  engine, transmission, cabin, chassis, wheels
+#define TELEMETRY_TRUCK_NAVIGATION_FIELDS distance, time, speed_limit
+#define TELEMETRY_TRUCK_CONFIG_FIELDS                                          \
+  brand, brandId, id, name, fuelCapacity, fuelWarningFactor, adblueCapacity,   \
+      adblueWarningFactor, airPressureWarning, airPressureEmergency,           \
+      oilPressureWarning, waterTemperatureWarning, batteryVoltageWarning,      \
+      rpmLimit, forwardGearCount, reverseGearCount, forwardGearRatios,         \
+      reverseGearRatios, differentialRation, retarderStepCount,                \
+      cabinPosition, hookPosition, headPosition, licensePlate,                 \
+      licensePlateCountry, licensePlateCountryId, wheelCount, shifterType
+#define TELEMETRY_TRUCK_FIELDS                                                 \
+  worldPlacement, localLinearVelocity, localLinearAcceleration,                \
+      localAngularVelocity, localAngularAcceleration, cabin, headOffset,       \
+      speed, engine, displayedGear, input, effective, cruiseControl, brake,    \
+      fuel, adblue, oil, waterTemperature, waterTemperatureWarning,            \
+      batteryVoltage, batteryVoltageWarning, electricEnabled, leftBlinker,     \
+      rightBlinker, hazardWarning, differentialLock, light, wipers,            \
+      dashboardBacklight, liftAxle, liftAxleIndicator, trailerLiftAxle,        \
+      trailerLiftAxleIndicator, wheels, wear, odometer, navigation
+
+/* Trailer */
+#define TELEMETRY_TRAILER_CONFIG_FIELDS                                        \
+  id, cargoAccessoryId, hookPosition, brandId, brand, name, licensePlate,      \
+      licensePlateCountry, licensePlateCountryId, chainType, bodyType,         \
+      wheelCount
+#define TELEMETRY_TRAILER_WEAR_FIELDS body, chassis, wheels
+#define TELEMETRY_TRAILER_FIELDS                                               \
+  worldPlacement, localLinearVelocity, localLinearAcceleration,                \
+      localAngularVelocity, localAngularAcceleration, wear, connected,         \
+      cargoDamage, wheels
+
+/* Job */
+#define TELEMETRY_JOB_CONFIG_FIELDS                                            \
+  cargo, cargoId, cargoUnitCount, cargoMass, cargoUnitMass, deliveryTime,      \
+      plannedDistance, income, destinationCity, destinationCityId,             \
+      sourceCity, sourceCityId, destinationCompany, destinationCompanyId,      \
+      sourceCompany, sourceCompanyId, jobMarket, isCargoLoaded, isSpecialJob
+#define TELEMETRY_JOB_FIELDS cargoDamage
+
+/* Frames */
+#define TELEMETRY_FRAME_FIELDS                                                 \
+  gameTime, localScale, multiplayerTimeOffset, restStop, paused, idle, truck,  \
+      trailer, job, configVersion
+
+#endif
@@ -45,8 +45,8 @@ struct TelemetryTrailerWear{
         scs_double_t wheels = scs_double_t(0.0); 
 };
 
-struct TelemetryTrailer{
-        TelemetryTrailerConfig config = {};
+/* Channel data only, trivially copyable */
+struct TelemetryTrailerState{
         TelemetryPlacement worldPlacement = {};
         TelemetryVec3D localLinearVelocity = {};
         TelemetryVec3D localAngularVelocity = {};
@@ -58,4 +58,8 @@ struct TelemetryTrailer{
         TelemetryWheel wheels[MAX_WHEEL_COUNT];
         
 };
+
+struct TelemetryTrailer : TelemetryTrailerState{
+        TelemetryTrailerConfig config = {};
+};
 #endif
@@ -131,8 +131,8 @@ struct TelemetryTruckConfig {
   scs_double_t differentialRation = scs_double_t(0.0);
 };
 
-struct TelemetryTruck {
-  TelemetryTruckConfig config = {};
+/* Channel data only, trivially copyable */
+struct TelemetryTruckState {
   TelemetryPlacement worldPlacement = {};
   TelemetryVec3D localLinearVelocity = {};
   TelemetryVec3D localAngularVelocity = {};
@@ -171,4 +171,8 @@ struct TelemetryTruck {
   scs_double_t odometer = scs_double_t(0.0);
   TelemetryTruckNavigation navigation = {};
 };
+
+struct TelemetryTruck : TelemetryTruckState {
+  TelemetryTruckConfig config = {};
+};
 #endif
@@ -0,0 +1,215 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef UDP_FRAME_H
+#define UDP_FRAME_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Wire format of the UDP publisher. Every datagram starts with a
+ * UdpFragmentHeader in network byte order, followed by up to
+ * UDP_FRAGMENT_PAYLOAD bytes of the message at offset
+ * fragmentIndex * UDP_FRAGMENT_PAYLOAD. Messages carry no NUL terminator.
+ *
+ * Frames and events are numbered separately. Frames only matter until the
+ * next one is complete, receivers drop fragments of older frames. Gameplay
+ * events may be sent more than once with the same sequence, receivers keep
+ * the first complete copy, see UdpReassembler.
+ */
+
+#define UDP_MAGIC 0x54535455u /* "TSTU" */
+#define UDP_HEADER_SIZE 20
+/* Ethernet MTU minus the IPv4 and UDP headers */
+#define UDP_MAX_DATAGRAM 1472
+#define UDP_FRAGMENT_PAYLOAD (UDP_MAX_DATAGRAM - UDP_HEADER_SIZE)
+
+enum class UdpStream : uint8_t { Frame = 0, Event = 1 };
+
+struct UdpFragmentHeader {
+  uint32_t magic;
+  uint32_t sequence;
+  uint32_t messageSize;
+  uint16_t fragmentIndex;
+  uint16_t fragmentCount;
+  UdpStream stream;
+};
+
+namespace UdpWire {
+inline void Put16(unsigned char *out, uint16_t value) {
+  out[0] = static_cast<unsigned char>(value >> 8);
+  out[1] = static_cast<unsigned char>(value);
+}
+
+inline void Put32(unsigned char *out, uint32_t value) {
+  Put16(out, static_cast<uint16_t>(value >> 16));
+  Put16(out + 2, static_cast<uint16_t>(value));
+}
+
+inline uint16_t Get16(const unsigned char *in) {
+  return static_cast<uint16_t>(in[0] << 8 | in[1]);
+}
+
+inline uint32_t Get32(const unsigned char *in) {
+  return static_cast<uint32_t>(Get16(in)) << 16 | Get16(in + 2);
+}
+
+inline void WriteHeader(const UdpFragmentHeader &header, unsigned char *out) {
+  Put32(out, header.magic);
+  Put32(out + 4, header.sequence);
+  Put32(out + 8, header.messageSize);
+  Put16(out + 12, header.fragmentIndex);
+  Put16(out + 14, header.fragmentCount);
+  out[16] = static_cast<unsigned char>(header.stream);
+  out[17] = out[18] = out[19] = 0;
+}
+
+/* Returns false for datagrams that aren't ours or are inconsistent */
+inline bool ReadHeader(const unsigned char *in, size_t size,
+                       UdpFragmentHeader *header) {
+  if (size < UDP_HEADER_SIZE || Get32(in) != UDP_MAGIC || in[16] > 1) {
+    return false;
+  }
+  header->magic = UDP_MAGIC;
+  header->sequence = Get32(in + 4);
+  header->messageSize = Get32(in + 8);
+  header->fragmentIndex = Get16(in + 12);
+  header->fragmentCount = Get16(in + 14);
+  header->stream = static_cast<UdpStream>(in[16]);
+  const size_t offset =
+      static_cast<size_t>(header->fragmentIndex) * UDP_FRAGMENT_PAYLOAD;
+  const size_t expected =
+      header->messageSize > offset
+          ? std::min<size_t>(header->messageSize - offset, UDP_FRAGMENT_PAYLOAD)
+          : 0;
+  return header->fragmentIndex < header->fragmentCount &&
+         header->fragmentCount ==
+             (header->messageSize + UDP_FRAGMENT_PAYLOAD - 1) /
+                 UDP_FRAGMENT_PAYLOAD &&
+         size - UDP_HEADER_SIZE == expected;
+}
+
+/* True if sequence a comes after b, tolerating wrap-around */
+inline bool After(uint32_t a, uint32_t b) {
+  return static_cast<int32_t>(a - b) > 0;
+}
+} // namespace UdpWire
+
+/*
+ * Reassembles messages from datagrams in arrival order. Incomplete frames
+ * are abandoned as soon as a fragment of a newer frame arrives.
+ */
+class UdpReassembler {
+public:
+  /* Returns true and fills message and stream once a message completes */
+  bool Push(const void *datagram, size_t size, std::string *message,
+            UdpStream *stream) {
+    const auto *in = static_cast<const unsigned char *>(datagram);
+    UdpFragmentHeader header;
+    if (!UdpWire::ReadHeader(in, size, &header)) {
+      return false;
+    }
+    const bool frame = header.stream == UdpStream::Frame;
+    if (frame ? m_haveFrame && !UdpWire::After(header.sequence, m_lastFrame)
+              : eventSeen(header.sequence)) {
+      return false;
+    }
+    Pending &pending = frame ? m_frame : m_event;
+    if (!pending.active || pending.sequence != header.sequence) {
+      /* A lost fragment of an older event only costs that event */
+      if (pending.active && !frame &&
+          UdpWire::After(pending.sequence, header.sequence)) {
+        return false;
+      }
+      pending.active = true;
+      pending.sequence = header.sequence;
+      pending.remaining = header.fragmentCount;
+      pending.received.assign(header.fragmentCount, false);
+      pending.data.resize(header.messageSize);
+    }
+    if (pending.received[header.fragmentIndex]) {
+      return false;
+    }
+    pending.received[header.fragmentIndex] = true;
+    pending.data.replace(
+        static_cast<size_t>(header.fragmentIndex) * UDP_FRAGMENT_PAYLOAD,
+        size - UDP_HEADER_SIZE,
+        reinterpret_cast<const char *>(in) + UDP_HEADER_SIZE,
+        size - UDP_HEADER_SIZE);
+    if (--pending.remaining > 0) {
+      return false;
+    }
+    pending.active = false;
+    if (frame) {
+      m_haveFrame = true;
+      m_lastFrame = header.sequence;
+    } else {
+      markEvent(header.sequence);
+    }
+    message->swap(pending.data);
+    *stream = header.stream;
+    return true;
+  }
+
+private:
+  struct Pending {
+    bool active = false;
+    uint32_t sequence = 0;
+    uint32_t remaining = 0;
+    std::vector<bool> received;
+    std::string data;
+  };
+  Pending m_frame;
+  Pending m_event;
+  bool m_haveFrame = false;
+  uint32_t m_lastFrame = 0;
+  /* Events seen within 64 sequences of the newest one */
+  bool m_haveEvent = false;
+  uint32_t m_lastEvent = 0;
+  uint64_t m_eventWindow = 0;
+
+  bool eventSeen(uint32_t sequence) const {
+    if (!m_haveEvent || UdpWire::After(sequence, m_lastEvent)) {
+      return false;
+    }
+    const uint32_t age = m_lastEvent - sequence;
+    return age >= 64 || (m_eventWindow >> age & 1u);
+  }
+
+  void markEvent(uint32_t sequence) {
+    if (!m_haveEvent) {
+      m_haveEvent = true;
+      m_lastEvent = sequence;
+      m_eventWindow = 1;
+    } else if (UdpWire::After(sequence, m_lastEvent)) {
+      const uint32_t shift = sequence - m_lastEvent;
+      m_eventWindow = shift >= 64 ? 1 : m_eventWindow << shift | 1;
+      m_lastEvent = sequence;
+    } else {
+      m_eventWindow |= uint64_t(1) << (m_lastEvent - sequence);
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,68 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef UDP_PUBLISHER_H
+#define UDP_PUBLISHER_H
+
+#include "network_handler.h"
+#include "udp_frame.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Hops a multicast datagram may take, one keeps it on the local network */
+#define UDP_MULTICAST_TTL 1
+
+/*
+ * Sends every event once to a multicast group or broadcast address, so the
+ * cost doesn't grow with the number of viewers. See udp_frame.h for the
+ * wire format. Lives on the network thread.
+ */
+class UdpPublisher {
+public:
+  /*
+   * target is "address:port", redundancy the number of extra copies of
+   * each gameplay event. Throws std::runtime_error on bad targets.
+   */
+  UdpPublisher(const std::string &target, int redundancy);
+  ~UdpPublisher();
+  UdpPublisher(const UdpPublisher &) = delete;
+  UdpPublisher &operator=(const UdpPublisher &) = delete;
+  void Publish(const std::string &event, bool frame);
+
+private:
+  struct Repeat {
+    std::string event;
+    uint32_t sequence;
+    int remaining;
+  };
+  SOCKET m_socket = INVALID_SOCKET;
+  struct sockaddr_in m_target;
+  int m_redundancy;
+  uint32_t m_frameSequence = 0;
+  uint32_t m_eventSequence = 0;
+  /* Copies are spread over the following frames to survive burst loss */
+  std::vector<Repeat> m_repeats;
+  unsigned char m_datagram[UDP_MAX_DATAGRAM];
+  void send(const std::string &event, UdpStream stream, uint32_t sequence);
+};
+
+#endif
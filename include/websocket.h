@@ -0,0 +1,100 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include "http_request.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/* RFC 6455 opcodes */
+#define WEBSOCKET_TEXT 0x1
+#define WEBSOCKET_BINARY 0x2
+#define WEBSOCKET_CLOSE 0x8
+#define WEBSOCKET_PING 0x9
+#define WEBSOCKET_PONG 0xA
+/* Clients only send control frames, anything bigger is refused */
+#define WEBSOCKET_MAX_CLIENT_FRAME 65536
+/* Cheap, the window shared across frames does most of the work */
+#define WEBSOCKET_DEFLATE_LEVEL 1
+
+struct WebSocketFrame {
+  bool fin;
+  bool compressed;
+  uint8_t opcode;
+  std::string payload;
+};
+
+/* permessage-deflate as agreed on in the handshake, RFC 7692 */
+struct DeflateParameters {
+  bool enabled = false;
+  /* Reset the window after each message instead of sharing it */
+  bool noContextTakeover = false;
+  int windowBits = 15;
+};
+
+namespace WebSocket {
+/* True for a valid upgrade request, see RFC 6455 section 4.2.1 */
+bool IsUpgrade(const HttpRequest &request);
+/*
+ * The 101 response to an upgrade request. permessage-deflate is accepted
+ * if the client offers it and the plugin was built with zlib.
+ */
+std::string Handshake(const HttpRequest &request, DeflateParameters *deflate);
+/* Appends the header of an unmasked server frame */
+void AppendHeader(std::string *out, uint8_t opcode, size_t payloadSize,
+                  bool compressed);
+/*
+ * Parses and unmasks the client frame at the front of buffer. Returns the
+ * bytes consumed, 0 if the frame is incomplete and SIZE_MAX if it's invalid.
+ */
+size_t ParseClientFrame(std::string_view buffer, WebSocketFrame *frame);
+} // namespace WebSocket
+
+struct z_stream_s;
+
+/*
+ * permessage-deflate of one connection, RFC 7692 section 7.2. Browsers
+ * compress what they send as well once the extension is on.
+ */
+class MessageDeflater {
+public:
+  explicit MessageDeflater(const DeflateParameters &parameters);
+  ~MessageDeflater();
+  MessageDeflater(const MessageDeflater &) = delete;
+  MessageDeflater &operator=(const MessageDeflater &) = delete;
+  /* Replaces out with the compressed message, false on zlib errors */
+  bool Compress(std::string_view message, std::string *out);
+  /* Replaces out with a message of the client, false if it's corrupt */
+  bool Decompress(std::string_view message, std::string *out);
+  /* Messages can only be decoded in order if the window is shared */
+  bool KeepsContext() const { return !m_noContextTakeover; }
+
+private:
+  z_stream_s *m_stream = nullptr;
+  z_stream_s *m_inflate = nullptr;
+  bool m_noContextTakeover;
+};
+
+#endif
@@ -0,0 +1,192 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "allocation_stats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+const char *AllocationStats::StageName(AllocationStage stage) {
+  switch (stage) {
+  case AllocationStage::Store:
+    return "store";
+  case AllocationStage::Snapshot:
+    return "snapshot";
+  case AllocationStage::Encode:
+    return "encode";
+  case AllocationStage::Queue:
+    return "queue";
+  case AllocationStage::Send:
+    return "send";
+  default:
+    return "other";
+  }
+}
+
+#ifdef TSTS_ALLOCATION_STATS
+
+namespace {
+
+#define NO_STAGE -1
+
+/* Written by its thread only, unless threads have to share the last one */
+struct ThreadSlot {
+  std::atomic<const char *> name{nullptr};
+  std::atomic<uint64_t> allocations[ALLOCATION_STAGE_COUNT] = {};
+  std::atomic<uint64_t> bytes[ALLOCATION_STAGE_COUNT] = {};
+  std::atomic<uint64_t> frees[ALLOCATION_STAGE_COUNT] = {};
+};
+
+/* Constant initialized, operator new may run before any constructor */
+ThreadSlot slots[ALLOCATION_MAX_THREADS];
+std::atomic<size_t> slotsUsed{0};
+thread_local ThreadSlot *threadSlot = nullptr;
+thread_local int threadStage = NO_STAGE;
+
+ThreadSlot *slot_of_thread() {
+  if (threadSlot == nullptr) {
+    const size_t index = slotsUsed.fetch_add(1, std::memory_order_relaxed);
+    threadSlot = &slots[index < ALLOCATION_MAX_THREADS
+                            ? index
+                            : ALLOCATION_MAX_THREADS - 1];
+  }
+  return threadSlot;
+}
+
+void count_allocation(size_t size) {
+  const int stage = threadStage;
+  if (stage != NO_STAGE) {
+    ThreadSlot *slot = slot_of_thread();
+    slot->allocations[stage].fetch_add(1, std::memory_order_relaxed);
+    slot->bytes[stage].fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+void count_free(void *pointer) {
+  const int stage = threadStage;
+  if (pointer != nullptr && stage != NO_STAGE) {
+    slot_of_thread()->frees[stage].fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+} // namespace
+
+void AllocationStats::NameThread(const char *name) {
+  slot_of_thread()->name.store(name, std::memory_order_relaxed);
+}
+
+size_t AllocationStats::Collect(AllocationThreadStats *threads) {
+  size_t count = slotsUsed.load(std::memory_order_relaxed);
+  if (count > ALLOCATION_MAX_THREADS) {
+    count = ALLOCATION_MAX_THREADS;
+  }
+  for (size_t i = 0; i < count; i++) {
+    threads[i].name = slots[i].name.load(std::memory_order_relaxed);
+    for (size_t stage = 0; stage < ALLOCATION_STAGE_COUNT; stage++) {
+      AllocationCounter &counter = threads[i].stages[stage];
+      counter.allocations =
+          slots[i].allocations[stage].load(std::memory_order_relaxed);
+      counter.bytes = slots[i].bytes[stage].load(std::memory_order_relaxed);
+      counter.frees = slots[i].frees[stage].load(std::memory_order_relaxed);
+    }
+  }
+  return count;
+}
+
+AllocationScope::AllocationScope(AllocationStage stage)
+    : m_previous(threadStage) {
+  threadStage = static_cast<int>(stage);
+}
+
+AllocationScope::~AllocationScope() { threadStage = m_previous; }
+
+void AllocationScope::Enter(AllocationStage stage) {
+  threadStage = static_cast<int>(stage);
+}
+
+/*
+ * The default array and nothrow forms all end up in these, see
+ * [new.delete] in the standard.
+ */
+void *operator new(std::size_t size) {
+  count_allocation(size);
+  for (;;) {
+    if (void *pointer = std::malloc(size > 0 ? size : 1)) {
+      return pointer;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  count_allocation(size);
+  const size_t align = static_cast<size_t>(alignment);
+  /* aligned_alloc wants a multiple of the alignment */
+  const size_t rounded = (size + align - 1) / align * align;
+  for (;;) {
+#ifdef _WIN32
+    void *pointer = _aligned_malloc(rounded > 0 ? rounded : align, align);
+#else
+    void *pointer = std::aligned_alloc(align, rounded > 0 ? rounded : align);
+#endif
+    if (pointer != nullptr) {
+      return pointer;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+void operator delete(void *pointer) noexcept {
+  count_free(pointer);
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  count_free(pointer);
+#ifdef _WIN32
+  _aligned_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  operator delete(pointer);
+}
+
+void operator delete(void *pointer, std::size_t,
+                     std::align_val_t alignment) noexcept {
+  operator delete(pointer, alignment);
+}
+
+#endif
@@ -0,0 +1,153 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "channel_registry.h"
+
+#include <algorithm>
+#include <iterator>
+
+using TelemetryChannels::Table;
+
+ChannelRegistry::ChannelRegistry(
+    scs_telemetry_register_for_channel_t registerChannel,
+    scs_telemetry_unregister_from_channel_t unregisterChannel,
+    TelemetryFrame *frame)
+    : m_register(registerChannel), m_unregister(unregisterChannel),
+      m_frame(frame) {
+  for (size_t c = 0; c < std::size(Table); ++c) {
+    if (!TelemetryChannels::IsTrailerScope(Table[c].scope)) {
+      continue;
+    }
+    for (scs_u32_t i = 0; i < MAX_TRAILERS; ++i) {
+      TelemetryChannels::TrailerChannelName(trailerName(i, c), Table[c].name,
+                                            i);
+    }
+  }
+  /* Required channels stay registered until the SDK drops them at shutdown */
+  for (size_t c = 0; c < std::size(Table); ++c) {
+    if (!Table[c].required) {
+      continue;
+    }
+    if (Table[c].scope == ChannelScope::Frame) {
+      setRegistered(c, Table[c].name, SCS_U32_NIL, 0, 0, true);
+    } else if (Table[c].scope == ChannelScope::Trailer) {
+      for (scs_u32_t i = 0; i < MAX_TRAILERS; ++i) {
+        setRegistered(c, trailerName(i, c), SCS_U32_NIL, i, 0, true);
+      }
+    }
+  }
+}
+
+char *ChannelRegistry::trailerName(scs_u32_t trailer, size_t channel) {
+  return m_trailerNames[trailer][TelemetryChannels::TrailerSlot(channel)];
+}
+
+void ChannelRegistry::setRegistered(size_t channel, scs_string_t name,
+                                    scs_u32_t index, scs_u32_t trailer,
+                                    scs_u32_t wheel, bool registered) {
+  const ChannelEntry &entry = Table[channel];
+  if (registered) {
+    m_register(name, index, entry.type, scs_u32_t(0), entry.callback,
+               entry.target(m_frame, trailer, wheel));
+  } else {
+    m_unregister(name, index, entry.type);
+  }
+}
+
+bool ChannelRegistry::setTruck(bool registered) {
+  if (m_truck == registered) {
+    return false;
+  }
+  for (size_t c = 0; c < std::size(Table); ++c) {
+    if (Table[c].scope == ChannelScope::Frame && !Table[c].required) {
+      setRegistered(c, Table[c].name, SCS_U32_NIL, 0, 0, registered);
+    }
+  }
+  m_truck = registered;
+  return true;
+}
+
+bool ChannelRegistry::setTruckWheel(scs_u32_t wheel, bool registered) {
+  if (m_truckWheels[wheel] == registered) {
+    return false;
+  }
+  for (size_t c = 0; c < std::size(Table); ++c) {
+    if (Table[c].scope == ChannelScope::TruckWheel) {
+      setRegistered(c, Table[c].name, wheel, 0, wheel, registered);
+    }
+  }
+  m_truckWheels[wheel] = registered;
+  return true;
+}
+
+bool ChannelRegistry::setTrailer(scs_u32_t trailer, bool registered) {
+  if (m_trailers[trailer] == registered) {
+    return false;
+  }
+  for (size_t c = 0; c < std::size(Table); ++c) {
+    if (Table[c].scope == ChannelScope::Trailer && !Table[c].required) {
+      setRegistered(c, trailerName(trailer, c), SCS_U32_NIL, trailer, 0,
+                    registered);
+    }
+  }
+  m_trailers[trailer] = registered;
+  return true;
+}
+
+bool ChannelRegistry::setTrailerWheel(scs_u32_t trailer, scs_u32_t wheel,
+                                      bool registered) {
+  if (m_trailerWheels[trailer][wheel] == registered) {
+    return false;
+  }
+  for (size_t c = 0; c < std::size(Table); ++c) {
+    if (Table[c].scope == ChannelScope::TrailerWheel) {
+      setRegistered(c, trailerName(trailer, c), wheel, trailer, wheel,
+                    registered);
+    }
+  }
+  m_trailerWheels[trailer][wheel] = registered;
+  return true;
+}
+
+bool ChannelRegistry::Update(const ChannelDemand &demand) {
+  bool changed = setTruck(demand.truck);
+
+  const scs_u32_t truckWheels =
+      demand.wheels ? std::min(m_frame->truck.config.wheelCount,
+                               scs_u32_t(MAX_WHEEL_COUNT))
+                    : 0;
+  for (scs_u32_t j = 0; j < MAX_WHEEL_COUNT; ++j) {
+    changed |= setTruckWheel(j, j < truckWheels);
+  }
+
+  for (scs_u32_t i = 0; i < MAX_TRAILERS; ++i) {
+    const TelemetryTrailer &trailer = m_frame->trailer[i];
+    const bool connected = demand.trailers && trailer.connected;
+    changed |= setTrailer(i, connected);
+    const scs_u32_t trailerWheels =
+        connected && demand.wheels
+            ? std::min(trailer.config.wheelCount, scs_u32_t(MAX_WHEEL_COUNT))
+            : 0;
+    for (scs_u32_t j = 0; j < MAX_WHEEL_COUNT; ++j) {
+      changed |= setTrailerWheel(i, j, j < trailerWheels);
+    }
+  }
+  return changed;
+}
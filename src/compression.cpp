@@ -0,0 +1,178 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "compression.h"
+
+#include <cstring>
+
+#ifdef TSTS_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef TSTS_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+#ifdef TSTS_WITH_ZLIB
+class DeflateCompressor : public MessageCompressor {
+public:
+  DeflateCompressor() {
+    memset(&m_stream, 0, sizeof(m_stream));
+    deflateInit2(&m_stream, COMPRESSION_DEFLATE_LEVEL, Z_DEFLATED, -15, 8,
+                 Z_DEFAULT_STRATEGY);
+  }
+  ~DeflateCompressor() override { deflateEnd(&m_stream); }
+
+  bool Compress(std::string_view message, bool reset,
+                std::string *out) override {
+    if (reset || !m_started) {
+      /* Raw deflate, decoders call inflateSetDictionary right away */
+      deflateReset(&m_stream);
+      deflateSetDictionary(&m_stream, FrameDictionary,
+                           static_cast<uInt>(FrameDictionarySize));
+      m_started = true;
+      reset = true;
+    }
+    out->resize(Bound(message.size()));
+    (*out)[0] = static_cast<char>(reset ? COMPRESSION_FLAG_RESET : 0);
+    m_stream.next_in =
+        reinterpret_cast<Bytef *>(const_cast<char *>(message.data()));
+    m_stream.avail_in = static_cast<uInt>(message.size());
+    size_t used = 1;
+    for (;;) {
+      m_stream.next_out = reinterpret_cast<Bytef *>(out->data() + used);
+      m_stream.avail_out = static_cast<uInt>(out->size() - used);
+      const int result = deflate(&m_stream, Z_SYNC_FLUSH);
+      if (result != Z_OK && result != Z_BUF_ERROR) {
+        return false;
+      }
+      used = out->size() - m_stream.avail_out;
+      if (m_stream.avail_out != 0) {
+        break;
+      }
+      out->resize(out->size() * 2);
+    }
+    out->erase(used);
+    return true;
+  }
+
+  size_t Bound(size_t size) override {
+    return 1 + deflateBound(&m_stream, static_cast<uLong>(size)) + 16;
+  }
+
+private:
+  z_stream m_stream;
+  bool m_started = false;
+};
+#endif
+
+#ifdef TSTS_WITH_ZSTD
+class ZstdCompressor : public MessageCompressor {
+public:
+  ZstdCompressor() : m_context(ZSTD_createCCtx()) {
+    ZSTD_CCtx_setParameter(m_context, ZSTD_c_compressionLevel,
+                           COMPRESSION_ZSTD_LEVEL);
+    /* The size isn't known up front while streaming, leave it out */
+    ZSTD_CCtx_setParameter(m_context, ZSTD_c_contentSizeFlag, 0);
+    ZSTD_CCtx_loadDictionary(m_context, FrameDictionary, FrameDictionarySize);
+  }
+  ~ZstdCompressor() override { ZSTD_freeCCtx(m_context); }
+
+  bool Compress(std::string_view message, bool reset,
+                std::string *out) override {
+    if (reset || !m_started) {
+      /* Keeps the parameters and the dictionary */
+      ZSTD_CCtx_reset(m_context, ZSTD_reset_session_only);
+      m_started = true;
+      reset = true;
+    }
+    out->resize(Bound(message.size()));
+    (*out)[0] = static_cast<char>(reset ? COMPRESSION_FLAG_RESET : 0);
+    ZSTD_inBuffer input = {message.data(), message.size(), 0};
+    ZSTD_outBuffer output = {out->data(), out->size(), 1};
+    size_t remaining;
+    do {
+      remaining = ZSTD_compressStream2(m_context, &output, &input,
+                                       ZSTD_e_flush);
+      if (ZSTD_isError(remaining)) {
+        return false;
+      }
+      if (remaining != 0 && output.pos == output.size) {
+        out->resize(out->size() * 2);
+        output.dst = out->data();
+        output.size = out->size();
+      }
+    } while (remaining != 0);
+    out->resize(output.pos);
+    return true;
+  }
+
+  size_t Bound(size_t size) override {
+    return 1 + ZSTD_compressBound(size) + 16;
+  }
+
+private:
+  ZSTD_CCtx *m_context;
+  bool m_started = false;
+};
+#endif
+
+} // namespace
+
+std::unique_ptr<MessageCompressor>
+MessageCompressor::Create(Compression compression) {
+  switch (compression) {
+#ifdef TSTS_WITH_ZLIB
+  case Compression::Deflate:
+    return std::make_unique<DeflateCompressor>();
+#endif
+#ifdef TSTS_WITH_ZSTD
+  case Compression::Zstd:
+    return std::make_unique<ZstdCompressor>();
+#endif
+  default:
+    return nullptr;
+  }
+}
+
+bool MessageCompressor::Parse(std::string_view name, Compression *compression) {
+  if (name == "none") {
+    *compression = Compression::None;
+  } else if (name == "deflate") {
+    *compression = Compression::Deflate;
+  } else if (name == "zstd") {
+    *compression = Compression::Zstd;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char *MessageCompressor::Name(Compression compression) {
+  switch (compression) {
+  case Compression::Deflate:
+    return "deflate";
+  case Compression::Zstd:
+    return "zstd";
+  default:
+    return "none";
+  }
+}
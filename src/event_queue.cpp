@@ -21,29 +21,133 @@ If not, see <https://www.gnu.org/licenses/>.
 
 #include "event_queue.h"
 
-void EventQueue::PushEvent(std::string eventInfo,const char* type){
-    m_mutex.lock();
-    EventInfo event;
-    event.type = type;
-    event.event = eventInfo;
-    m_serializedEvents.push(event);
-    m_mutex.unlock();
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+EventQueue::EventQueue():m_events(EVENT_QUEUE_CAPACITY){
+    #ifndef _WIN32
+    if(pipe(m_wakePipe) != 0){
+        m_wakePipe[0] = m_wakePipe[1] = -1;
+        return;
+    }
+    /* A full pipe is readable already, neither end may block */
+    for(int fd : m_wakePipe){
+        fcntl(fd,F_SETFL,fcntl(fd,F_GETFL) | O_NONBLOCK);
+        fcntl(fd,F_SETFD,FD_CLOEXEC);
+    }
+    #endif
+}
+
+EventQueue::~EventQueue(){
+    #ifndef _WIN32
+    for(int fd : m_wakePipe){
+        if(fd != -1){
+            close(fd);
+        }
+    }
+    #endif
+}
+
+MessageRef EventQueue::Acquire(size_t size){
+    return m_pool.Acquire(size);
+}
+
+void EventQueue::PushEvent(MessageRef event,const char* type){
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_count == m_events.size()){
+        /* Unroll the ring into a bigger one */
+        std::vector<EventInfo> events(m_events.size() * 2);
+        for(size_t i = 0; i < m_count; i++){
+            events[i] = std::move(m_events[(m_head + i) % m_events.size()]);
+        }
+        m_events = std::move(events);
+        m_head = 0;
+    }
+    event.Mark(TracePoint::Enqueue);
+    EventInfo& slot = m_events[(m_head + m_count) % m_events.size()];
+    slot.event = std::move(event);
+    slot.type = type;
+    m_count++;
+    m_peak = m_count > m_peak ? m_count : m_peak;
+    /* Only a sleeping consumer costs the game thread a write */
+    const bool wake = m_waiting;
+    m_waiting = false;
+    lock.unlock();
+    if(wake){
+        Wake();
+    }
+}
+
+void EventQueue::PushEvent(std::string_view event,const char* type){
+    MessageRef message = m_pool.Acquire(event.size());
+    message->assign(event);
+    PushEvent(std::move(message),type);
 }
 
 EventInfo EventQueue::PopEvent(){
-    m_mutex.lock();
-    if(m_serializedEvents.empty()){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_count == 0){
         return {};
     }
-    EventInfo event = m_serializedEvents.front();
-    m_serializedEvents.pop();
-    m_mutex.unlock();
+    EventInfo event = std::move(m_events[m_head]);
+    event.event.Mark(TracePoint::Dequeue);
+    m_head = (m_head + 1) % m_events.size();
+    m_count--;
     return event;
 }
 
 bool EventQueue::IsEmpty(){
-    m_mutex.lock();
-    bool isEmpty = m_serializedEvents.empty();
-    m_mutex.unlock();
-    return isEmpty;
-}
\ No newline at end of file
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count == 0;
+}
+
+bool EventQueue::IsDrained(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count == 0 && (m_waiting || m_wakePipe[0] == -1);
+}
+
+MessagePoolStats EventQueue::PoolStats() const{
+    return m_pool.Stats();
+}
+
+EventQueueStats EventQueue::Stats(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return {m_count,m_peak};
+}
+
+int EventQueue::WakeDescriptor() const{
+    return m_wakePipe[0];
+}
+
+bool EventQueue::PrepareWait(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_wakePipe[0] == -1 || m_count != 0){
+        return false;
+    }
+    m_waiting = true;
+    return true;
+}
+
+void EventQueue::FinishWait(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_waiting = false;
+    }
+    #ifndef _WIN32
+    char buffer[64];
+    while(m_wakePipe[0] != -1 && read(m_wakePipe[0],buffer,sizeof(buffer)) > 0){
+    }
+    #endif
+}
+
+void EventQueue::Wake(){
+    #ifndef _WIN32
+    if(m_wakePipe[1] != -1){
+        const char byte = 0;
+        /* Fails only if the pipe is full, and then it's readable anyway */
+        [[maybe_unused]] ssize_t written = write(m_wakePipe[1],&byte,1);
+    }
+    #endif
+}
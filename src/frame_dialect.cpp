@@ -0,0 +1,263 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "frame_dialect.h"
+#include "telemetry.h"
+#include "telemetry_schema.h"
+
+#include <algorithm>
+#include <array>
+#include <nlohmann/json.hpp>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+struct Layout;
+
+struct Field {
+  const char *name;
+  /* Set for objects and arrays of objects */
+  const Layout *layout = nullptr;
+  bool repeated = false;
+  /* Values of the field in one parent, weighs the aliases */
+  size_t count = 1;
+};
+
+/* The fields of a telemetry type in schema order */
+struct Layout {
+  std::vector<Field> fields;
+};
+
+template <typename T> struct Extent {
+  using Element = T;
+  static constexpr size_t count = 1;
+};
+template <typename T, size_t N> struct Extent<T[N]> {
+  using Element = T;
+  static constexpr size_t count = N;
+};
+template <typename T, size_t N> struct Extent<std::array<T, N>> {
+  using Element = T;
+  static constexpr size_t count = N;
+};
+
+template <typename T> const Layout &layout_of();
+
+template <typename Member> void add_field(Layout *layout, const char *name) {
+  using Element = typename Extent<Member>::Element;
+  Field field{name};
+  field.count = Extent<Member>::count;
+  if constexpr (std::is_class_v<Element> &&
+                !std::is_same_v<Element, std::string>) {
+    field.layout = &layout_of<Element>();
+    field.repeated = !std::is_same_v<Element, Member>;
+  }
+  layout->fields.push_back(field);
+}
+
+/* Walks the same field lists as telemetry_json.h */
+#define DIALECT_FIELD(field) add_field<decltype(Type::field)>(&fields, #field);
+#define DIALECT_LAYOUT(T, FIELDS)                                              \
+  template <> const Layout &layout_of<T>() {                                   \
+    static const Layout layout = [] {                                          \
+      using Type = T;                                                          \
+      Layout fields;                                                           \
+      NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(DIALECT_FIELD, FIELDS))         \
+      return fields;                                                           \
+    }();                                                                       \
+    return layout;                                                             \
+  }
+
+DIALECT_LAYOUT(TelemetryVec3D, TELEMETRY_VEC3D_FIELDS)
+DIALECT_LAYOUT(TelemetryOrientation, TELEMETRY_ORIENTATION_FIELDS)
+DIALECT_LAYOUT(TelemetryPlacement, TELEMETRY_PLACEMENT_FIELDS)
+DIALECT_LAYOUT(TelemetryWheel, TELEMETRY_WHEEL_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckCabin, TELEMETRY_TRUCK_CABIN_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckInput, TELEMETRY_TRUCK_INPUT_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckBrake, TELEMETRY_TRUCK_BRAKE_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckFuel, TELEMETRY_TRUCK_FUEL_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckEngine, TELEMETRY_TRUCK_ENGINE_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckOil, TELEMETRY_TRUCK_OIL_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckAdblue, TELEMETRY_TRUCK_ADBLUE_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckLight, TELEMETRY_TRUCK_LIGHT_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckWear, TELEMETRY_TRUCK_WEAR_FIELDS)
+DIALECT_LAYOUT(TelemetryTruckNavigation, TELEMETRY_TRUCK_NAVIGATION_FIELDS)
+DIALECT_LAYOUT(TelemetryTruck, TELEMETRY_TRUCK_FIELDS)
+DIALECT_LAYOUT(TelemetryTrailerWear, TELEMETRY_TRAILER_WEAR_FIELDS)
+DIALECT_LAYOUT(TelemetryTrailer, TELEMETRY_TRAILER_FIELDS)
+DIALECT_LAYOUT(TelemetryJob, TELEMETRY_JOB_FIELDS)
+DIALECT_LAYOUT(TelemetryFrame, TELEMETRY_FRAME_FIELDS)
+
+void count_keys(const Layout &layout, size_t weight,
+                std::vector<std::pair<std::string_view, size_t>> *keys) {
+  for (const Field &field : layout.fields) {
+    auto key = std::find_if(keys->begin(), keys->end(), [&](const auto &entry) {
+      return entry.first == field.name;
+    });
+    if (key == keys->end()) {
+      key = keys->insert(keys->end(), {field.name, 0});
+    }
+    key->second += weight * field.count;
+    if (field.layout != nullptr) {
+      count_keys(*field.layout, weight * field.count, keys);
+    }
+  }
+}
+
+/* Letters first, then a letter and a letter or digit */
+std::string alias_of(size_t index) {
+  static const char characters[] =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  if (index < 52) {
+    return std::string(1, characters[index]);
+  }
+  index -= 52;
+  return {characters[index / 62 % 52], characters[index % 62]};
+}
+
+struct ShortKeys {
+  /* By JsonWriter::KeyIndex */
+  std::vector<std::string> aliases;
+  std::string header;
+};
+
+const ShortKeys &short_keys() {
+  static const ShortKeys keys = [] {
+    std::vector<std::pair<std::string_view, size_t>> counts;
+    count_keys(layout_of<TelemetryFrame>(), 1, &counts);
+    /* The keys repeated most get the shortest aliases */
+    std::stable_sort(counts.begin(), counts.end(),
+                     [](const auto &a, const auto &b) {
+                       return a.second > b.second;
+                     });
+    ShortKeys shortKeys;
+    nlohmann::json header;
+    header["payloadType"] = "dialect";
+    header["payload"]["dialect"] = Dialect::Name(FrameDialect::Short);
+    nlohmann::json &names = header["payload"]["keys"];
+    for (size_t i = 0; i < counts.size(); i++) {
+      const std::string alias = alias_of(i);
+      const size_t key = JsonWriter::KeyIndex(counts[i].first);
+      if (key >= shortKeys.aliases.size()) {
+        shortKeys.aliases.resize(key + 1);
+      }
+      shortKeys.aliases[key] = alias;
+      names[alias] = counts[i].first;
+    }
+    shortKeys.header = header.dump();
+    return shortKeys;
+  }();
+  return keys;
+}
+
+nlohmann::json schema_of(const Layout &layout) {
+  nlohmann::json fields = nlohmann::json::array();
+  for (const Field &field : layout.fields) {
+    if (field.layout == nullptr) {
+      fields.push_back(field.name);
+      continue;
+    }
+    nlohmann::json child = schema_of(*field.layout);
+    nlohmann::json entry;
+    entry[field.name] =
+        field.repeated ? nlohmann::json::array({std::move(child)}) : child;
+    fields.push_back(std::move(entry));
+  }
+  return fields;
+}
+
+} // namespace
+
+bool Dialect::Parse(std::string_view name, FrameDialect *dialect) {
+  for (int i = 0; i < DIALECT_COUNT; i++) {
+    if (name == Name(static_cast<FrameDialect>(i))) {
+      *dialect = static_cast<FrameDialect>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *Dialect::Name(FrameDialect dialect) {
+  switch (dialect) {
+  case FrameDialect::Short:
+    return "short";
+  case FrameDialect::Positional:
+    return "positional";
+  case FrameDialect::Fixed:
+    return "fixed";
+  default:
+    return "standard";
+  }
+}
+
+const std::string &Dialect::Header(FrameDialect dialect) {
+  if (dialect == FrameDialect::Short) {
+    return short_keys().header;
+  }
+  static const std::string headers[] = {
+      R"({"payload":{"dialect":"standard"},"payloadType":"dialect"})",
+      std::string(),
+      [] {
+        nlohmann::json header;
+        header["payloadType"] = "dialect";
+        header["payload"]["dialect"] = Name(FrameDialect::Positional);
+        header["payload"]["schema"] = schema_of(layout_of<TelemetryFrame>());
+        return header.dump();
+      }(),
+      R"({"payload":{"dialect":"fixed"},"payloadType":"dialect"})"};
+  return headers[static_cast<size_t>(dialect)];
+}
+
+JsonWriter::FrameFormat Dialect::Format(FrameDialect dialect) {
+  JsonWriter::FrameFormat format;
+  format.keys =
+      dialect == FrameDialect::Short ? &short_keys().aliases : nullptr;
+  format.positional = dialect == FrameDialect::Positional;
+  format.fixed = dialect == FrameDialect::Fixed;
+  return format;
+}
+
+void FrameDialects::SetFrame(FrameTiers *tiers) {
+  m_tiers = tiers;
+  for (int tier = 0; tier < LOD_TIER_COUNT; tier++) {
+    for (int dialect = 0; dialect < DIALECT_COUNT; dialect++) {
+      m_encoded[tier][dialect] = false;
+    }
+  }
+}
+
+const std::string *FrameDialects::Get(LodTier tier, FrameDialect dialect) {
+  if (dialect == FrameDialect::Standard) {
+    return m_tiers->Get(tier);
+  }
+  if (m_tiers->Message().Frame() == nullptr) {
+    return nullptr;
+  }
+  const size_t t = static_cast<size_t>(tier);
+  const size_t d = static_cast<size_t>(dialect);
+  if (!m_encoded[t][d]) {
+    JsonWriter::FrameFormat format = Dialect::Format(dialect);
+    format.omit = Lod::Omitted(tier);
+    m_tiers->Encode(tier, format, &m_messages[t][d]);
+    m_encoded[t][d] = true;
+  }
+  return &m_messages[t][d];
+}
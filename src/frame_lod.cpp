@@ -0,0 +1,109 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "frame_lod.h"
+#include "telemetry.h"
+
+bool Lod::Parse(std::string_view name, LodTier *tier) {
+  for (int i = 0; i < LOD_TIER_COUNT; i++) {
+    if (name == Name(static_cast<LodTier>(i))) {
+      *tier = static_cast<LodTier>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *Lod::Name(LodTier tier) {
+  switch (tier) {
+  case LodTier::NoWheels:
+    return "no-wheels";
+  case LodTier::TruckCore:
+    return "truck";
+  case LodTier::Gauges:
+    return "gauges";
+  default:
+    return "full";
+  }
+}
+
+int Lod::IntervalMs(LodTier tier) {
+  switch (tier) {
+  case LodTier::TruckCore:
+    return LOD_TRUCK_INTERVAL_MS;
+  case LodTier::Gauges:
+    return LOD_GAUGES_INTERVAL_MS;
+  default:
+    return 0;
+  }
+}
+
+uint32_t Lod::Omitted(LodTier tier) {
+  switch (tier) {
+  case LodTier::NoWheels:
+    return FRAME_FIELDS_WHEELS;
+  case LodTier::TruckCore:
+    return FRAME_FIELDS_WHEELS | FRAME_FIELDS_TRAILERS;
+  case LodTier::Gauges:
+    return FRAME_FIELDS_WHEELS | FRAME_FIELDS_TRAILERS |
+           FRAME_FIELDS_NON_GAUGES;
+  default:
+    return 0;
+  }
+}
+
+void FrameTiers::SetFrame(const MessageRef &frame) {
+  m_frame = frame;
+  const std::string_view message = *frame;
+  const size_t stamp = message.rfind(",\"seq\":");
+  m_stamp = stamp == std::string_view::npos ? std::string_view("}")
+                                            : message.substr(stamp);
+  for (bool &written : m_written) {
+    written = false;
+  }
+}
+
+const std::string *FrameTiers::Get(LodTier tier) {
+  if (tier == LodTier::Full) {
+    return &*m_frame;
+  }
+  if (m_frame.Frame() == nullptr) {
+    return nullptr;
+  }
+  const size_t t = static_cast<size_t>(tier);
+  if (!m_written[t]) {
+    JsonWriter::FrameFormat format;
+    format.omit = Lod::Omitted(tier);
+    Encode(tier, format, &m_tiers[t]);
+    m_written[t] = true;
+  }
+  return &m_tiers[t];
+}
+
+void FrameTiers::Encode(LodTier tier, JsonWriter::FrameFormat format,
+                        std::string *out) const {
+  out->assign(tier == LodTier::Full ? "{" : "{\"lod\":\"");
+  if (tier != LodTier::Full) {
+    out->append(Lod::Name(tier)).append("\",");
+  }
+  out->append("\"payload\":");
+  JsonWriter::AppendFrame(out, *m_frame.Frame(), format);
+  out->append(",\"payloadType\":\"frame\"").append(m_stamp);
+}
@@ -0,0 +1,70 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "frame_scheduler.h"
+
+#include <cmath>
+
+static bool input_moved(const TelemetryTruckInput &a,
+                        const TelemetryTruckInput &b) {
+  return std::fabs(a.steering - b.steering) > IDLE_INPUT_EPSILON ||
+         std::fabs(a.throttle - b.throttle) > IDLE_INPUT_EPSILON ||
+         std::fabs(a.brake - b.brake) > IDLE_INPUT_EPSILON ||
+         std::fabs(a.clutch - b.clutch) > IDLE_INPUT_EPSILON;
+}
+
+bool FrameScheduler::isParked(const TelemetryFrame *frame) {
+  const TelemetryTruck &truck = frame->truck;
+  bool active = truck.engine.enabled ||
+                std::fabs(truck.speed) > IDLE_SPEED_EPSILON ||
+                input_moved(truck.input, m_lastInput);
+  m_lastInput = truck.input;
+  return !active;
+}
+
+bool FrameScheduler::ShouldEmit(TelemetryFrame *frame, bool changed,
+                                bool forced) {
+  using namespace std::chrono;
+  const auto now = steady_clock::now();
+  /* Evaluated every frame so the last seen input stays current */
+  const bool parked = isParked(frame);
+  if (!parked) {
+    m_parkedSince = now;
+  }
+  const bool idle =
+      frame->paused ||
+      (parked && now - m_parkedSince >= milliseconds(IDLE_SETTLE_MS));
+
+  bool emit;
+  if (idle != m_idle || forced) {
+    /* Mode changes go out immediately so clients can adapt */
+    emit = true;
+  } else if (idle) {
+    emit = now - m_lastEmit >= milliseconds(IDLE_HEARTBEAT_MS);
+  } else {
+    emit = changed;
+  }
+  m_idle = idle;
+  frame->idle = idle;
+  if (emit) {
+    m_lastEmit = now;
+  }
+  return emit;
+}
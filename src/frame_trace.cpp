@@ -0,0 +1,70 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "frame_trace.h"
+
+namespace {
+
+LatencyHistogram stages[TRACE_POINT_COUNT];
+
+} // namespace
+
+const char *FrameTracing::PointName(TracePoint point) {
+  switch (point) {
+  case TracePoint::FrameEnd:
+    return "frameEnd";
+  case TracePoint::Snapshot:
+    return "snapshot";
+  case TracePoint::EncodeStart:
+    return "encodeStart";
+  case TracePoint::EncodeEnd:
+    return "encodeEnd";
+  case TracePoint::Enqueue:
+    return "enqueue";
+  case TracePoint::Dequeue:
+    return "dequeue";
+  case TracePoint::FirstWrite:
+    return "firstWrite";
+  default:
+    return "lastWrite";
+  }
+}
+
+void FrameTracing::Record(const MessageTrace &trace) {
+  const int64_t start = trace.At(TracePoint::FrameEnd);
+  if (start == 0) {
+    return;
+  }
+  int64_t previous = start;
+  for (size_t point = 1; point < TRACE_POINT_COUNT; point++) {
+    if (trace.points[point] == 0) {
+      continue;
+    }
+    stages[point].Record(trace.points[point] - previous);
+    previous = trace.points[point];
+  }
+  if (trace.At(TracePoint::LastWrite) != 0) {
+    stages[0].Record(trace.At(TracePoint::LastWrite) - start);
+  }
+}
+
+const LatencyHistogram &FrameTracing::Stage(TracePoint point) {
+  return stages[static_cast<size_t>(point)];
+}
@@ -0,0 +1,264 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "http_api.h"
+
+#include <charconv>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+#include <utility>
+
+namespace {
+
+std::string_view path_of(const HttpRequest &request) {
+  return request.target.substr(0, request.target.find('?'));
+}
+
+std::string status_response(std::string_view status) {
+  std::string response = "HTTP/1.1 ";
+  response.append(status).append("\r\n"
+                                 "Content-Length: 0\r\n"
+                                 "Connection: close\r\n\r\n");
+  return response;
+}
+
+/* FNV-1a, only has to tell versions of the same subtree apart */
+std::string etag_of(std::string_view body) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : body) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+  }
+  char etag[24];
+  snprintf(etag, sizeof(etag), "\"%016llx\"",
+           static_cast<unsigned long long>(hash));
+  return etag;
+}
+
+bool etag_matches(std::string_view header, std::string_view etag) {
+  if (header == "*") {
+    return true;
+  }
+  while (!header.empty()) {
+    const size_t comma = header.find(',');
+    std::string_view candidate = HttpParser::Trim(header.substr(0, comma));
+    /* Weak comparison is fine for GET */
+    if (candidate.substr(0, 2) == "W/") {
+      candidate.remove_prefix(2);
+    }
+    if (candidate == etag) {
+      return true;
+    }
+    header = comma == std::string_view::npos ? std::string_view()
+                                             : header.substr(comma + 1);
+  }
+  return false;
+}
+
+/* A 200 with the body, or a 304 if the client has it already */
+std::string content_response(const HttpRequest &request, std::string_view body,
+                             std::string_view etag,
+                             const char *type = "application/json") {
+  std::string response;
+  if (etag_matches(request.Header("If-None-Match"), etag)) {
+    response = "HTTP/1.1 304 Not Modified\r\n";
+  } else {
+    response = "HTTP/1.1 200 OK\r\n"
+               "Content-Type: ";
+    response.append(type).append("\r\n"
+                                 "Content-Length: ");
+    response.append(std::to_string(body.size())).append("\r\n");
+  }
+  response.append("ETag: ")
+      .append(etag)
+      .append("\r\n"
+              "Cache-Control: no-cache\r\n"
+              "Access-Control-Allow-Origin: *\r\n"
+              "Connection: close\r\n\r\n");
+  if (request.method != "HEAD" && response.compare(9, 3, "200") == 0) {
+    response.append(body);
+  }
+  return response;
+}
+
+} // namespace
+
+HttpApi::HttpApi() = default;
+
+HttpApi::~HttpApi() = default;
+
+void HttpApi::SetFrame(const std::string *frame, uint64_t version) {
+  m_frame = frame;
+  m_version = version;
+}
+
+void HttpApi::SetConfig(const std::string *config) {
+  m_config = config;
+  m_configEtag = etag_of(*config);
+}
+
+void HttpApi::SetStats(std::string stats) { m_stats = std::move(stats); }
+
+void HttpApi::SetMetrics(std::string metrics) {
+  m_metrics = std::move(metrics);
+}
+
+const HttpApi::Projection &HttpApi::project(std::string_view path) {
+  if (m_projections.size() >= HTTP_MAX_PROJECTIONS &&
+      m_projections.find(std::string(path)) == m_projections.end()) {
+    m_projections.clear();
+  }
+  Projection &projection = m_projections[std::string(path)];
+  if (projection.version == m_version) {
+    return projection;
+  }
+  projection.version = m_version;
+  projection.found = true;
+  if (path.empty()) {
+    /*
+     * The whole frame as it was encoded for the stream, without the keys
+     * ReplayRing::Stamp appended. Those change with every message, even
+     * the heartbeats of an idle game, and would change the ETag with them.
+     */
+    const size_t stamp = m_frame->rfind(",\"seq\":");
+    if (stamp == std::string::npos) {
+      projection.body = *m_frame;
+    } else {
+      projection.body.assign(*m_frame, 0, stamp).push_back('}');
+    }
+  } else {
+    if (m_parsed == nullptr || m_parsedVersion != m_version) {
+      m_parsed = std::make_unique<nlohmann::json>(
+          nlohmann::json::parse(*m_frame, nullptr, false));
+      m_parsedVersion = m_version;
+    }
+    const nlohmann::json *node = nullptr;
+    try {
+      const nlohmann::json::json_pointer pointer("/payload" +
+                                                 std::string(path));
+      if (m_parsed->contains(pointer)) {
+        node = &(*m_parsed)[pointer];
+      }
+    } catch (nlohmann::json::exception &) {
+      /* Malformed pointers are just missing subtrees */
+    }
+    projection.found = node != nullptr;
+    projection.body = projection.found ? node->dump() : std::string();
+  }
+  projection.etag = etag_of(projection.body);
+  return projection;
+}
+
+std::string HttpApi::Respond(const HttpRequest &request) {
+  const bool head = request.method == "HEAD";
+  if (request.method != "GET" && !head) {
+    return status_response("405 Method Not Allowed");
+  }
+  const std::string_view path = path_of(request);
+  if (path == "/config") {
+    if (m_config == nullptr) {
+      return status_response("503 Service Unavailable");
+    }
+    return content_response(request, *m_config, m_configEtag);
+  }
+  if (path == "/stats") {
+    return content_response(request, m_stats, etag_of(m_stats));
+  }
+  if (path == "/metrics") {
+    return content_response(request, m_metrics, etag_of(m_metrics),
+                            "text/plain; version=0.0.4; charset=utf-8");
+  }
+  if (path != "/frame" && path.substr(0, 7) != "/frame/") {
+    return status_response("404 Not Found");
+  }
+  if (m_frame == nullptr || m_frame->empty()) {
+    return status_response("503 Service Unavailable");
+  }
+  std::string_view subtree = path.substr(6);
+  if (subtree == "/") {
+    subtree = std::string_view();
+  }
+  const Projection &projection = project(subtree);
+  if (!projection.found) {
+    return status_response("404 Not Found");
+  }
+  return content_response(request, projection.body, projection.etag);
+}
+
+bool HttpApi::IsEventStream(const HttpRequest &request) {
+  return request.method == "GET" && path_of(request) == "/stream";
+}
+
+bool HttpApi::IsStats(const HttpRequest &request) {
+  return path_of(request) == "/stats";
+}
+
+bool HttpApi::IsMetrics(const HttpRequest &request) {
+  return path_of(request) == "/metrics";
+}
+
+std::string HttpApi::NotFound() { return status_response("404 Not Found"); }
+
+std::string_view HttpApi::QueryParameter(const HttpRequest &request,
+                                         std::string_view name) {
+  const size_t query = request.target.find('?');
+  if (query == std::string_view::npos) {
+    return std::string_view();
+  }
+  std::string_view rest = request.target.substr(query + 1);
+  while (!rest.empty()) {
+    const size_t amp = rest.find('&');
+    const std::string_view parameter = rest.substr(0, amp);
+    rest = amp == std::string_view::npos ? std::string_view()
+                                         : rest.substr(amp + 1);
+    if (parameter.size() > name.size() && parameter[name.size()] == '=' &&
+        parameter.substr(0, name.size()) == name) {
+      return parameter.substr(name.size() + 1);
+    }
+  }
+  return std::string_view();
+}
+
+std::chrono::milliseconds HttpApi::StreamInterval(const HttpRequest &request) {
+  const std::string_view value = QueryParameter(request, "rate");
+  unsigned rate = 0;
+  std::from_chars(value.data(), value.data() + value.size(), rate);
+  if (rate > 0) {
+    return std::chrono::milliseconds(1000 / rate);
+  }
+  return std::chrono::milliseconds(0);
+}
+
+std::string HttpApi::EventStreamHeaders() {
+  return "HTTP/1.1 200 OK\r\n"
+         "Content-Type: text/event-stream\r\n"
+         "Cache-Control: no-cache\r\n"
+         "Access-Control-Allow-Origin: *\r\n"
+         "Connection: keep-alive\r\n\r\n";
+}
+
+void HttpApi::AppendStreamEvent(std::string *out, std::string_view type,
+                                std::string_view event) {
+  /* The encoder never emits raw newlines, one data line holds the event */
+  out->append("event: ")
+      .append(type)
+      .append("\ndata: ")
+      .append(event)
+      .append("\n\n");
+}
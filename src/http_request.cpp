@@ -0,0 +1,102 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "http_request.h"
+
+#include <cctype>
+
+bool HttpParser::EqualsIgnoreCase(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (tolower(static_cast<unsigned char>(a[i])) !=
+        tolower(static_cast<unsigned char>(b[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string_view HttpParser::Trim(std::string_view value) {
+  while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+    value.remove_prefix(1);
+  }
+  while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+size_t HttpParser::HeadSize(std::string_view buffer) {
+  const size_t end = buffer.find("\r\n\r\n");
+  return end == std::string_view::npos ? 0 : end + 4;
+}
+
+bool HttpParser::Parse(std::string_view head, HttpRequest *request) {
+  const size_t lineEnd = head.find("\r\n");
+  if (lineEnd == std::string_view::npos) {
+    return false;
+  }
+  const std::string_view line = head.substr(0, lineEnd);
+  const size_t methodEnd = line.find(' ');
+  const size_t targetEnd = line.rfind(' ');
+  if (methodEnd == std::string_view::npos || targetEnd <= methodEnd ||
+      line.substr(targetEnd + 1).substr(0, 5) != "HTTP/") {
+    return false;
+  }
+  request->method = line.substr(0, methodEnd);
+  request->target = line.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+  request->headers = head.substr(lineEnd + 2);
+  return true;
+}
+
+std::string_view HttpRequest::Header(std::string_view name) const {
+  std::string_view rest = headers;
+  while (!rest.empty()) {
+    const size_t lineEnd = rest.find("\r\n");
+    const std::string_view line = rest.substr(0, lineEnd);
+    rest = lineEnd == std::string_view::npos ? std::string_view()
+                                              : rest.substr(lineEnd + 2);
+    const size_t colon = line.find(':');
+    if (colon != std::string_view::npos &&
+        HttpParser::EqualsIgnoreCase(line.substr(0, colon), name)) {
+      return HttpParser::Trim(line.substr(colon + 1));
+    }
+  }
+  return std::string_view();
+}
+
+bool HttpRequest::HeaderHasToken(std::string_view name,
+                                 std::string_view token) const {
+  std::string_view value = Header(name);
+  while (!value.empty()) {
+    const size_t comma = value.find(',');
+    std::string_view item = value.substr(0, comma);
+    /* Parameters like ";q=1" don't matter here */
+    item = HttpParser::Trim(item.substr(0, item.find(';')));
+    if (HttpParser::EqualsIgnoreCase(item, token)) {
+      return true;
+    }
+    value = comma == std::string_view::npos ? std::string_view()
+                                            : value.substr(comma + 1);
+  }
+  return false;
+}
@@ -20,24 +20,87 @@ If not, see <https://www.gnu.org/licenses/>.
 
 
 #include "json_telemetry_serializer.h"
+#include "json_writer.h"
 #include "telemetry.h"
-#include "telemetry_json.h"
-#include <nlohmann/json.hpp>
-
+#include <algorithm>
 
+namespace{
+        void appendValue(std::string* out,const scs_value_t& value){
+                switch(value.type){
+                        case SCS_VALUE_TYPE_string:
+                                JsonWriter::AppendString(out,value.value_string.value);
+                                break;
+                        case SCS_VALUE_TYPE_float:
+                                JsonWriter::AppendDouble(out,value.value_float.value);
+                                break;
+                        case SCS_VALUE_TYPE_double:
+                                JsonWriter::AppendDouble(out,value.value_double.value);
+                                break;
+                        case SCS_VALUE_TYPE_s32:
+                                JsonWriter::AppendInteger(out,value.value_s32.value);
+                                break;
+                        case SCS_VALUE_TYPE_s64:
+                                JsonWriter::AppendInteger(out,value.value_s64.value);
+                                break;
+                        case SCS_VALUE_TYPE_u32:
+                                JsonWriter::AppendInteger(out,value.value_u32.value);
+                                break;
+                        case SCS_VALUE_TYPE_u64:
+                                JsonWriter::AppendInteger(out,value.value_u64.value);
+                                break;
+                        case SCS_VALUE_TYPE_bool:
+                                out->append(value.value_bool.value != 0 ? "true" : "false");
+                                break;
+                        default:
+                                out->push_back('0');
+                                break;
+                }
+        }
+}
 
-std::string JsonTelemetrySerializer::SerializeFrame(TelemetryFrame* frame){
-        nlohmann::json serializedFrame;
-        serializedFrame["payloadType"] = "frame";
-        serializedFrame["payload"] = *frame;
-        return serializedFrame.dump();
-       
+/* Written without json objects, see json_writer.h */
+void JsonTelemetrySerializer::SerializeFrame(TelemetryFrame* frame,std::string* out){
+        out->assign("{\"payload\":");
+        JsonWriter::AppendFrame(out,*frame);
+        out->append(",\"payloadType\":\"frame\"}");
+}
+void JsonTelemetrySerializer::SerializeEvent(TelemetryGameplayEvent* event,std::string* out){
+        /* Sorted by name like the keys of every other message */
+        uint8_t order[MAX_GAMEPLAY_ATTRIBUTES];
+        for(size_t i = 0; i < event->attributeCount; i++){
+                order[i] = static_cast<uint8_t>(i);
+        }
+        std::sort(order,order + event->attributeCount,[event](uint8_t a,uint8_t b){
+                return event->attributes[a].name < event->attributes[b].name;
+        });
+        out->assign("{\"payload\":{\"attributes\":");
+        if(event->attributeCount == 0){
+                /* What json::dump made of the empty attributes */
+                out->append("null");
+        }
+        for(size_t i = 0; i < event->attributeCount; i++){
+                const TelemetryGameplayAttribute& attribute = event->attributes[order[i]];
+                out->append(i == 0 ? "{\"" : ",\"");
+                if(attribute.key == GAMEPLAY_ATTRIBUTE_UNKNOWN){
+                        JsonWriter::AppendEscaped(out,attribute.name);
+                }
+                else{
+                        out->append(GameplayAttributeNames[attribute.key]);
+                }
+                out->append("\":");
+                appendValue(out,attribute.value);
+        }
+        if(event->attributeCount > 0){
+                out->push_back('}');
+        }
+        out->append(",\"eventType\":");
+        JsonWriter::AppendString(out,event->eventType);
+        out->append("},\"payloadType\":\"gameplayEvent\"}");
 }
-std::string JsonTelemetrySerializer::SerializeEvent(TelemetryGameplayEvent* frame){
-        nlohmann::json serializedFrame;
-        serializedFrame["payloadType"] = "gameplayEvent";
-        serializedFrame["payload"] = *frame;
-        return serializedFrame.dump();
+void JsonTelemetrySerializer::SerializeConfig(TelemetryFrame* frame,TelemetryConfigBlock block,size_t index,std::string* out){
+        out->assign("{\"payload\":");
+        JsonWriter::AppendConfig(out,*frame,block,index);
+        out->append(",\"payloadType\":\"config\"}");
 }
 
 JsonTelemetrySerializer::~JsonTelemetrySerializer(){
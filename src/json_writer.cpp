@@ -0,0 +1,375 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "json_writer.h"
+#include "telemetry_json.h"
+#include "telemetry_schema.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <type_traits>
+#include <vector>
+
+/*
+ * AppendDouble uses the number formatter of json::dump, which is not part of
+ * the public interface of nlohmann_json. bench_steady_state_allocations
+ * compares the output with json::dump, check it again before moving on.
+ */
+static_assert(NLOHMANN_JSON_VERSION_MAJOR == 3 &&
+                  NLOHMANN_JSON_VERSION_MINOR == 11,
+              "AppendDouble is only checked against nlohmann_json 3.11");
+
+namespace {
+
+class Writer;
+
+template <typename T> struct Member {
+  std::string_view name;
+  void (*write)(Writer &writer, const T &value, size_t count);
+  /* The FRAME_FIELDS_* groups the field is in */
+  uint32_t groups = 0;
+  /* See JsonWriter::KeyIndex */
+  size_t key = 0;
+};
+
+template <typename T, size_t N> struct Members {
+  /* In the order json::dump writes them */
+  std::array<Member<T>, N> sorted;
+  /* In the order of telemetry_schema.h */
+  std::array<Member<T>, N> declared;
+};
+
+/* Defined for each type below */
+template <typename T> void write_object(Writer &writer, const T &value);
+
+/* Overloads for each kind of field, count limits C arrays */
+class Writer {
+public:
+  explicit Writer(std::string *out,
+                  const JsonWriter::FrameFormat &format = {})
+      : m_out(out), m_format(format) {}
+  std::string *Out() { return m_out; }
+  const JsonWriter::FrameFormat &Format() const { return m_format; }
+
+  void Write(const std::string &value, size_t) {
+    JsonWriter::AppendString(m_out, value);
+  }
+  template <typename T, size_t N>
+  void Write(const std::array<T, N> &values, size_t) {
+    writeArray(values.data(), N, N);
+  }
+  template <typename T, size_t N>
+  void Write(const T (&values)[N], size_t count) {
+    const size_t used = std::min(count, N);
+    writeArray(values, used, m_format.fixed ? N : used);
+  }
+  template <typename T> void Write(const T &value, size_t) {
+    if constexpr (std::is_same_v<T, bool>) {
+      m_out->append(value ? "true" : "false");
+    } else if constexpr (std::is_integral_v<T>) {
+      JsonWriter::AppendInteger(m_out, value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+      JsonWriter::AppendDouble(m_out, static_cast<double>(value));
+    } else {
+      write_object(*this, value);
+    }
+  }
+
+private:
+  /* The elements past count up to size are written as default values */
+  template <typename T>
+  void writeArray(const T *values, size_t count, size_t size) {
+    char separator = '[';
+    for (size_t i = 0; i < size; i++) {
+      m_out->push_back(separator);
+      separator = ',';
+      if (i < count) {
+        Write(values[i], SIZE_MAX);
+      } else {
+        static const T unused{};
+        Write(unused, SIZE_MAX);
+      }
+    }
+    m_out->append(separator == '[' ? "[]" : "]");
+  }
+
+  std::string *m_out;
+  JsonWriter::FrameFormat m_format;
+};
+
+/* The fields of the frame and of the truck the gauges tier keeps */
+const std::string_view gauge_frame_fields[] = {"configVersion", "gameTime",
+                                               "idle", "paused", "truck"};
+const std::string_view gauge_truck_fields[] = {
+    "adblue",        "cruiseControl", "displayedGear", "engine",
+    "fuel",          "hazardWarning", "leftBlinker",   "light",
+    "navigation",    "oil",           "rightBlinker",  "speed",
+    "waterTemperature"};
+
+template <size_t N>
+uint32_t gauge_group(const std::string_view (&gauges)[N],
+                     std::string_view name) {
+  return std::find(gauges, gauges + N, name) == gauges + N
+             ? FRAME_FIELDS_NON_GAUGES
+             : 0;
+}
+
+/* The groups of a field, only frames, trucks and trailers have any */
+template <typename T> uint32_t groups_of(std::string_view) { return 0; }
+template <> uint32_t groups_of<TelemetryFrame>(std::string_view name) {
+  const uint32_t groups = gauge_group(gauge_frame_fields, name);
+  return name == "trailer" ? groups | FRAME_FIELDS_TRAILERS : groups;
+}
+template <> uint32_t groups_of<TelemetryTruck>(std::string_view name) {
+  const uint32_t groups = gauge_group(gauge_truck_fields, name);
+  return name == "wheels" ? groups | FRAME_FIELDS_WHEELS : groups;
+}
+template <> uint32_t groups_of<TelemetryTrailer>(std::string_view name) {
+  return name == "wheels" ? FRAME_FIELDS_WHEELS : 0;
+}
+
+template <typename T, size_t N>
+Members<T, N> members_of(const Member<T> (&members)[N]) {
+  Members<T, N> table;
+  std::copy(members, members + N, table.declared.begin());
+  for (Member<T> &member : table.declared) {
+    member.groups = groups_of<T>(member.name);
+    member.key = JsonWriter::KeyIndex(member.name);
+  }
+  table.sorted = table.declared;
+  std::sort(table.sorted.begin(), table.sorted.end(),
+            [](const Member<T> &a, const Member<T> &b) {
+              return a.name < b.name;
+            });
+  return table;
+}
+
+template <typename T, size_t N>
+void write_members(Writer &writer, const Members<T, N> &table,
+                   const T &value, size_t count) {
+  std::string *out = writer.Out();
+  const JsonWriter::FrameFormat &format = writer.Format();
+  if (format.positional) {
+    char separator = '[';
+    for (const Member<T> &member : table.declared) {
+      out->push_back(separator);
+      separator = ',';
+      if ((member.groups & format.omit) != 0) {
+        out->append("null");
+      } else {
+        member.write(writer, value, count);
+      }
+    }
+    out->append(separator == '[' ? "[]" : "]");
+    return;
+  }
+  char separator = '{';
+  for (const Member<T> &member : table.sorted) {
+    if ((member.groups & format.omit) != 0) {
+      continue;
+    }
+    out->push_back(separator);
+    separator = ',';
+    out->push_back('"');
+    if (format.keys != nullptr && member.key < format.keys->size() &&
+        !(*format.keys)[member.key].empty()) {
+      out->append((*format.keys)[member.key]);
+    } else {
+      out->append(member.name);
+    }
+    out->append("\":");
+    member.write(writer, value, count);
+  }
+  out->append(separator == '{' ? "{}" : "}");
+}
+
+/* Walks the same field lists as telemetry_json.h */
+#define WRITER_MEMBER(field)                                                   \
+  {#field, [](Writer &to, const Type &object, size_t count) {                 \
+     to.Write(object.field, count);                                            \
+   }},
+#define WRITER_MEMBERS(...)                                                    \
+  members_of<Type>(                                                            \
+      {NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(WRITER_MEMBER, __VA_ARGS__))})
+#define WRITER_OBJECT(T, COUNT, ...)                                           \
+  template <> void write_object<T>(Writer & writer, const T &value) {          \
+    using Type = T;                                                            \
+    static const auto members = WRITER_MEMBERS(__VA_ARGS__);                   \
+    write_members(writer, members, value, COUNT);                              \
+  }
+
+WRITER_OBJECT(TelemetryVec3D, SIZE_MAX, TELEMETRY_VEC3D_FIELDS)
+WRITER_OBJECT(TelemetryOrientation, SIZE_MAX, TELEMETRY_ORIENTATION_FIELDS)
+WRITER_OBJECT(TelemetryPlacement, SIZE_MAX, TELEMETRY_PLACEMENT_FIELDS)
+WRITER_OBJECT(TelemetryWheelConfig, SIZE_MAX, TELEMETRY_WHEEL_CONFIG_FIELDS)
+WRITER_OBJECT(TelemetryWheel, SIZE_MAX, TELEMETRY_WHEEL_FIELDS)
+WRITER_OBJECT(TelemetryTruckCabin, SIZE_MAX, TELEMETRY_TRUCK_CABIN_FIELDS)
+WRITER_OBJECT(TelemetryTruckInput, SIZE_MAX, TELEMETRY_TRUCK_INPUT_FIELDS)
+WRITER_OBJECT(TelemetryTruckBrake, SIZE_MAX, TELEMETRY_TRUCK_BRAKE_FIELDS)
+WRITER_OBJECT(TelemetryTruckFuel, SIZE_MAX, TELEMETRY_TRUCK_FUEL_FIELDS)
+WRITER_OBJECT(TelemetryTruckEngine, SIZE_MAX, TELEMETRY_TRUCK_ENGINE_FIELDS)
+WRITER_OBJECT(TelemetryTruckOil, SIZE_MAX, TELEMETRY_TRUCK_OIL_FIELDS)
+WRITER_OBJECT(TelemetryTruckAdblue, SIZE_MAX, TELEMETRY_TRUCK_ADBLUE_FIELDS)
+WRITER_OBJECT(TelemetryTruckLight, SIZE_MAX, TELEMETRY_TRUCK_LIGHT_FIELDS)
+WRITER_OBJECT(TelemetryTruckWear, SIZE_MAX, TELEMETRY_TRUCK_WEAR_FIELDS)
+WRITER_OBJECT(TelemetryTruckNavigation, SIZE_MAX,
+              TELEMETRY_TRUCK_NAVIGATION_FIELDS)
+WRITER_OBJECT(TelemetryTruckConfig, SIZE_MAX, TELEMETRY_TRUCK_CONFIG_FIELDS)
+WRITER_OBJECT(TelemetryTruck, value.config.wheelCount, TELEMETRY_TRUCK_FIELDS)
+WRITER_OBJECT(TelemetryTrailerConfig, SIZE_MAX, TELEMETRY_TRAILER_CONFIG_FIELDS)
+WRITER_OBJECT(TelemetryTrailerWear, SIZE_MAX, TELEMETRY_TRAILER_WEAR_FIELDS)
+WRITER_OBJECT(TelemetryTrailer, value.config.wheelCount,
+              TELEMETRY_TRAILER_FIELDS)
+WRITER_OBJECT(TelemetryJob, SIZE_MAX, TELEMETRY_JOB_FIELDS)
+WRITER_OBJECT(TelemetryFrame, trailers_in_use(value), TELEMETRY_FRAME_FIELDS)
+
+/* All of the job but the cargo damage, as job_config_to_json has it */
+void write_job_config(Writer &writer, const TelemetryJob &value) {
+  using Type = TelemetryJob;
+  static const auto members = WRITER_MEMBERS(TELEMETRY_JOB_CONFIG_FIELDS);
+  write_members(writer, members, value, SIZE_MAX);
+}
+
+/* The wheels of vehicle_config_to_json */
+template <typename Vehicle>
+void write_wheel_configs(Writer &writer, const Vehicle &vehicle) {
+  std::string *out = writer.Out();
+  out->append(",\"wheels\":");
+  char separator = '[';
+  for (size_t i = 0; i < vehicle.config.wheelCount && i < MAX_WHEEL_COUNT;
+       i++) {
+    out->push_back(separator);
+    separator = ',';
+    writer.Write(vehicle.wheels[i].config, SIZE_MAX);
+  }
+  out->append(separator == '[' ? "[]" : "]");
+}
+
+} // namespace
+
+namespace JsonWriter {
+
+void AppendEscaped(std::string *out, std::string_view text) {
+  static const char hex[] = "0123456789abcdef";
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      out->append("\\\"");
+      break;
+    case '\\':
+      out->append("\\\\");
+      break;
+    case '\b':
+      out->append("\\b");
+      break;
+    case '\f':
+      out->append("\\f");
+      break;
+    case '\n':
+      out->append("\\n");
+      break;
+    case '\r':
+      out->append("\\r");
+      break;
+    case '\t':
+      out->append("\\t");
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        out->append("\\u00");
+        out->push_back(hex[(c >> 4) & 0xf]);
+        out->push_back(hex[c & 0xf]);
+      } else {
+        out->push_back(c);
+      }
+    }
+  }
+}
+
+void AppendString(std::string *out, std::string_view text) {
+  out->push_back('"');
+  AppendEscaped(out, text);
+  out->push_back('"');
+}
+
+void AppendDouble(std::string *out, double value) {
+  if (!std::isfinite(value)) {
+    out->append("null");
+    return;
+  }
+  char buffer[64];
+  const char *end =
+      nlohmann::detail::to_chars(buffer, buffer + sizeof(buffer), value);
+  out->append(buffer, static_cast<size_t>(end - buffer));
+}
+
+size_t KeyIndex(std::string_view name) {
+  static std::mutex mutex;
+  static std::vector<std::string_view> names;
+  std::lock_guard<std::mutex> lock(mutex);
+  const auto found = std::find(names.begin(), names.end(), name);
+  if (found != names.end()) {
+    return static_cast<size_t>(found - names.begin());
+  }
+  names.push_back(name);
+  return names.size() - 1;
+}
+
+void AppendFrame(std::string *out, const TelemetryFrame &frame,
+                 const FrameFormat &format) {
+  Writer writer(out, format);
+  write_object(writer, frame);
+}
+
+void AppendConfig(std::string *out, const TelemetryFrame &frame,
+                  TelemetryConfigBlock block, size_t index) {
+  Writer writer(out);
+  /* The keys are written in sorted order by hand */
+  switch (block) {
+  case TelemetryConfigBlock::Truck:
+    out->append("{\"block\":\"truck\",\"config\":");
+    writer.Write(frame.truck.config, SIZE_MAX);
+    break;
+  case TelemetryConfigBlock::Trailer:
+    out->append("{\"block\":\"trailer\",\"config\":");
+    writer.Write(frame.trailer[index].config, SIZE_MAX);
+    out->append(",\"index\":");
+    AppendInteger(out, index);
+    break;
+  case TelemetryConfigBlock::Job:
+    out->append("{\"block\":\"job\",\"config\":");
+    write_job_config(writer, frame.job);
+    break;
+  }
+  out->append(",\"version\":");
+  AppendInteger(out, frame.configVersion);
+  if (block == TelemetryConfigBlock::Truck) {
+    write_wheel_configs(writer, frame.truck);
+  } else if (block == TelemetryConfigBlock::Trailer) {
+    write_wheel_configs(writer, frame.trailer[index]);
+  }
+  out->push_back('}');
+}
+
+} // namespace JsonWriter
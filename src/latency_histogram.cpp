@@ -0,0 +1,172 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/* Values below LATENCY_SUB_BUCKETS get a bucket each */
+size_t bucket_of(uint64_t value) {
+  if (value < LATENCY_SUB_BUCKETS) {
+    return static_cast<size_t>(value);
+  }
+  int exponent = 63;
+  while ((value >> exponent) == 0) {
+    exponent--;
+  }
+  const int shift = exponent - LATENCY_SUB_BITS;
+  const uint64_t sub = (value >> shift) & (LATENCY_SUB_BUCKETS - 1);
+  return static_cast<size_t>(shift + 1) * LATENCY_SUB_BUCKETS +
+         static_cast<size_t>(sub);
+}
+
+void raise_max(std::atomic<uint64_t> &max, uint64_t value) {
+  uint64_t current = max.load(std::memory_order_relaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(current, value,
+                                    std::memory_order_relaxed)) {
+  }
+}
+
+/* Works on a copy of the buckets, so that every quantile sees the same */
+uint64_t percentile(const uint64_t *buckets, uint64_t count, uint64_t max,
+                    double q) {
+  if (count == 0) {
+    return 0;
+  }
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return std::min(LatencyHistogram::UpperBound(i), max);
+    }
+  }
+  return max;
+}
+
+} // namespace
+
+void LatencyHistogram::Record(int64_t nanoseconds) {
+  const uint64_t value =
+      nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0;
+  m_buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(value, std::memory_order_relaxed);
+  raise_max(m_max, value);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram &other) {
+  for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+    m_buckets[i].fetch_add(other.Bucket(i), std::memory_order_relaxed);
+  }
+  m_sum.fetch_add(other.Sum(), std::memory_order_relaxed);
+  raise_max(m_max, other.Max());
+}
+
+uint64_t LatencyHistogram::Count() const {
+  uint64_t count = 0;
+  for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+    count += Bucket(i);
+  }
+  return count;
+}
+
+double LatencyHistogram::Mean() const {
+  const uint64_t count = Count();
+  return count > 0 ? static_cast<double>(Sum()) / static_cast<double>(count)
+                   : 0.0;
+}
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+  uint64_t buckets[LATENCY_BUCKETS];
+  uint64_t count = 0;
+  for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+    buckets[i] = Bucket(i);
+    count += buckets[i];
+  }
+  return percentile(buckets, count, Max(), q);
+}
+
+uint64_t LatencyHistogram::UpperBound(size_t bucket) {
+  if (bucket < LATENCY_SUB_BUCKETS) {
+    return bucket;
+  }
+  const int shift = static_cast<int>(bucket / LATENCY_SUB_BUCKETS) - 1;
+  const uint64_t sub = bucket % LATENCY_SUB_BUCKETS;
+  if (shift + LATENCY_SUB_BITS >= 63) {
+    return UINT64_MAX;
+  }
+  return ((LATENCY_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+LatencySummary LatencyHistogram::Summarize() const {
+  uint64_t buckets[LATENCY_BUCKETS];
+  LatencySummary summary;
+  for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+    buckets[i] = Bucket(i);
+    summary.count += buckets[i];
+  }
+  summary.sum = Sum();
+  summary.max = Max();
+  summary.p50 = percentile(buckets, summary.count, summary.max, 0.5);
+  summary.p90 = percentile(buckets, summary.count, summary.max, 0.9);
+  summary.p99 = percentile(buckets, summary.count, summary.max, 0.99);
+  summary.p999 = percentile(buckets, summary.count, summary.max, 0.999);
+  return summary;
+}
+
+void LatencyHistogram::Print(FILE *out, const char *title) const {
+  const LatencySummary summary = Summarize();
+  fprintf(out,
+          "%s: %llu samples, mean %.0f ns, p50 %llu, p90 %llu, p99 %llu, "
+          "p99.9 %llu, max %llu ns\n",
+          title, static_cast<unsigned long long>(summary.count),
+          summary.count > 0 ? static_cast<double>(summary.sum) /
+                                  static_cast<double>(summary.count)
+                            : 0.0,
+          static_cast<unsigned long long>(summary.p50),
+          static_cast<unsigned long long>(summary.p90),
+          static_cast<unsigned long long>(summary.p99),
+          static_cast<unsigned long long>(summary.p999),
+          static_cast<unsigned long long>(summary.max));
+  uint64_t octaves[64] = {};
+  uint64_t largest = 0;
+  for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+    octaves[i / LATENCY_SUB_BUCKETS] += Bucket(i);
+  }
+  for (uint64_t count : octaves) {
+    largest = std::max(largest, count);
+  }
+  for (size_t octave = 0; octave < 64; octave++) {
+    if (octaves[octave] == 0) {
+      continue;
+    }
+    const int width = static_cast<int>(50 * octaves[octave] / largest);
+    fprintf(out, "  < %12llu ns %10llu %.*s\n",
+            static_cast<unsigned long long>(UpperBound(
+                octave * LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS - 1)),
+            static_cast<unsigned long long>(octaves[octave]), width,
+            "##################################################");
+  }
+}
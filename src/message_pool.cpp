@@ -0,0 +1,162 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "message_pool.h"
+#include "telemetry.h"
+
+#include <bit>
+
+namespace {
+
+/* The smallest class with room for size */
+size_t class_of_size(size_t size) {
+  const size_t shift = std::bit_width(size > 0 ? size - 1 : 0);
+  if (shift <= MESSAGE_POOL_MIN_SHIFT) {
+    return 0;
+  }
+  const size_t index = shift - MESSAGE_POOL_MIN_SHIFT;
+  return index < MESSAGE_POOL_CLASSES ? index : MESSAGE_POOL_CLASSES - 1;
+}
+
+/* The largest class the capacity covers completely */
+size_t class_of_capacity(size_t capacity) {
+  const size_t shift = std::bit_width(capacity) - 1;
+  if (shift <= MESSAGE_POOL_MIN_SHIFT) {
+    return 0;
+  }
+  const size_t index = shift - MESSAGE_POOL_MIN_SHIFT;
+  return index < MESSAGE_POOL_CLASSES ? index : MESSAGE_POOL_CLASSES - 1;
+}
+
+} // namespace
+
+MessageRef::MessageRef(MessageBuffer *buffer) noexcept : m_buffer(buffer) {
+  m_buffer->references.store(1, std::memory_order_relaxed);
+}
+
+MessageRef::MessageRef(const MessageRef &other) noexcept
+    : m_buffer(other.m_buffer) {
+  if (m_buffer != nullptr) {
+    m_buffer->references.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+MessageRef &MessageRef::operator=(const MessageRef &other) noexcept {
+  if (other.m_buffer != nullptr) {
+    other.m_buffer->references.fetch_add(1, std::memory_order_relaxed);
+  }
+  reset();
+  m_buffer = other.m_buffer;
+  return *this;
+}
+
+MessageRef &MessageRef::operator=(MessageRef &&other) noexcept {
+  if (this != &other) {
+    reset();
+    m_buffer = other.m_buffer;
+    other.m_buffer = nullptr;
+  }
+  return *this;
+}
+
+void MessageRef::KeepFrame(const TelemetryFrame &frame) const {
+  if (m_buffer->frame == nullptr) {
+    m_buffer->frame = std::make_unique<TelemetryFrame>(frame);
+  } else {
+    *m_buffer->frame = frame;
+  }
+  m_buffer->hasFrame = true;
+}
+
+void MessageRef::reset() noexcept {
+  if (m_buffer != nullptr &&
+      m_buffer->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    m_buffer->pool->release(m_buffer);
+  }
+  m_buffer = nullptr;
+}
+
+MessagePool::MessagePool() {
+  /* Releasing a buffer never allocates */
+  for (std::vector<MessageBuffer *> &buffers : m_free) {
+    buffers.reserve(MESSAGE_POOL_MAX_FREE);
+  }
+}
+
+MessagePool::~MessagePool() {
+  for (std::vector<MessageBuffer *> &buffers : m_free) {
+    for (MessageBuffer *buffer : buffers) {
+      delete buffer;
+    }
+  }
+}
+
+MessageRef MessagePool::Acquire(size_t size) {
+  const size_t first = class_of_size(size);
+  MessageBuffer *buffer = nullptr;
+  {
+    /*
+     * Only from its own class: a config that took the buffer of a frame
+     * would keep it in the replay ring for a long time, and the frames
+     * would need another one
+     */
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_free[first].empty()) {
+      buffer = m_free[first].back();
+      m_free[first].pop_back();
+      m_stats.recycled++;
+      m_stats.free--;
+    }
+    if (buffer == nullptr) {
+      m_stats.allocated++;
+    }
+  }
+  if (buffer == nullptr) {
+    buffer = new MessageBuffer;
+    buffer->pool = this;
+    buffer->data.reserve(size_t(1) << (first + MESSAGE_POOL_MIN_SHIFT));
+  }
+  /* Only beyond the largest class */
+  buffer->data.reserve(size);
+  return MessageRef(buffer);
+}
+
+MessagePoolStats MessagePool::Stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void MessagePool::release(MessageBuffer *buffer) {
+  buffer->data.clear();
+  buffer->timestamp = 0;
+  buffer->trace.Reset();
+  buffer->hasFrame = false;
+  const size_t index = class_of_capacity(buffer->data.capacity());
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_free[index].size() < MESSAGE_POOL_MAX_FREE) {
+      m_free[index].push_back(buffer);
+      m_stats.free++;
+      return;
+    }
+    m_stats.freed++;
+  }
+  delete buffer;
+}
@@ -0,0 +1,200 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "metrics.h"
+#include "allocation_stats.h"
+
+#include <cstdio>
+
+namespace {
+
+PipelineMetrics pipeline;
+
+const char *message_name(size_t message) {
+  static const char *const names[METRIC_MESSAGE_COUNT] = {"frame", "config",
+                                                          "gameplay"};
+  return names[message];
+}
+
+const char *callback_name(size_t callback) {
+  static const char *const names[METRIC_CALLBACK_COUNT] = {
+      "frame_start", "frame_end", "configuration", "gameplay"};
+  return names[callback];
+}
+
+std::string label(const char *name, const char *value) {
+  return std::string(name).append("=\"").append(value).append("\"");
+}
+
+} // namespace
+
+void PrometheusWriter::Describe(const char *name, const char *type,
+                                const char *help) {
+  m_out->append("# HELP ").append(name).append(" ").append(help);
+  m_out->append("\n# TYPE ").append(name).append(" ").append(type);
+  m_out->push_back('\n');
+}
+
+void PrometheusWriter::begin(const char *name, const char *suffix,
+                             std::string_view labels, std::string_view extra) {
+  m_out->append(name).append(suffix);
+  if (!labels.empty() || !extra.empty()) {
+    m_out->push_back('{');
+    m_out->append(labels);
+    if (!labels.empty() && !extra.empty()) {
+      m_out->push_back(',');
+    }
+    m_out->append(extra).push_back('}');
+  }
+  m_out->push_back(' ');
+}
+
+void PrometheusWriter::Sample(const char *name, std::string_view labels,
+                              uint64_t value) {
+  begin(name, "", labels, std::string_view());
+  m_out->append(std::to_string(value)).push_back('\n');
+}
+
+void PrometheusWriter::Sample(const char *name, std::string_view labels,
+                              double value) {
+  char text[32];
+  snprintf(text, sizeof(text), "%.9g", value);
+  begin(name, "", labels, std::string_view());
+  m_out->append(text).push_back('\n');
+}
+
+void PrometheusWriter::Histogram(const char *name, std::string_view labels,
+                                 const LatencyHistogram &histogram) {
+  /* The buckets of the latency histogram add up to octaves exactly */
+  uint64_t cumulative = 0;
+  size_t bucket = 0;
+  char le[32];
+  for (int octave = METRICS_FIRST_OCTAVE; octave <= METRICS_LAST_OCTAVE;
+       octave++) {
+    const uint64_t bound = uint64_t(1) << octave;
+    for (; bucket < LATENCY_BUCKETS &&
+           LatencyHistogram::UpperBound(bucket) < bound;
+         bucket++) {
+      cumulative += histogram.Bucket(bucket);
+    }
+    snprintf(le, sizeof(le), "le=\"%.9g\"", static_cast<double>(bound) / 1e9);
+    begin(name, "_bucket", labels, le);
+    m_out->append(std::to_string(cumulative)).push_back('\n');
+  }
+  for (; bucket < LATENCY_BUCKETS; bucket++) {
+    cumulative += histogram.Bucket(bucket);
+  }
+  begin(name, "_bucket", labels, "le=\"+Inf\"");
+  m_out->append(std::to_string(cumulative)).push_back('\n');
+  begin(name, "_sum", labels, std::string_view());
+  snprintf(le, sizeof(le), "%.9g", static_cast<double>(histogram.Sum()) / 1e9);
+  m_out->append(le).push_back('\n');
+  /* The count of the buckets, a sample may be in flight */
+  begin(name, "_count", labels, std::string_view());
+  m_out->append(std::to_string(cumulative)).push_back('\n');
+}
+
+PipelineMetrics &Metrics::Pipeline() { return pipeline; }
+
+void Metrics::CountMessage(MetricMessage message, size_t bytes,
+                           int64_t encodeStart, int64_t encodeEnd) {
+  const size_t index = static_cast<size_t>(message);
+  pipeline.messages[index].Add();
+  pipeline.encodedBytes[index].Add(bytes);
+  pipeline.encode[index].Record(encodeEnd - encodeStart);
+}
+
+void Metrics::Render(PrometheusWriter *writer) {
+  writer->Describe("tsts_frames_total", "counter",
+                   "Frames the scheduler emitted or held back");
+  writer->Sample("tsts_frames_total", "result=\"emitted\"",
+                 pipeline.framesEmitted.Value());
+  writer->Sample("tsts_frames_total", "result=\"suppressed\"",
+                 pipeline.framesSuppressed.Value());
+  writer->Describe("tsts_messages_total", "counter",
+                   "Messages encoded by the game thread");
+  for (size_t i = 0; i < METRIC_MESSAGE_COUNT; i++) {
+    writer->Sample("tsts_messages_total", label("type", message_name(i)),
+                   pipeline.messages[i].Value());
+  }
+  writer->Describe("tsts_encoded_bytes_total", "counter",
+                   "Bytes of the encoded messages");
+  for (size_t i = 0; i < METRIC_MESSAGE_COUNT; i++) {
+    writer->Sample("tsts_encoded_bytes_total", label("type", message_name(i)),
+                   pipeline.encodedBytes[i].Value());
+  }
+  writer->Describe("tsts_encode_seconds", "histogram",
+                   "Time spent encoding a message");
+  for (size_t i = 0; i < METRIC_MESSAGE_COUNT; i++) {
+    writer->Histogram("tsts_encode_seconds", label("type", message_name(i)),
+                      pipeline.encode[i]);
+  }
+  writer->Describe("tsts_callback_seconds", "histogram",
+                   "Time spent in the SDK callbacks of the game thread");
+  for (size_t i = 0; i < METRIC_CALLBACK_COUNT; i++) {
+    writer->Histogram("tsts_callback_seconds",
+                      label("callback", callback_name(i)),
+                      pipeline.callbacks[i]);
+  }
+  writer->Describe("tsts_frame_stage_seconds", "histogram",
+                   "Time a frame took to reach a point of the pipeline "
+                   "from the one before it");
+  for (size_t point = 1; point < TRACE_POINT_COUNT; point++) {
+    const TracePoint stage = static_cast<TracePoint>(point);
+    writer->Histogram("tsts_frame_stage_seconds",
+                      label("stage", FrameTracing::PointName(stage)),
+                      FrameTracing::Stage(stage));
+  }
+  writer->Describe("tsts_frame_latency_seconds", "histogram",
+                   "Time from frame_end until the last subscriber's socket "
+                   "took the frame");
+  writer->Histogram("tsts_frame_latency_seconds", std::string_view(),
+                    FrameTracing::Stage(TracePoint::FrameEnd));
+  if (!AllocationStats::Enabled()) {
+    return;
+  }
+  AllocationThreadStats threads[ALLOCATION_MAX_THREADS];
+  const size_t count = AllocationStats::Collect(threads);
+  const char *const names[] = {"tsts_allocations_total",
+                               "tsts_allocated_bytes_total",
+                               "tsts_frees_total"};
+  const char *const helps[] = {"Heap allocations of the plugin",
+                               "Bytes allocated on the heap by the plugin",
+                               "Heap blocks freed by the plugin"};
+  for (size_t metric = 0; metric < 3; metric++) {
+    writer->Describe(names[metric], "counter", helps[metric]);
+    for (size_t i = 0; i < count; i++) {
+      const std::string thread =
+          threads[i].name != nullptr ? threads[i].name
+                                     : "thread." + std::to_string(i);
+      for (size_t stage = 0; stage < ALLOCATION_STAGE_COUNT; stage++) {
+        const AllocationCounter &counter = threads[i].stages[stage];
+        const uint64_t values[] = {counter.allocations, counter.bytes,
+                                   counter.frees};
+        writer->Sample(
+            names[metric],
+            label("thread", thread.c_str()) + "," +
+                label("stage", AllocationStats::StageName(
+                                   static_cast<AllocationStage>(stage))),
+            values[metric]);
+      }
+    }
+  }
+}
@@ -20,9 +20,18 @@ If not, see <https://www.gnu.org/licenses/>.
 
 
 #include "network_handler.h"
+#include "allocation_stats.h"
+#include "udp_publisher.h"
+#include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <string.h>
 #include <algorithm>
+#include <climits>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
 
 
 /*
@@ -30,7 +39,60 @@ If not, see <https://www.gnu.org/licenses/>.
  */
 NetworkHandler* NetworkHandler::m_instance = nullptr;
 
-NetworkHandler::NetworkHandler(EventQueue* eventQueue){
+/*
+ * Subscriber sockets never block the event loop, see sendMessage
+ */
+static bool setNonBlocking(SOCKET socket){
+    #ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(socket,FIONBIO,&mode) == 0;
+    #else
+    int flags = fcntl(socket,F_GETFL,0);
+    return flags != -1 && fcntl(socket,F_SETFL,flags | O_NONBLOCK) != -1;
+    #endif
+}
+
+#ifndef _WIN32
+/*
+ * A socket file left behind by a crashed game would make bind fail.
+ * Removes it if nobody listens on it any more, returns false if the path
+ * is anything else or another instance is still serving it.
+ */
+static bool removeStaleSocket(const struct sockaddr_un& address,int type){
+    struct stat status;
+    if(lstat(address.sun_path,&status) != 0){
+        return errno == ENOENT;
+    }
+    if(!S_ISSOCK(status.st_mode)){
+        return false;
+    }
+    SOCKET probe = socket(AF_UNIX,type,0);
+    if(probe == INVALID_SOCKET){
+        return false;
+    }
+    /* A listener with a full backlog must not block the game */
+    setNonBlocking(probe);
+    const bool refused = connect(probe,reinterpret_cast<const struct sockaddr*>(&address),sizeof(address)) < 0 &&
+                         errno == ECONNREFUSED;
+    CLOSE_SOCKET(probe);
+    return refused && unlink(address.sun_path) == 0;
+}
+#endif
+
+static bool wouldBlock(){
+    #ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+    #else
+    #if EWOULDBLOCK != EAGAIN
+    if(errno == EWOULDBLOCK){
+        return true;
+    }
+    #endif
+    return errno == EAGAIN;
+    #endif
+}
+
+NetworkHandler::NetworkHandler(EventQueue* eventQueue,const PluginOptions& options){
     #ifdef _WIN32
     if(WSAStartup(MAKEWORD(2,2),&m_wsaData) != 0){
         throw std::runtime_error("Windows Sockets failed to initialize!");
@@ -40,10 +102,9 @@ NetworkHandler::NetworkHandler(EventQueue* eventQueue){
         throw std::runtime_error("Nonexistent event queue!");
     }
     m_eventQueue = eventQueue;
+    m_replay.EmbedTraces(options.trace);
     memset(&address,0,sizeof(sockaddr));
     m_port = PORT;
-    m_send_timeout.tv_usec = 0;
-    m_send_timeout.tv_sec = TIMEOUT_SEND_SEC;
     m_select_timeout.tv_sec = 0;
     m_select_timeout.tv_usec = 0;
     address.sin_family = AF_INET;
@@ -57,6 +118,10 @@ NetworkHandler::NetworkHandler(EventQueue* eventQueue){
     if(lastError < 0){
         throw std::runtime_error("Unable to set socket options!");
     }
+    #ifndef _WIN32
+    /* Connections of the last load may still linger in TIME_WAIT */
+    setsockopt(m_topSocket,SOL_SOCKET,SO_REUSEADDR,reinterpret_cast<char*>(&flag),sizeof(int));
+    #endif
     lastError = bind(m_topSocket,reinterpret_cast<struct sockaddr*>(&address),sizeof(address));
     if(lastError < 0){
         throw std::runtime_error("Unable to bind to address!");
@@ -65,121 +130,1275 @@ NetworkHandler::NetworkHandler(EventQueue* eventQueue){
     if(lastError < 0){
         throw std::runtime_error("Unable to listen on socket!");
     }
+    m_unixSocketPath = options.unixSocketPath;
+    m_qosRates[static_cast<size_t>(QosClass::Realtime)] = options.realtimeRate;
+    m_qosRates[static_cast<size_t>(QosClass::Reliable)] = options.reliableRate;
+    m_qosRates[static_cast<size_t>(QosClass::BestEffort)] = options.bestEffortRate;
+    try{
+        if(!m_unixSocketPath.empty()){
+            openUnixSocket();
+        }
+        if(options.httpPort > 0){
+            m_httpSocket = openHttpSocket(options.httpPort);
+        }
+        /* The HTTP port answers GET /metrics as well */
+        if(options.metricsPort > 0 && options.metricsPort != options.httpPort){
+            m_metricsSocket = openHttpSocket(options.metricsPort);
+        }
+        if(!options.udpTarget.empty()){
+            m_udpPublisher = new UdpPublisher(options.udpTarget,options.udpRedundancy);
+        }
+    }
+    catch(...){
+        CLOSE_SOCKET(m_topSocket);
+        if(m_unixSocket != INVALID_SOCKET){
+            CLOSE_SOCKET(m_unixSocket);
+        }
+        if(m_httpSocket != INVALID_SOCKET){
+            CLOSE_SOCKET(m_httpSocket);
+        }
+        if(m_metricsSocket != INVALID_SOCKET){
+            CLOSE_SOCKET(m_metricsSocket);
+        }
+        throw;
+    }
+}
+
+SOCKET NetworkHandler::openHttpSocket(int port){
+    struct sockaddr_in httpAddress;
+    memset(&httpAddress,0,sizeof(httpAddress));
+    httpAddress.sin_family = AF_INET;
+    httpAddress.sin_port = htons(static_cast<u_short>(port));
+    httpAddress.sin_addr.s_addr = INADDR_ANY;
+    SOCKET httpSocket = socket(AF_INET,SOCK_STREAM,0);
+    if(httpSocket == INVALID_SOCKET){
+        throw std::runtime_error("Unable to create HTTP socket!");
+    }
+    int flag = 1;
+    #ifndef _WIN32
+    /* HTTP clients leave the port in TIME_WAIT, don't block a restart on it */
+    setsockopt(httpSocket,SOL_SOCKET,SO_REUSEADDR,reinterpret_cast<char*>(&flag),sizeof(int));
+    #endif
+    if(setsockopt(httpSocket,IPPROTO_TCP,TCP_NODELAY,
+                  reinterpret_cast<char*>(&flag),sizeof(int)) < 0 ||
+       bind(httpSocket,reinterpret_cast<struct sockaddr*>(&httpAddress),sizeof(httpAddress)) < 0 ||
+       listen(httpSocket,MAX_CLIENTS) < 0){
+        CLOSE_SOCKET(httpSocket);
+        throw std::runtime_error("Unable to listen on the HTTP port!");
+    }
+    return httpSocket;
+}
+
+void NetworkHandler::openUnixSocket(){
+    #ifdef _WIN32
+    throw std::runtime_error("Unix domain sockets are not supported on this platform!");
+    #else
+    struct sockaddr_un unixAddress;
+    memset(&unixAddress,0,sizeof(unixAddress));
+    unixAddress.sun_family = AF_UNIX;
+    if(m_unixSocketPath.size() >= sizeof(unixAddress.sun_path)){
+        throw std::runtime_error("Unix domain socket path is too long!");
+    }
+    memcpy(unixAddress.sun_path,m_unixSocketPath.c_str(),m_unixSocketPath.size());
+    int type = SOCK_STREAM;
+    #ifdef SOCK_SEQPACKET
+    m_unixSocket = socket(AF_UNIX,SOCK_SEQPACKET,0);
+    m_unixTransport = Transport::UnixSeqPacket;
+    type = SOCK_SEQPACKET;
+    #endif
+    if(m_unixSocket == INVALID_SOCKET){
+        m_unixSocket = socket(AF_UNIX,SOCK_STREAM,0);
+        m_unixTransport = Transport::UnixStream;
+        type = SOCK_STREAM;
+    }
+    if(m_unixSocket == INVALID_SOCKET){
+        throw std::runtime_error("Unable to create Unix domain socket!");
+    }
+    if(!removeStaleSocket(unixAddress,type)){
+        CLOSE_SOCKET(m_unixSocket);
+        m_unixSocket = INVALID_SOCKET;
+        throw std::runtime_error("Unix domain socket path is in use or not a socket!");
+    }
+    if(bind(m_unixSocket,reinterpret_cast<struct sockaddr*>(&unixAddress),sizeof(unixAddress)) < 0 ||
+       listen(m_unixSocket,MAX_CLIENTS) < 0){
+        CLOSE_SOCKET(m_unixSocket);
+        m_unixSocket = INVALID_SOCKET;
+        throw std::runtime_error("Unable to listen on Unix domain socket!");
+    }
+    #endif
 }
 
-std::jthread* NetworkHandler::GetEventThread(EventQueue* eventQueue){
+std::jthread* NetworkHandler::GetEventThread(EventQueue* eventQueue,const PluginOptions& options){
     if(m_instance == nullptr){
-        m_instance = new NetworkHandler(eventQueue);
+        m_instance = new NetworkHandler(eventQueue,options);
     }
     return new std::jthread([](std::stop_token st){m_instance->EventLoop(st);});
 }
 
-int NetworkHandler::sendMessage(SOCKET socket,const char* msg,ssize_t size){
-    // ssize_t sent = send(socket,msg,size,0);
-    auto sent = send(socket, msg, static_cast<int>(size), 0);
-    if(sent != -1){
-        while(sent < size){
-            ssize_t remainder = size-sent;
-            ssize_t sentNext = send(socket,msg+sent,remainder,0);
-            if(sentNext != -1){
-                sent += sentNext;
+/*
+ * Sends what the socket and the rate limit take right away and queues the
+ * rest, so a slow subscriber only holds up itself. Packets are queued
+ * whole. Frames go to their own lane, which realtime and best effort
+ * subscribers keep down to the latest frame.
+ */
+int NetworkHandler::sendMessage(Subscriber& subscriber,const char* msg,size_t size,bool frame,MessageRef* shared){
+    const auto now = std::chrono::steady_clock::now();
+    frame = frame && canReorder(subscriber);
+    OutboxLane& lane = frame ? subscriber.frameOutbox : subscriber.outbox;
+    const int64_t origin = m_trace != nullptr ? m_trace->At(TracePoint::FrameEnd) : 0;
+    if(subscriber.outbox.empty() && subscriber.frameOutbox.empty()){
+        subscriber.lastProgress = now;
+        if(subscriber.bucket.Ready(now)){
+            subscriber.bucket.Take(size);
+            size_t sent = 0;
+            while(sent < size){
+                auto result = send(subscriber.socket,msg + sent,static_cast<int>(size - sent),0);
+                if(result == -1){
+                    if(!wouldBlock()){
+                        return -1;
+                    }
+                    break;
+                }
+                countSent(subscriber,static_cast<size_t>(result));
+                if(subscriber.transport == Transport::UnixSeqPacket){
+                    if(static_cast<size_t>(result) != size){
+                        return -1;
+                    }
+                    traceWrite(subscriber,origin);
+                    return 0;
+                }
+                sent += static_cast<size_t>(result);
+            }
+            if(sent == size){
+                traceWrite(subscriber,origin);
+                return 0;
+            }
+            /* Paid for, the rest goes out before anything else */
+            subscriber.inFlight = true;
+            subscriber.frameInFlight = frame;
+            subscriber.outboxOffset = sent;
+        }
+    }
+    else if(frame && subscriber.qos != QosClass::Reliable){
+        /* Behind already, only the latest frame is worth sending */
+        const size_t keep = subscriber.inFlight && subscriber.frameInFlight ? 1 : 0;
+        while(lane.size() > keep){
+            subscriber.outboxSize -= lane.back().size;
+            lane.pop_back();
+            m_droppedFrames[static_cast<size_t>(subscriber.qos)].Add();
+        }
+    }
+    MessageRef copy;
+    if(shared == nullptr){
+        shared = &copy;
+    }
+    if(!*shared){
+        *shared = m_sendPool.Acquire(size);
+        (*shared)->assign(msg,size);
+    }
+    lane.push_back({*shared,size,origin});
+    subscriber.outboxSize += size;
+    const size_t limit = subscriber.qos == QosClass::Reliable ? QOS_RELIABLE_MAX_BACKLOG : SUBSCRIBER_MAX_BACKLOG;
+    return subscriber.outboxSize > limit ? -1 : 0;
+}
+
+int NetworkHandler::sendMessage(Subscriber& subscriber,MessageRef& message,size_t size,bool frame){
+    return sendMessage(subscriber,message->data(),size,frame,&message);
+}
+
+/*
+ * Called when the socket is writable, returns false if it's dead
+ */
+bool NetworkHandler::flushOutbox(Subscriber& subscriber){
+    const auto now = std::chrono::steady_clock::now();
+    for(;;){
+        if(!subscriber.inFlight){
+            if(subscriber.outbox.empty() && subscriber.frameOutbox.empty()){
+                return true;
+            }
+            if(!subscriber.bucket.Ready(now)){
+                return true;
+            }
+            subscriber.frameInFlight = subscriber.outbox.empty();
+            subscriber.inFlight = true;
+            subscriber.bucket.Take(subscriber.frameInFlight ? subscriber.frameOutbox.front().size :
+                                                              subscriber.outbox.front().size);
+        }
+        OutboxLane& lane = subscriber.frameInFlight ? subscriber.frameOutbox : subscriber.outbox;
+        const OutboxMessage& message = lane.front();
+        auto result = send(subscriber.socket,message.data->data() + subscriber.outboxOffset,
+                           static_cast<int>(message.size - subscriber.outboxOffset),0);
+        if(result == -1){
+            return wouldBlock();
+        }
+        subscriber.lastProgress = now;
+        countSent(subscriber,static_cast<size_t>(result));
+        subscriber.outboxOffset += static_cast<size_t>(result);
+        if(subscriber.outboxOffset < message.size){
+            if(subscriber.transport == Transport::UnixSeqPacket){
+                return false;
+            }
+            continue;
+        }
+        subscriber.outboxSize -= message.size;
+        subscriber.outboxOffset = 0;
+        subscriber.inFlight = false;
+        traceWrite(subscriber,lane.front().origin);
+        lane.pop_front();
+    }
+}
+
+void NetworkHandler::countSent(const Subscriber& subscriber,size_t bytes){
+    const size_t format = static_cast<size_t>(subscriber.dialect) * COMPRESSION_COUNT + static_cast<size_t>(subscriber.compression);
+    m_sentBytes[static_cast<size_t>(subscriber.transport) * DIALECT_COUNT * COMPRESSION_COUNT + format].Add(bytes);
+}
+
+DisconnectReason NetworkHandler::failureOf(const Subscriber& subscriber){
+    const size_t limit = subscriber.qos == QosClass::Reliable ? QOS_RELIABLE_MAX_BACKLOG : SUBSCRIBER_MAX_BACKLOG;
+    return subscriber.outboxSize > limit ? DisconnectReason::Backlog : DisconnectReason::Error;
+}
+
+void NetworkHandler::disconnect(Subscriber& subscriber,DisconnectReason reason,std::vector<SOCKET>* deadSockets){
+    CLOSE_SOCKET(subscriber.socket);
+    deadSockets->push_back(subscriber.socket);
+    m_disconnects[static_cast<size_t>(reason)].Add();
+}
+
+/*
+ * The socket took the whole frame. Frames that had to wait in the outbox
+ * only count towards the latency of their subscriber.
+ */
+void NetworkHandler::traceWrite(Subscriber& subscriber,int64_t origin){
+    if(origin == 0){
+        return;
+    }
+    const int64_t now = message_clock_ns();
+    subscriber.latency->Record(now - origin);
+    if(m_trace != nullptr){
+        if(m_trace->At(TracePoint::FirstWrite) == 0){
+            m_trace->points[static_cast<size_t>(TracePoint::FirstWrite)] = now;
+        }
+        m_trace->points[static_cast<size_t>(TracePoint::LastWrite)] = now;
+    }
+}
+
+/*
+ * Messages may overtake each other unless one depends on the last
+ */
+bool NetworkHandler::canReorder(const Subscriber& subscriber){
+    return subscriber.compression == Compression::None &&
+           (subscriber.deflater == nullptr || !subscriber.deflater->KeepsContext());
+}
+
+void NetworkHandler::setQos(Subscriber& subscriber,QosClass qos){
+    subscriber.qos = qos;
+    subscriber.bucket.SetRate(static_cast<uint32_t>(m_qosRates[static_cast<size_t>(qos)]));
+    #ifdef TCP_NOTSENT_LOWAT
+    /* Frames the kernel holds can't be skipped any more, keep them here */
+    if(subscriber.transport != Transport::UnixSeqPacket && subscriber.transport != Transport::UnixStream){
+        int unsent = qos == QosClass::Reliable ? INT_MAX : QOS_UNSENT_LIMIT;
+        setsockopt(subscriber.socket,IPPROTO_TCP,TCP_NOTSENT_LOWAT,
+                   reinterpret_cast<char*>(&unsent),sizeof(unsent));
+    }
+    #endif
+}
+
+/*
+ * Clients pick their dialect, tier, compression and where to resume right
+ * after connecting, the bundle waits for that. A resume sends it at once.
+ */
+void NetworkHandler::deferBootstrap(Subscriber& subscriber){
+    subscriber.bootstrapPending = true;
+    subscriber.bootstrapAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(BOOTSTRAP_WAIT_MS);
+}
+
+/*
+ * Brings a new subscriber up to date with the snapshot bundle. Stream
+ * transports get it framed once per bundle, however many join at a time.
+ * Compact dialects get the keyframe as encoded for the current frame, or
+ * go without it until the next one if it wasn't kept for encoding. A
+ * resumed subscriber has the events already and only gets the snapshot
+ * message and the frame.
+ */
+int NetworkHandler::sendBootstrap(Subscriber& subscriber){
+    if(subscriber.transport == Transport::HttpPending){
+        return 0;
+    }
+    const std::vector<SnapshotMessage>& bundle = m_snapshot.Bundle();
+    subscriber.bootstrapPending = false;
+    subscriber.joinedAt = m_replay.Sequence();
+    if(subscriber.compression != Compression::None){
+        /* The stream may have gone on while it waited */
+        joinCompressionGroup(subscriber);
+    }
+    if(subscriber.transport == Transport::UnixSeqPacket || subscriber.deflater != nullptr || subscriber.resumed ||
+       subscriber.compression != Compression::None || subscriber.dialect != FrameDialect::Standard){
+        for(const SnapshotMessage& message : bundle){
+            if(subscriber.resumed && strcmp(message.type,EVENT_FRAME) != 0 && strcmp(message.type,EVENT_SNAPSHOT) != 0){
+                continue;
+            }
+            const std::string* event = message.event;
+            if(subscriber.dialect != FrameDialect::Standard && strcmp(message.type,EVENT_FRAME) == 0){
+                const MessageRef& current = m_frameTiers.Message();
+                event = current && message.event == &*current ?
+                        m_frameDialects.Get(LodTier::Full,subscriber.dialect) : nullptr;
+                if(event == nullptr){
+                    continue;
+                }
+            }
+            if(sendPrivate(subscriber,*event,message.type) == -1){
+                return -1;
+            }
+        }
+        return 0;
+    }
+    if(m_bootstrapVersion != m_snapshot.Version()){
+        for(MessageRef& messages : m_bootstrapMessages){
+            messages.reset();
+        }
+        m_bootstrapVersion = m_snapshot.Version();
+    }
+    MessageRef& messages = m_bootstrapMessages[static_cast<size_t>(subscriber.transport)];
+    if(!messages){
+        messages = m_sendPool.Acquire(0);
+        for(const SnapshotMessage& message : bundle){
+            if(subscriber.transport == Transport::WebSocket){
+                WebSocket::AppendHeader(&*messages,WEBSOCKET_TEXT,message.event->size(),false);
+                messages->append(*message.event);
+            }
+            else if(subscriber.transport == Transport::EventStream){
+                HttpApi::AppendStreamEvent(&*messages,message.type,*message.event);
             }
             else{
+                messages->append(*message.event);
+                messages->push_back('\0');
+            }
+        }
+    }
+    if(subscriber.transport == Transport::EventStream){
+        subscriber.nextFrame = std::chrono::steady_clock::now() + subscriber.interval;
+    }
+    return messages->empty() ? 0 : sendMessage(subscriber,messages,messages->size());
+}
+
+void NetworkHandler::sendDueBootstraps(){
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<SOCKET> deadSockets;
+    for(Subscriber& subscriber : m_subscribers){
+        if(subscriber.bootstrapPending && now >= subscriber.bootstrapAt && sendBootstrap(subscriber) == -1){
+            disconnect(subscriber,failureOf(subscriber),&deadSockets);
+        }
+    }
+    for(SOCKET s : deadSockets){
+        m_subscribers.remove_if([s](const Subscriber& subscriber){return subscriber.socket == s;});
+    }
+}
+
+int NetworkHandler::sendEvent(Subscriber& subscriber,const std::string& event,const std::string& type){
+    /* The bundle covers what a subscriber misses while it waits for it */
+    if(subscriber.transport == Transport::HttpPending || subscriber.bootstrapPending){
+        return 0;
+    }
+    const bool frame = type == EVENT_FRAME;
+    if(frame && !m_tierDue[static_cast<size_t>(subscriber.tier)]){
+        return 0;
+    }
+    /* Gameplay events and config are the same in every dialect and tier */
+    const size_t slot = frame ? static_cast<size_t>(subscriber.dialect) * LOD_TIER_COUNT + static_cast<size_t>(subscriber.tier) : 0;
+    const std::string* encoded = slot == 0 ? &event : m_frameDialects.Get(subscriber.tier,subscriber.dialect);
+    /* The game keeps the frame for other encodings once someone reads them */
+    if(encoded == nullptr){
+        return 0;
+    }
+    const std::string& message = *encoded;
+    if(subscriber.compression != Compression::None){
+        return sendCompressed(subscriber,message);
+    }
+    if(subscriber.transport == Transport::EventStream){
+        if(frame && subscriber.interval.count() > 0){
+            auto now = std::chrono::steady_clock::now();
+            if(now < subscriber.nextFrame){
+                return 0;
+            }
+            subscriber.nextFrame = now + subscriber.interval;
+        }
+        MessageRef& framed = m_eventStreamMessage[slot];
+        if(!framed){
+            /* Room for the event and data lines around it */
+            framed = m_sendPool.Acquire(message.size() + 32);
+            HttpApi::AppendStreamEvent(&*framed,type,message);
+        }
+        return sendMessage(subscriber,framed,framed->size(),frame);
+    }
+    if(subscriber.transport == Transport::WebSocket){
+        if(subscriber.deflater != nullptr){
+            /* The window is per connection, so is the compressed message */
+            if(!subscriber.deflater->Compress(message,&m_compressedMessage)){
+                return -1;
+            }
+            std::string header;
+            WebSocket::AppendHeader(&header,WEBSOCKET_TEXT,m_compressedMessage.size(),true);
+            m_compressedMessage.insert(0,header);
+            return sendMessage(subscriber,m_compressedMessage.c_str(),m_compressedMessage.size(),frame);
+        }
+        MessageRef& framed = m_webSocketMessage[slot];
+        if(!framed){
+            framed = m_sendPool.Acquire(message.size() + 10);
+            WebSocket::AppendHeader(&*framed,WEBSOCKET_TEXT,message.size(),false);
+            framed->append(message);
+        }
+        return sendMessage(subscriber,framed,framed->size(),frame);
+    }
+    if(subscriber.transport == Transport::UnixSeqPacket){
+        /* An empty packet would read as end of file on the other side */
+        if(message.empty()){
+            return 0;
+        }
+        return sendMessage(subscriber,message.c_str(),message.size(),frame,&m_plainMessage[slot]);
+    }
+    /* Stream transports separate events by their NUL terminator */
+    return sendMessage(subscriber,message.c_str(),message.size() + 1,frame,&m_plainMessage[slot]);
+}
+
+/*
+ * A message only this subscriber gets, framed without the caches of the
+ * current event. Compressed subscribers get it uncompressed, marked with
+ * COMPRESSION_FLAG_RAW, so their shared stream stays intact.
+ */
+int NetworkHandler::sendPrivate(Subscriber& subscriber,const std::string& message,const char* type){
+    std::string& framed = m_privateMessage;
+    framed.clear();
+    if(subscriber.compression != Compression::None){
+        framed.push_back(static_cast<char>(COMPRESSION_FLAG_RAW));
+        framed.append(message);
+        appendCompressedFraming(subscriber,&framed);
+        return sendMessage(subscriber,framed.c_str(),framed.size());
+    }
+    switch(subscriber.transport){
+    case Transport::HttpPending:
+        return 0;
+    case Transport::EventStream:
+        HttpApi::AppendStreamEvent(&framed,type,message);
+        break;
+    case Transport::WebSocket:
+        if(subscriber.deflater != nullptr){
+            if(!subscriber.deflater->Compress(message,&m_compressedMessage)){
                 return -1;
             }
+            WebSocket::AppendHeader(&framed,WEBSOCKET_TEXT,m_compressedMessage.size(),true);
+            framed.append(m_compressedMessage);
+        }
+        else{
+            WebSocket::AppendHeader(&framed,WEBSOCKET_TEXT,message.size(),false);
+            framed.append(message);
+        }
+        break;
+    case Transport::UnixSeqPacket:
+        return message.empty() ? 0 : sendMessage(subscriber,message.c_str(),message.size());
+    default:
+        return sendMessage(subscriber,message.c_str(),message.size() + 1);
+    }
+    return sendMessage(subscriber,framed.c_str(),framed.size());
+}
+
+CompressionGroup& NetworkHandler::compressionGroup(Compression compression,FrameDialect dialect,LodTier tier){
+    const size_t stream = static_cast<size_t>(compression) * DIALECT_COUNT + static_cast<size_t>(dialect);
+    return m_compressionGroups[stream * LOD_TIER_COUNT + static_cast<size_t>(tier)];
+}
+
+/*
+ * Moves a compressed subscriber to the stream of its dialect and tier, it
+ * picks it up at its next start
+ */
+void NetworkHandler::joinCompressionGroup(Subscriber& subscriber){
+    CompressionGroup& group = compressionGroup(subscriber.compression,subscriber.dialect,subscriber.tier);
+    if(group.compressor == nullptr){
+        group.compressor = MessageCompressor::Create(subscriber.compression);
+    }
+    group.resetPending = true;
+    subscriber.synced = false;
+}
+
+/*
+ * Compressed messages are framed by length, they may contain NUL. Puts
+ * the framing of the transport around message.
+ */
+void NetworkHandler::appendCompressedFraming(const Subscriber& subscriber,std::string* message){
+    if(subscriber.transport == Transport::WebSocket){
+        std::string header;
+        WebSocket::AppendHeader(&header,WEBSOCKET_BINARY,message->size(),false);
+        message->insert(0,header);
+    }
+    else if(subscriber.transport != Transport::UnixSeqPacket){
+        const uint32_t size = static_cast<uint32_t>(message->size());
+        const char length[4] = {static_cast<char>(size >> 24),static_cast<char>(size >> 16),
+                                static_cast<char>(size >> 8),static_cast<char>(size)};
+        message->insert(0,length,sizeof(length));
+    }
+}
+
+int NetworkHandler::sendCompressed(Subscriber& subscriber,const std::string& event){
+    CompressionGroup& group = compressionGroup(subscriber.compression,subscriber.dialect,subscriber.tier);
+    if(!group.ready){
+        group.message = m_sendPool.Acquire(group.compressor->Bound(event.size()));
+        if(!group.compressor->Compress(event,group.resetPending,&*group.message)){
+            return -1;
+        }
+        group.resetPending = false;
+        group.ready = true;
+    }
+    if(!subscriber.synced){
+        if(!((*group.message)[0] & COMPRESSION_FLAG_RESET)){
+            return 0;
+        }
+        subscriber.synced = true;
+    }
+    /* The framing takes up to 10 bytes of WebSocket header or a 4 byte length */
+    MessageRef* message = &group.message;
+    if(subscriber.transport == Transport::WebSocket){
+        if(!group.webSocketMessage){
+            group.webSocketMessage = m_sendPool.Acquire(group.message->size() + 10);
+            group.webSocketMessage->assign(*group.message);
+            appendCompressedFraming(subscriber,&*group.webSocketMessage);
+        }
+        message = &group.webSocketMessage;
+    }
+    else if(subscriber.transport != Transport::UnixSeqPacket){
+        if(!group.streamMessage){
+            group.streamMessage = m_sendPool.Acquire(group.message->size() + 4);
+            group.streamMessage->assign(*group.message);
+            appendCompressedFraming(subscriber,&*group.streamMessage);
         }
+        message = &group.streamMessage;
+    }
+    return sendMessage(subscriber,*message,(*message)->size());
+}
+
+/*
+ * The caches hold one event, drop them before sending another one
+ */
+void NetworkHandler::clearMessageCaches(){
+    for(size_t slot = 0; slot < DIALECT_COUNT * LOD_TIER_COUNT; slot++){
+        m_webSocketMessage[slot].reset();
+        m_eventStreamMessage[slot].reset();
+        m_plainMessage[slot].reset();
     }
-    else{
-        return -1;
+    for(CompressionGroup& group : m_compressionGroups){
+        group.ready = false;
+        group.streamMessage.reset();
+        group.webSocketMessage.reset();
     }
-    return 0;
 }
 
 void NetworkHandler::fdReset(){
     FD_ZERO(&m_subscriberSet);
+    FD_ZERO(&m_writableSet);
     FD_SET(m_topSocket,&m_subscriberSet);
     m_maxSocket = m_topSocket;
-    for(SOCKET s : m_subscribers){
-        FD_SET(s,&m_subscriberSet);
+    if(m_unixSocket != INVALID_SOCKET){
+        FD_SET(m_unixSocket,&m_subscriberSet);
+        #ifndef _WIN32
+        m_maxSocket = m_unixSocket > m_maxSocket ? m_unixSocket : m_maxSocket;
+        #endif
+    }
+    if(m_httpSocket != INVALID_SOCKET){
+        FD_SET(m_httpSocket,&m_subscriberSet);
+        #ifndef _WIN32
+        m_maxSocket = m_httpSocket > m_maxSocket ? m_httpSocket : m_maxSocket;
+        #endif
+    }
+    if(m_metricsSocket != INVALID_SOCKET){
+        FD_SET(m_metricsSocket,&m_subscriberSet);
+        #ifndef _WIN32
+        m_maxSocket = m_metricsSocket > m_maxSocket ? m_metricsSocket : m_maxSocket;
+        #endif
+    }
+    #ifndef _WIN32
+    const int wake = m_eventQueue->WakeDescriptor();
+    if(wake != -1){
+        FD_SET(wake,&m_subscriberSet);
+        m_maxSocket = wake > m_maxSocket ? wake : m_maxSocket;
+    }
+    #endif
+    const auto now = std::chrono::steady_clock::now();
+    m_nextRefill = std::chrono::steady_clock::time_point::max();
+    for(Subscriber& subscriber : m_subscribers){
+        SOCKET s = subscriber.socket;
+        if(!subscriber.closing){
+            FD_SET(s,&m_subscriberSet);
+        }
+        if(subscriber.bootstrapPending){
+            m_nextRefill = std::min(m_nextRefill,subscriber.bootstrapAt);
+        }
+        subscriber.throttled = false;
+        if(!subscriber.outbox.empty() || !subscriber.frameOutbox.empty()){
+            /* A partly sent message goes on regardless of the rate limit */
+            if(subscriber.inFlight || subscriber.frameInFlight || subscriber.bucket.Ready(now)){
+                FD_SET(s,&m_writableSet);
+            }
+            else{
+                subscriber.throttled = true;
+                m_nextRefill = std::min(m_nextRefill,subscriber.bucket.RefillAt());
+            }
+        }
         #ifndef _WIN32
         m_maxSocket = s > m_maxSocket ? s : m_maxSocket; 
         #endif
     }
 }
 
-void NetworkHandler::newConnection(){
-    sockaddr_in incoming;
-    socklen_t addrlen = sizeof(incoming);
-    SOCKET newSocket = accept(m_topSocket,
-                              reinterpret_cast<struct sockaddr*>(&incoming),
-                              &addrlen);
-    if(m_subscribers.size() > MAX_CLIENTS){
+void NetworkHandler::newConnection(SOCKET listener,Transport transport){
+    struct sockaddr_storage peer;
+    socklen_t peerSize = sizeof(peer);
+    SOCKET newSocket = accept(listener,reinterpret_cast<struct sockaddr*>(&peer),&peerSize);
+    /* Scrapes are short, they get through when the plugin is busiest */
+    const bool metricsOnly = listener == m_metricsSocket;
+    if(m_subscribers.size() > MAX_CLIENTS && !metricsOnly){
         CLOSE_SOCKET(newSocket);
+        m_disconnects[static_cast<size_t>(DisconnectReason::Refused)].Add();
         return;
     }
     if(newSocket > 0){
-        int lastError = setsockopt(newSocket,SOL_SOCKET,SO_SNDTIMEO,
-                                   reinterpret_cast<char*>(&m_send_timeout),
-                                   sizeof(m_send_timeout));
-        const char* event = m_lastSentFrame.c_str();
-        size_t event_size = strlen(event) + 1;
-        lastError = sendMessage(newSocket,event,static_cast<ssize_t>(event_size));
-        if(lastError == -1){
+        if(!setNonBlocking(newSocket)){
             CLOSE_SOCKET(newSocket);
             return;
         }
-        m_subscribers.push_back(newSocket);
+        if(transport != Transport::Tcp){
+            int bufferSize = UNIX_SEND_BUFFER;
+            setsockopt(newSocket,SOL_SOCKET,SO_SNDBUF,
+                       reinterpret_cast<char*>(&bufferSize),sizeof(bufferSize));
+        }
+        Subscriber subscriber;
+        subscriber.socket = newSocket;
+        subscriber.transport = transport;
+        subscriber.id = ++m_nextSubscriberId;
+        subscriber.metricsOnly = metricsOnly;
+        /* Remote clients are served after local ones unless they ask otherwise */
+        const bool remote = peer.ss_family == AF_INET &&
+            (ntohl(reinterpret_cast<struct sockaddr_in*>(&peer)->sin_addr.s_addr) >> 24) != 127;
+        setQos(subscriber,remote ? QosClass::BestEffort : QosClass::Realtime);
+        if(transport != Transport::HttpPending){
+            deferBootstrap(subscriber);
+        }
+        m_subscribers.push_back(std::move(subscriber));
     }
 }
 
 void NetworkHandler::checkDeadConnections(){
     std::vector<SOCKET> deadSockets;
-    for(SOCKET s : m_subscribers){
-        if(FD_ISSET(s,&m_subscriberSet)){
-            //char* buffer = (char*) malloc(16);
-            char* buffer = static_cast<char*>(malloc(16));
-            if(recv(s,buffer,8,0) == 0){
-                CLOSE_SOCKET(s);
-                deadSockets.push_back(s);
+    for(Subscriber& subscriber : m_subscribers){
+        SOCKET s = subscriber.socket;
+        if(FD_ISSET(s,&m_subscriberSet) && !readClient(subscriber)){
+            disconnect(subscriber,DisconnectReason::Client,&deadSockets);
+        }
+    }
+    for(SOCKET s : deadSockets){
+        m_subscribers.remove_if([s](const Subscriber& subscriber){return subscriber.socket == s;});
+    }
+}
+
+void NetworkHandler::flushSubscribers(){
+    auto now = std::chrono::steady_clock::now();
+    std::vector<SOCKET> deadSockets;
+    for(QosClass qos : {QosClass::Realtime,QosClass::Reliable,QosClass::BestEffort}){
+        for(Subscriber& subscriber : m_subscribers){
+            if(subscriber.qos != qos){
+                continue;
+            }
+            const bool queued = !subscriber.outbox.empty() || !subscriber.frameOutbox.empty();
+            if(queued && subscriber.throttled){
+                /* Waiting for the rate limit doesn't count as stuck */
+                subscriber.lastProgress = now;
+            }
+            else if(queued && FD_ISSET(subscriber.socket,&m_writableSet)){
+                subscriber.lastProgress = now;
+                if(!flushOutbox(subscriber)){
+                    disconnect(subscriber,DisconnectReason::Error,&deadSockets);
+                    continue;
+                }
+            }
+            else if(queued && now - subscriber.lastProgress > std::chrono::seconds(TIMEOUT_SEND_SEC)){
+                disconnect(subscriber,DisconnectReason::Timeout,&deadSockets);
+                continue;
+            }
+            if(subscriber.closing && subscriber.outbox.empty()){
+                /* The HTTP response is out, that's no failure */
+                CLOSE_SOCKET(subscriber.socket);
+                deadSockets.push_back(subscriber.socket);
             }
-            free(buffer);
         }
     }
     for(SOCKET s : deadSockets){
-        m_subscribers.remove(s);
+        m_subscribers.remove_if([s](const Subscriber& subscriber){return subscriber.socket == s;});
+    }
+}
+
+/*
+ * Returns false if the connection has to be closed
+ */
+bool NetworkHandler::readClient(Subscriber& subscriber){
+    char buffer[4096];
+    auto received = recv(subscriber.socket,buffer,sizeof(buffer),0);
+    if(received < 0 && wouldBlock()){
+        return true;
+    }
+    if(received <= 0){
+        return false;
+    }
+    subscriber.input.append(buffer,static_cast<size_t>(received));
+    if(subscriber.transport == Transport::HttpPending){
+        size_t headSize = HttpParser::HeadSize(subscriber.input);
+        if(headSize == 0){
+            return subscriber.input.size() < HTTP_MAX_REQUEST;
+        }
+        if(!handleRequest(subscriber,headSize)){
+            return false;
+        }
+        if(subscriber.closing){
+            return true;
+        }
+    }
+    if(subscriber.transport == Transport::EventStream){
+        /* Event stream clients have nothing more to say */
+        subscriber.input.clear();
+        return true;
+    }
+    if(subscriber.transport == Transport::UnixSeqPacket){
+        /* One packet, one command */
+        bool keep = handleCommand(subscriber,subscriber.input);
+        subscriber.input.clear();
+        return keep;
+    }
+    if(subscriber.transport != Transport::WebSocket){
+        /* Commands are separated by NUL like the events */
+        size_t end;
+        while((end = subscriber.input.find('\0')) != std::string::npos){
+            if(!handleCommand(subscriber,std::string_view(subscriber.input).substr(0,end))){
+                return false;
+            }
+            subscriber.input.erase(0,end + 1);
+        }
+        return subscriber.input.size() < COMMAND_MAX_SIZE;
+    }
+    WebSocketFrame frame;
+    size_t used;
+    while((used = WebSocket::ParseClientFrame(subscriber.input,&frame)) != 0){
+        if(used == SIZE_MAX){
+            return false;
+        }
+        subscriber.input.erase(0,used);
+        if(frame.opcode == WEBSOCKET_CLOSE){
+            /* Echo the status code, then hang up */
+            sendWebSocketControl(subscriber,WEBSOCKET_CLOSE,
+                                 std::string_view(frame.payload).substr(0,2));
+            return false;
+        }
+        if(frame.opcode == WEBSOCKET_PING &&
+           sendWebSocketControl(subscriber,WEBSOCKET_PONG,frame.payload) == -1){
+            return false;
+        }
+        if(frame.opcode == WEBSOCKET_TEXT){
+            if(frame.compressed){
+                std::string command;
+                if(subscriber.deflater == nullptr || !subscriber.deflater->Decompress(frame.payload,&command)){
+                    return false;
+                }
+                frame.payload.swap(command);
+            }
+            if(!handleCommand(subscriber,frame.payload)){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * Returns false if the connection has to be closed right away, plain
+ * requests close it once the response is out
+ */
+bool NetworkHandler::handleRequest(Subscriber& subscriber,size_t headSize){
+    HttpRequest request;
+    std::string_view head = std::string_view(subscriber.input).substr(0,headSize);
+    if(!HttpParser::Parse(head,&request)){
+        static const char badRequest[] = "HTTP/1.1 400 Bad Request\r\n"
+                                         "Content-Length: 0\r\n"
+                                         "Connection: close\r\n\r\n";
+        subscriber.closing = true;
+        return sendMessage(subscriber,badRequest,sizeof(badRequest) - 1) != -1;
+    }
+    if(subscriber.metricsOnly || HttpApi::IsMetrics(request)){
+        /* Scrapes don't keep the channels registered like polling clients */
+        m_httpApi.SetMetrics(metrics());
+        std::string response = HttpApi::IsMetrics(request) ? m_httpApi.Respond(request) : HttpApi::NotFound();
+        subscriber.closing = true;
+        return sendMessage(subscriber,response.c_str(),response.size()) != -1;
+    }
+    if(WebSocket::IsUpgrade(request)){
+        DeflateParameters deflate;
+        std::string response = WebSocket::Handshake(request,&deflate);
+        if(sendMessage(subscriber,response.c_str(),response.size()) == -1){
+            return false;
+        }
+        if(deflate.enabled){
+            subscriber.deflater = std::make_unique<MessageDeflater>(deflate);
+        }
+        subscriber.transport = Transport::WebSocket;
+        subscriber.input.erase(0,headSize);
+        FrameDialect dialect;
+        if(Dialect::Parse(HttpApi::QueryParameter(request,"dialect"),&dialect) && !setDialect(subscriber,dialect)){
+            return false;
+        }
+        deferBootstrap(subscriber);
+        return true;
+    }
+    if(HttpApi::IsEventStream(request)){
+        std::string response = HttpApi::EventStreamHeaders();
+        if(sendMessage(subscriber,response.c_str(),response.size()) == -1){
+            return false;
+        }
+        subscriber.transport = Transport::EventStream;
+        subscriber.interval = HttpApi::StreamInterval(request);
+        FrameDialect dialect;
+        if(Dialect::Parse(HttpApi::QueryParameter(request,"dialect"),&dialect) && !setDialect(subscriber,dialect)){
+            return false;
+        }
+        return sendBootstrap(subscriber) != -1;
+    }
+    if(HttpApi::IsStats(request)){
+        m_httpApi.SetStats(stats());
+    }
+    std::string response = m_httpApi.Respond(request);
+    m_lastPull = std::chrono::steady_clock::now();
+    subscriber.closing = true;
+    return sendMessage(subscriber,response.c_str(),response.size()) != -1;
+}
+
+/*
+ * Commands are JSON objects, unknown ones are ignored. Returns false if the
+ * connection has to be closed.
+ *
+ * {"compression":"none|deflate|zstd"} switches to compressed messages,
+ * once per connection. The answer still comes in the old framing.
+ *
+ * {"resume":<seq>,"session":<session>} replays the gameplay events after
+ * seq, then sends the bundle. Once the bundle is out, only those sent
+ * before it are replayed, the bundle covered the rest. A resync notice
+ * means they are gone or the session changed.
+ *
+ * {"qos":"realtime|reliable|best-effort"} picks the QoS class, see qos.h.
+ *
+ * {"lod":"auto|full|no-wheels|truck|gauges"} pins the detail tier of
+ * frames, or lets it follow congestion again, see frame_lod.h.
+ *
+ * {"dialect":"standard|short|positional"} switches the encoding of frames,
+ * the header of the dialect comes first, see frame_dialect.h.
+ */
+bool NetworkHandler::handleCommand(Subscriber& subscriber,std::string_view command){
+    nlohmann::json parsed = nlohmann::json::parse(command,nullptr,false);
+    if(!parsed.is_object()){
+        return true;
     }
+    auto compressionName = parsed.find("compression");
+    if(compressionName != parsed.end() && compressionName->is_string() &&
+       subscriber.compression == Compression::None){
+        Compression compression = Compression::None;
+        MessageCompressor::Parse(compressionName->get<std::string>(),&compression);
+        CompressionGroup& group = compressionGroup(compression,subscriber.dialect,subscriber.tier);
+        if(compression != Compression::None && group.compressor == nullptr){
+            group.compressor = MessageCompressor::Create(compression);
+            if(group.compressor == nullptr){
+                /* Not built in, stay uncompressed */
+                compression = Compression::None;
+            }
+        }
+        nlohmann::json answer;
+        answer["payloadType"] = "compression";
+        answer["payload"]["compression"] = MessageCompressor::Name(compression);
+        answer["payload"]["dictionaryId"] = FRAME_DICTIONARY_ID;
+        if(sendPrivate(subscriber,answer.dump(),"compression") == -1){
+            return false;
+        }
+        if(compression != Compression::None){
+            subscriber.compression = compression;
+            subscriber.synced = false;
+            group.resetPending = true;
+        }
+    }
+    auto qosName = parsed.find("qos");
+    QosClass qos;
+    if(qosName != parsed.end() && qosName->is_string() && Qos::Parse(qosName->get<std::string>(),&qos)){
+        setQos(subscriber,qos);
+        nlohmann::json answer;
+        answer["payloadType"] = "qos";
+        answer["payload"]["qos"] = Qos::Name(qos);
+        answer["payload"]["rate"] = m_qosRates[static_cast<size_t>(qos)];
+        if(sendPrivate(subscriber,answer.dump(),"qos") == -1){
+            return false;
+        }
+    }
+    auto lodName = parsed.find("lod");
+    LodTier tier;
+    if(lodName != parsed.end() && *lodName == "auto"){
+        subscriber.adaptive = true;
+    }
+    else if(lodName != parsed.end() && lodName->is_string() && Lod::Parse(lodName->get<std::string>(),&tier)){
+        subscriber.adaptive = false;
+        if(!setTier(subscriber,tier,"requested")){
+            return false;
+        }
+    }
+    auto dialectName = parsed.find("dialect");
+    FrameDialect dialect;
+    if(dialectName != parsed.end() && dialectName->is_string() &&
+       Dialect::Parse(dialectName->get<std::string>(),&dialect) && !setDialect(subscriber,dialect)){
+        return false;
+    }
+    auto resume = parsed.find("resume");
+    if(resume != parsed.end() && resume->is_number_unsigned()){
+        const uint64_t after = resume->get<uint64_t>();
+        auto session = parsed.find("session");
+        std::vector<const ReplayRing::Entry*> missed;
+        nlohmann::json answer;
+        const uint64_t until = subscriber.bootstrapPending ? m_replay.Sequence() : subscriber.joinedAt;
+        if((session == parsed.end() || *session == m_replay.Session()) &&
+           m_replay.Replay(after,until,&missed)){
+            for(const ReplayRing::Entry* entry : missed){
+                if(sendPrivate(subscriber,*entry->event,entry->type.c_str()) == -1){
+                    return false;
+                }
+            }
+            answer["payloadType"] = "resume";
+            answer["payload"]["replayed"] = missed.size();
+            subscriber.resumed = subscriber.bootstrapPending;
+        }
+        else{
+            answer["payloadType"] = "resync";
+            answer["payload"]["oldest"] = m_replay.Oldest();
+            answer["payload"]["session"] = m_replay.Session();
+        }
+        answer["payload"]["seq"] = after;
+        if(sendPrivate(subscriber,answer.dump(),answer["payloadType"].get<std::string>().c_str()) == -1){
+            return false;
+        }
+        if(subscriber.bootstrapPending && sendBootstrap(subscriber) == -1){
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Moves a subscriber to another tier and tells it why. Returns false if
+ * the notice couldn't be sent.
+ */
+bool NetworkHandler::setTier(Subscriber& subscriber,LodTier tier,const char* reason){
+    if(subscriber.tier == tier){
+        return true;
+    }
+    subscriber.tier = tier;
+    if(subscriber.compression != Compression::None){
+        joinCompressionGroup(subscriber);
+    }
+    /* Congestion changes tiers while frames flow, so no json DOM here */
+    std::string& notice = m_lodNotice;
+    notice.assign("{\"payload\":{\"reason\":\"").append(reason);
+    notice.append("\",\"tier\":\"").append(Lod::Name(tier)).append("\"},\"payloadType\":\"lod\"}");
+    return sendPrivate(subscriber,notice,"lod") != -1;
+}
+
+/*
+ * Steps a subscriber that keeps falling behind down a tier, and probes
+ * back up once it has kept up for a while. A tier that failed again right
+ * after a probe is tried less often, like adaptive bitrate video.
+ */
+bool NetworkHandler::adaptTier(Subscriber& subscriber,std::chrono::steady_clock::time_point now){
+    /* HTTP requests and handshakes in progress get no frames yet */
+    if(subscriber.transport == Transport::HttpPending || !subscriber.adaptive || subscriber.qos == QosClass::Reliable){
+        return true;
+    }
+    const bool behind = subscriber.inFlight || !subscriber.outbox.empty() || !subscriber.frameOutbox.empty();
+    if(!behind){
+        subscriber.congestedFrames = 0;
+        if(subscriber.tier != LodTier::Full && now - subscriber.clearSince >= subscriber.probeDelay){
+            subscriber.clearSince = now;
+            subscriber.lastProbe = now;
+            return setTier(subscriber,static_cast<LodTier>(static_cast<int>(subscriber.tier) - 1),"recovered");
+        }
+        if(now - subscriber.clearSince >= std::chrono::milliseconds(LOD_PROBE_MAX_MS)){
+            subscriber.probeDelay = std::chrono::milliseconds(LOD_PROBE_MS);
+        }
+        return true;
+    }
+    subscriber.clearSince = now;
+    if(++subscriber.congestedFrames < LOD_CONGESTED_FRAMES || subscriber.tier == LodTier::Gauges){
+        return true;
+    }
+    subscriber.congestedFrames = 0;
+    if(now - subscriber.lastProbe < subscriber.probeDelay * 2 &&
+       subscriber.probeDelay < std::chrono::milliseconds(LOD_PROBE_MAX_MS)){
+        subscriber.probeDelay *= 2;
+    }
+    return setTier(subscriber,static_cast<LodTier>(static_cast<int>(subscriber.tier) + 1),"congested");
+}
+
+/*
+ * Switches the dialect of frames and sends its header. Returns false if
+ * the header couldn't be sent.
+ */
+bool NetworkHandler::setDialect(Subscriber& subscriber,FrameDialect dialect){
+    if(sendPrivate(subscriber,Dialect::Header(dialect),"dialect") == -1){
+        return false;
+    }
+    if(subscriber.dialect != dialect){
+        subscriber.dialect = dialect;
+        if(subscriber.compression != Compression::None){
+            joinCompressionGroup(subscriber);
+        }
+    }
+    return true;
+}
+
+static const char* transportName(Transport transport){
+    switch(transport){
+    case Transport::UnixSeqPacket:
+        return "unix";
+    case Transport::UnixStream:
+        return "unix-stream";
+    case Transport::HttpPending:
+        return "http";
+    case Transport::WebSocket:
+        return "websocket";
+    case Transport::EventStream:
+        return "stream";
+    default:
+        return "tcp";
+    }
+}
+
+static nlohmann::json summarize(const LatencyHistogram& histogram){
+    const LatencySummary summary = histogram.Summarize();
+    nlohmann::json answer;
+    answer["count"] = summary.count;
+    answer["mean"] = summary.count > 0 ? summary.sum / summary.count : 0;
+    answer["p50"] = summary.p50;
+    answer["p90"] = summary.p90;
+    answer["p99"] = summary.p99;
+    answer["p999"] = summary.p999;
+    answer["max"] = summary.max;
+    return answer;
+}
+
+std::string NetworkHandler::stats() const{
+    const MessagePoolStats pool = m_eventQueue->PoolStats();
+    nlohmann::json answer;
+    answer["messagePool"]["allocated"] = pool.allocated;
+    answer["messagePool"]["recycled"] = pool.recycled;
+    answer["messagePool"]["freed"] = pool.freed;
+    answer["messagePool"]["free"] = pool.free;
+    answer["subscribers"] = m_subscribers.size();
+    /* Nanoseconds, each stage from the point before it */
+    nlohmann::json& latency = answer["latency"];
+    latency["total"] = summarize(FrameTracing::Stage(TracePoint::FrameEnd));
+    for(size_t point = 1; point < TRACE_POINT_COUNT; point++){
+        latency["stages"][FrameTracing::PointName(static_cast<TracePoint>(point))] =
+            summarize(FrameTracing::Stage(static_cast<TracePoint>(point)));
+    }
+    latency["subscribers"] = nlohmann::json::array();
+    for(const Subscriber& subscriber : m_subscribers){
+        if(subscriber.transport == Transport::HttpPending){
+            continue;
+        }
+        nlohmann::json entry = summarize(*subscriber.latency);
+        entry["transport"] = transportName(subscriber.transport);
+        entry["qos"] = Qos::Name(subscriber.qos);
+        entry["tier"] = Lod::Name(subscriber.tier);
+        entry["dialect"] = Dialect::Name(subscriber.dialect);
+        latency["subscribers"].push_back(entry);
+    }
+    if(AllocationStats::Enabled()){
+        AllocationThreadStats threads[ALLOCATION_MAX_THREADS];
+        const size_t count = AllocationStats::Collect(threads);
+        nlohmann::json& allocations = answer["allocations"];
+        allocations = nlohmann::json::object();
+        for(size_t i = 0; i < count; i++){
+            const std::string name = threads[i].name != nullptr ? threads[i].name : "thread." + std::to_string(i);
+            for(size_t stage = 0; stage < ALLOCATION_STAGE_COUNT; stage++){
+                const AllocationCounter& counter = threads[i].stages[stage];
+                nlohmann::json& entry = allocations[name][AllocationStats::StageName(static_cast<AllocationStage>(stage))];
+                entry["allocations"] = counter.allocations;
+                entry["bytes"] = counter.bytes;
+                entry["frees"] = counter.frees;
+            }
+        }
+    }
+    return answer.dump();
+}
+
+std::string NetworkHandler::metrics(){
+    std::string text;
+    PrometheusWriter writer(&text);
+    Metrics::Render(&writer);
+    const EventQueueStats queue = m_eventQueue->Stats();
+    writer.Describe("tsts_event_queue_depth","gauge","Messages waiting for the network thread");
+    writer.Sample("tsts_event_queue_depth","",static_cast<uint64_t>(queue.depth));
+    writer.Describe("tsts_event_queue_peak_depth","gauge","The most messages that waited at once");
+    writer.Sample("tsts_event_queue_peak_depth","",static_cast<uint64_t>(queue.peak));
+    const MessagePoolStats pool = m_eventQueue->PoolStats();
+    writer.Describe("tsts_message_pool_allocated_total","counter","Message buffers the pool had to allocate");
+    writer.Sample("tsts_message_pool_allocated_total","",pool.allocated);
+    writer.Describe("tsts_message_pool_recycled_total","counter","Message buffers the pool handed out again");
+    writer.Sample("tsts_message_pool_recycled_total","",pool.recycled);
+    writer.Describe("tsts_subscribers","gauge","Connected subscribers");
+    size_t subscribers[TRANSPORT_COUNT] = {};
+    for(const Subscriber& subscriber : m_subscribers){
+        subscribers[static_cast<size_t>(subscriber.transport)]++;
+    }
+    for(size_t transport = 0; transport < TRANSPORT_COUNT; transport++){
+        writer.Sample("tsts_subscribers","transport=\"" + std::string(transportName(static_cast<Transport>(transport))) + "\"",
+                      static_cast<uint64_t>(subscribers[transport]));
+    }
+    writer.Describe("tsts_sent_bytes_total","counter","Bytes the sockets took, by the format of the subscriber");
+    for(size_t transport = 0; transport < TRANSPORT_COUNT; transport++){
+        for(size_t dialect = 0; dialect < DIALECT_COUNT; dialect++){
+            for(size_t compression = 0; compression < COMPRESSION_COUNT; compression++){
+                const uint64_t bytes = m_sentBytes[(transport * DIALECT_COUNT + dialect) * COMPRESSION_COUNT + compression].Value();
+                if(bytes == 0){
+                    continue;
+                }
+                writer.Sample("tsts_sent_bytes_total",
+                              "transport=\"" + std::string(transportName(static_cast<Transport>(transport))) +
+                              "\",dialect=\"" + Dialect::Name(static_cast<FrameDialect>(dialect)) +
+                              "\",compression=\"" + MessageCompressor::Name(static_cast<Compression>(compression)) + "\"",
+                              bytes);
+            }
+        }
+    }
+    writer.Describe("tsts_dropped_frames_total","counter","Frames replaced by a newer one before a slow subscriber got them");
+    for(size_t qos = 0; qos < QOS_CLASS_COUNT; qos++){
+        writer.Sample("tsts_dropped_frames_total","qos=\"" + std::string(Qos::Name(static_cast<QosClass>(qos))) + "\"",
+                      m_droppedFrames[qos].Value());
+    }
+    writer.Describe("tsts_disconnects_total","counter","Connections the plugin closed or refused");
+    static const char* const reasons[DISCONNECT_REASON_COUNT] = {"client","error","backlog","timeout","refused"};
+    for(size_t reason = 0; reason < DISCONNECT_REASON_COUNT; reason++){
+        writer.Sample("tsts_disconnects_total","reason=\"" + std::string(reasons[reason]) + "\"",m_disconnects[reason].Value());
+    }
+    writer.Describe("tsts_subscriber_backlog_bytes","gauge","Bytes waiting for a subscriber");
+    for(const Subscriber& subscriber : m_subscribers){
+        if(subscriber.transport == Transport::HttpPending){
+            continue;
+        }
+        writer.Sample("tsts_subscriber_backlog_bytes",
+                      "subscriber=\"" + std::to_string(subscriber.id) +
+                      "\",transport=\"" + transportName(subscriber.transport) +
+                      "\",qos=\"" + Qos::Name(subscriber.qos) + "\"",
+                      static_cast<uint64_t>(subscriber.outboxSize));
+    }
+    return text;
+}
+
+int NetworkHandler::sendWebSocketControl(Subscriber& subscriber,uint8_t opcode,std::string_view payload){
+    std::string message;
+    WebSocket::AppendHeader(&message,opcode,payload.size(),false);
+    message.append(payload);
+    return sendMessage(subscriber,message.c_str(),message.size());
 }
 
 void NetworkHandler::checkQueue(){
     while(!m_eventQueue->IsEmpty()){
+        AllocationScope scope(AllocationStage::Queue);
         EventInfo poppedEvent = m_eventQueue->PopEvent();
         if(poppedEvent.type == ""){
             break;
         }
-        const char* event = poppedEvent.event.c_str();
-        size_t event_size = strlen(event) + 1;
+        m_replay.Stamp(poppedEvent.event,poppedEvent.type);
+        const std::string& event = *poppedEvent.event;
+        /* Tiers, dialects and compression are encoded on demand while sending */
+        scope.Enter(AllocationStage::Send);
+        clearMessageCaches();
+        const bool frame = poppedEvent.type == EVENT_FRAME;
+        const auto now = std::chrono::steady_clock::now();
+        if(frame){
+            m_frameTiers.SetFrame(poppedEvent.event);
+            m_frameDialects.SetFrame(&m_frameTiers);
+            for(size_t tier = 1; tier < LOD_TIER_COUNT; tier++){
+                m_tierDue[tier] = now >= m_nextTierFrame[tier];
+                if(m_tierDue[tier]){
+                    m_nextTierFrame[tier] = now + std::chrono::milliseconds(Lod::IntervalMs(static_cast<LodTier>(tier)));
+                }
+            }
+        }
         std::vector<SOCKET> deadSockets;
-        for(SOCKET s : m_subscribers){
-            if(sendMessage(s,event,static_cast<ssize_t>(event_size)) == -1){
-                CLOSE_SOCKET(s);
-                deadSockets.push_back(s);
+        for(QosClass qos : {QosClass::Realtime,QosClass::Reliable,QosClass::BestEffort}){
+            for(Subscriber& subscriber : m_subscribers){
+                if(subscriber.qos != qos){
+                    continue;
+                }
+                bool alive = !frame || adaptTier(subscriber,now);
+                m_trace = frame ? &poppedEvent.event.Trace() : nullptr;
+                alive = alive && sendEvent(subscriber,event,poppedEvent.type) != -1;
+                m_trace = nullptr;
+                if(!alive){
+                    disconnect(subscriber,failureOf(subscriber),&deadSockets);
+                }
             }
         }
+        if(frame){
+            FrameTracing::Record(poppedEvent.event.Trace());
+        }
         for(SOCKET s : deadSockets){
-            m_subscribers.remove(s);
+            m_subscribers.remove_if([s](const Subscriber& subscriber){return subscriber.socket == s;});
         }
+        if(m_udpPublisher != nullptr){
+            m_udpPublisher->Publish(event,poppedEvent.type == EVENT_FRAME);
+        }
+        scope.Enter(AllocationStage::Snapshot);
+        m_snapshot.Update(poppedEvent.event,poppedEvent.type);
         if(poppedEvent.type == EVENT_FRAME)
         {
-            m_lastSentFrame = poppedEvent.event;
+            m_httpApi.SetFrame(&m_snapshot.Keyframe(),++m_frameVersion);
+        }
+        else if(poppedEvent.type == EVENT_CONFIG){
+            m_httpApi.SetConfig(&m_snapshot.Config());
         }
     }
 }
 
 void NetworkHandler::EventLoop(std::stop_token stopToken){
+    AllocationStats::NameThread("network");
+    AllocationScope scope(AllocationStage::Other);
+    /* Stopping has to interrupt the wait for events */
+    std::stop_callback wakeOnStop(stopToken,[this]{ m_eventQueue->Wake(); });
     while(!stopToken.stop_requested()){
         fdReset();
+        /*
+         * Sleep until a socket, an event or a rate limit needs attention,
+         * poll if the queue can't wake us
+         */
+        m_select_timeout.tv_sec = 0;
+        m_select_timeout.tv_usec = 0;
+        const bool waiting = m_eventQueue->PrepareWait();
+        if(waiting){
+            const auto now = std::chrono::steady_clock::now();
+            auto wait = std::chrono::microseconds(NETWORK_WAIT_MAX_MS * 1000);
+            if(m_nextRefill < now + wait){
+                wait = std::chrono::ceil<std::chrono::microseconds>(m_nextRefill - now);
+                wait = std::max(wait,std::chrono::microseconds(0));
+            }
+            m_select_timeout.tv_sec = static_cast<long>(wait.count() / 1000000);
+            m_select_timeout.tv_usec = static_cast<long>(wait.count() % 1000000);
+        }
         //int lastError = select(m_maxSocket+1,&m_subscriberSet,NULL,NULL,&m_select_timeout);
-        int lastError = select(static_cast<int>(m_maxSocket + 1), &m_subscriberSet, NULL, NULL, &m_select_timeout);
+        int lastError = select(static_cast<int>(m_maxSocket + 1),&m_subscriberSet,&m_writableSet,NULL,&m_select_timeout);
+        if(waiting){
+            m_eventQueue->FinishWait();
+        }
+        #ifndef _WIN32
+        if(lastError < 0 && errno == EINTR){
+            continue;
+        }
+        #endif
         /*
          * This is present mostly for debugging purposes
          */
@@ -187,13 +1406,81 @@ void NetworkHandler::EventLoop(std::stop_token stopToken){
             throw std::runtime_error("Error during select in the network code!");
         }
         if(FD_ISSET(m_topSocket,&m_subscriberSet)){
-            newConnection();
+            newConnection(m_topSocket,Transport::Tcp);
+        }
+        if(m_unixSocket != INVALID_SOCKET && FD_ISSET(m_unixSocket,&m_subscriberSet)){
+            newConnection(m_unixSocket,m_unixTransport);
+        }
+        if(m_httpSocket != INVALID_SOCKET && FD_ISSET(m_httpSocket,&m_subscriberSet)){
+            newConnection(m_httpSocket,Transport::HttpPending);
+        }
+        if(m_metricsSocket != INVALID_SOCKET && FD_ISSET(m_metricsSocket,&m_subscriberSet)){
+            newConnection(m_metricsSocket,Transport::HttpPending);
         }
         checkDeadConnections();
+        sendDueBootstraps();
+        {
+            AllocationScope sendScope(AllocationStage::Send);
+            flushSubscribers();
+        }
         checkQueue();
+        /*
+         * Clients polling the HTTP API count as one subscriber for a while,
+         * the requests themselves don't, nor do metrics scrapes
+         */
+        size_t subscriberCount = 0;
+        size_t queuedMessages = 0;
+        uint32_t tiers = 0;
+        bool variants = false;
+        for(const Subscriber& subscriber : m_subscribers){
+            queuedMessages += subscriber.outbox.size();
+            if(subscriber.transport == Transport::HttpPending){
+                continue;
+            }
+            subscriberCount++;
+            tiers |= 1u << static_cast<unsigned>(subscriber.tier);
+            variants = variants || subscriber.tier != LodTier::Full || subscriber.dialect != FrameDialect::Standard;
+        }
+        if(m_lastPull != std::chrono::steady_clock::time_point() &&
+           std::chrono::steady_clock::now() - m_lastPull < std::chrono::milliseconds(HTTP_PULL_LINGER_MS)){
+            subscriberCount++;
+            tiers |= 1u << static_cast<unsigned>(LodTier::Full);
+        }
+        m_subscriberCount.store(subscriberCount,std::memory_order_relaxed);
+        m_queuedMessages.store(queuedMessages,std::memory_order_relaxed);
+        m_tierDemand.store(tiers,std::memory_order_relaxed);
+        m_variantDemand.store(variants,std::memory_order_relaxed);
     }
 }
 
+size_t NetworkHandler::GetSubscriberCount(){
+    if(m_instance == nullptr){
+        return 0;
+    }
+    return m_instance->m_subscriberCount.load(std::memory_order_relaxed);
+}
+
+size_t NetworkHandler::GetQueuedMessages(){
+    if(m_instance == nullptr){
+        return 0;
+    }
+    return m_instance->m_queuedMessages.load(std::memory_order_relaxed);
+}
+
+uint32_t NetworkHandler::GetTierDemand(){
+    if(m_instance == nullptr){
+        return 0;
+    }
+    return m_instance->m_tierDemand.load(std::memory_order_relaxed);
+}
+
+bool NetworkHandler::GetVariantDemand(){
+    if(m_instance == nullptr){
+        return false;
+    }
+    return m_instance->m_variantDemand.load(std::memory_order_relaxed);
+}
+
 
 
 /*
@@ -207,12 +1494,24 @@ void NetworkHandler::Cleanup(){
 }
 
 NetworkHandler::~NetworkHandler(){
-    for(SOCKET s : m_subscribers){
-        CLOSE_SOCKET(s);
-        // m_subscribers.remove(s);
+    for(const Subscriber& subscriber : m_subscribers){
+        CLOSE_SOCKET(subscriber.socket);
     }
     m_subscribers.clear();
+    delete m_udpPublisher;
     CLOSE_SOCKET(m_topSocket);
+    if(m_httpSocket != INVALID_SOCKET){
+        CLOSE_SOCKET(m_httpSocket);
+    }
+    if(m_metricsSocket != INVALID_SOCKET){
+        CLOSE_SOCKET(m_metricsSocket);
+    }
+    #ifndef _WIN32
+    if(m_unixSocket != INVALID_SOCKET){
+        CLOSE_SOCKET(m_unixSocket);
+        unlink(m_unixSocketPath.c_str());
+    }
+    #endif
     #ifdef _WIN32
     WSACleanup();
     #endif
@@ -0,0 +1,73 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "plugin_options.h"
+
+#include <charconv>
+#include <cstdlib>
+
+static std::string read_option(const char *name) {
+#ifdef _MSC_VER
+  char *value = nullptr;
+  size_t length = 0;
+  if (_dupenv_s(&value, &length, name) != 0 || value == nullptr) {
+    return std::string();
+  }
+  std::string result(value);
+  free(value);
+  return result;
+#else
+  const char *value = getenv(name);
+  return value != nullptr ? std::string(value) : std::string();
+#endif
+}
+
+/* Returns fallback if the option is unset or not a number */
+static int read_int_option(const char *name, int fallback) {
+  const std::string value = read_option(name);
+  int result = fallback;
+  if (std::from_chars(value.data(), value.data() + value.size(), result).ec !=
+      std::errc()) {
+    return fallback;
+  }
+  return result;
+}
+
+/* Byte rates below zero would wrap to huge limits, so they mean unlimited */
+static int read_rate_option(const char *name) {
+  const int rate = read_int_option(name, 0);
+  return rate > 0 ? rate : 0;
+}
+
+PluginOptions PluginOptionsLoader::Load() {
+  PluginOptions options;
+  options.sharedMemoryName = read_option("TSTS_SHM_NAME");
+  options.unixSocketPath = read_option("TSTS_UNIX_SOCKET");
+  options.udpTarget = read_option("TSTS_UDP_TARGET");
+  options.udpRedundancy = read_int_option("TSTS_UDP_REDUNDANCY", 0);
+  options.httpPort = read_int_option("TSTS_HTTP_PORT", 0);
+  options.metricsPort = read_int_option("TSTS_METRICS_PORT", 0);
+  options.realtimeRate = read_rate_option("TSTS_REALTIME_RATE");
+  options.reliableRate = read_rate_option("TSTS_RELIABLE_RATE");
+  options.bestEffortRate = read_rate_option("TSTS_BEST_EFFORT_RATE");
+  options.timestamps = read_int_option("TSTS_TIMESTAMPS", 0) != 0;
+  options.trace = read_int_option("TSTS_TRACE", 0) != 0;
+  return options;
+}
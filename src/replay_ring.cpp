@@ -0,0 +1,109 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "replay_ring.h"
+#include "event_queue.h"
+
+#include <charconv>
+#include <chrono>
+
+namespace {
+
+/* std::to_string allocates for numbers as long as timestamps */
+template <typename Number> void append_number(std::string *out, Number value) {
+  char digits[24];
+  const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  out->append(digits, result.ptr);
+}
+
+} // namespace
+
+ReplayRing::ReplayRing()
+    : m_session(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count())),
+      m_events(REPLAY_RING_SIZE) {}
+
+uint64_t ReplayRing::Stamp(const MessageRef &message,
+                           const std::string &type) {
+  std::string *event = &*message;
+  const bool frame = type == EVENT_FRAME;
+  const uint64_t sequence = frame ? ++m_frames : ++m_sequence;
+  if (event->empty() || event->back() != '}') {
+    return sequence;
+  }
+  event->pop_back();
+  if (event->back() != '{') {
+    event->push_back(',');
+  }
+  event->append("\"seq\":");
+  append_number(event, sequence);
+  if (message.Timestamp() != 0) {
+    event->append(",\"timestamp\":");
+    append_number(event, message.Timestamp());
+  }
+  const MessageTrace &trace = message.Trace();
+  if (m_embedTraces && frame &&
+      trace.At(TracePoint::FrameEnd) != 0) {
+    char separator = '{';
+    event->append(",\"trace\":");
+    for (size_t point = 0; point < TRACE_POINT_COUNT; point++) {
+      if (trace.points[point] == 0) {
+        continue;
+      }
+      event->push_back(separator);
+      event->append(1, '"')
+          .append(FrameTracing::PointName(static_cast<TracePoint>(point)))
+          .append("\":");
+      append_number(event, trace.points[point]);
+      separator = ',';
+    }
+    event->push_back('}');
+  }
+  event->push_back('}');
+  if (!frame) {
+    if (m_count == m_events.size()) {
+      m_evicted = m_events[m_head].sequence;
+      m_head = (m_head + 1) % m_events.size();
+      m_count--;
+    }
+    Entry &entry = m_events[(m_head + m_count) % m_events.size()];
+    entry.sequence = sequence;
+    entry.type = type;
+    entry.event = message;
+    m_count++;
+  }
+  return sequence;
+}
+
+bool ReplayRing::Replay(uint64_t after, uint64_t until,
+                        std::vector<const Entry *> *out) const {
+  if (after < m_evicted || after > m_sequence) {
+    return false;
+  }
+  for (size_t i = 0; i < m_count; i++) {
+    const Entry &entry = m_events[(m_head + i) % m_events.size()];
+    if (entry.sequence > after && entry.sequence <= until) {
+      out->push_back(&entry);
+    }
+  }
+  return true;
+}
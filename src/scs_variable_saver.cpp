@@ -20,79 +20,12 @@ If not, see <https://www.gnu.org/licenses/>.
 
 
 #include "scs_variable_saver.h"
-#include "telemetry.h"
-
-#define UNUSED(x)
 
 namespace ScsVariableSaver
 {
-    void StoreScsOrientation(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        TelemetryOrientation *target = static_cast<TelemetryOrientation*>(context);
-
-        target->heading = value->value_euler.heading * 360.0f;
-        target->pitch = value->value_euler.pitch * 360.0f;
-        target->roll = value->value_euler.roll * 360.0f;
-    }
-    void StoreScsVector(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        TelemetryVec3D *target = static_cast<TelemetryVec3D*>(context);
-
-        target->x = value->value_dvector.x;
-        target->y = value->value_dvector.y;
-        target->z = value->value_dvector.z;
-    }
-    void StoreScsPlacement(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        TelemetryPlacement *target = static_cast<TelemetryPlacement*>(context);
-        const scs_value_dplacement_t *source = static_cast<const scs_value_dplacement_t*>(&value->value_dplacement);
-
-        target->orientation.heading = source->orientation.heading * 360.0f;
-        target->orientation.pitch = source->orientation.pitch * 360.0f;
-        target->orientation.roll = source->orientation.roll * 360.0f;
-
-        target->position.x = source->position.x;
-        target->position.y = source->position.y;
-        target->position.z = source->position.z;
-    }
-    void StoreScsString(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        std::string *target = static_cast<std::string*>(context);
-        *target = std::string(value->value_string.value);
-    }
-    void StoreScsDouble(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        scs_double_t *target = static_cast<scs_double_t*>(context);
-        *target = value->value_double.value;
-    }
-    void StoreScsFloat(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        scs_float_t *target = static_cast<scs_float_t*>(context);
-        *target = value->value_float.value;
-    }
-    void StoreScsS32(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        scs_s32_t *target = static_cast<scs_s32_t*>(context);
-        *target = value->value_s32.value;
-    }
-    void StoreScsU32(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        scs_u32_t *target = static_cast<scs_u32_t*>(context);
-        *target = value->value_u32.value;
-    }
-    void StoreScsS64(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        scs_s64_t *target = static_cast<scs_s64_t*>(context);
-        *target = value->value_s64.value;
-    }
-    void StoreScsU64(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
-    {
-        scs_u64_t *target = static_cast<scs_u64_t*>(context);
-        *target = value->value_u64.value;
-    }
-    void StoreScsBool(const scs_string_t UNUSED(name), const scs_u32_t UNUSED(index), const scs_value_t *const value, const scs_context_t context)
+    void StoreScsString(const scs_value_t *const value, std::string *target)
     {
-        bool *target = static_cast<bool*>(context);
-        *target = value->value_bool.value != 0;
+        /* Reuses the capacity of the target instead of building a temporary */
+        target->assign(value->value_string.value);
     }
-}
\ No newline at end of file
+}
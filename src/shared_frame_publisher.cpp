@@ -0,0 +1,142 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "shared_frame_publisher.h"
+
+#include <climits>
+#include <new>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef _WIN32
+
+SharedFramePublisher::SharedFramePublisher(const std::string &name)
+    : m_name(name) {
+  throw std::runtime_error(
+      "Shared memory frames are not supported on this platform!");
+}
+
+SharedFramePublisher::~SharedFramePublisher() {}
+
+void SharedFramePublisher::Publish(const TelemetryFrame &) {}
+
+#else
+
+static uint32_t offset_of(const void *base, const void *member) {
+  return static_cast<uint32_t>(static_cast<const char *>(member) -
+                               static_cast<const char *>(base));
+}
+
+SharedFramePublisher::SharedFramePublisher(const std::string &name)
+    : m_name(name) {
+  const size_t headerSize =
+      (sizeof(SharedFrameHeader) + alignof(SharedTelemetryFrame) - 1) /
+      alignof(SharedTelemetryFrame) * alignof(SharedTelemetryFrame);
+  m_size = headerSize + sizeof(SharedTelemetryFrame);
+
+  int fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Unable to open the shared memory frame!");
+  }
+  if (ftruncate(fd, static_cast<off_t>(m_size)) < 0) {
+    close(fd);
+    shm_unlink(m_name.c_str());
+    throw std::runtime_error("Unable to size the shared memory frame!");
+  }
+  m_region = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (m_region == MAP_FAILED) {
+    m_region = nullptr;
+    shm_unlink(m_name.c_str());
+    throw std::runtime_error("Unable to map the shared memory frame!");
+  }
+
+  m_header = new (m_region) SharedFrameHeader();
+  m_frame = new (static_cast<char *>(m_region) + headerSize)
+      SharedTelemetryFrame();
+  SharedTelemetryFrame &f = *m_frame;
+  m_header->headerSize = static_cast<uint32_t>(sizeof(SharedFrameHeader));
+  m_header->frameOffset = static_cast<uint32_t>(headerSize);
+  m_header->frameSize = static_cast<uint32_t>(sizeof(SharedTelemetryFrame));
+  m_header->gameTimeOffset = offset_of(&f, &f.gameTime);
+  m_header->pausedOffset = offset_of(&f, &f.paused);
+  m_header->idleOffset = offset_of(&f, &f.idle);
+  m_header->jobCargoDamageOffset = offset_of(&f, &f.jobCargoDamage);
+  m_header->truckOffset = offset_of(&f, &f.truck);
+  m_header->truckSize = static_cast<uint32_t>(sizeof(TelemetryTruckState));
+  m_header->truckWheelsOffset = offset_of(&f.truck, &f.truck.wheels);
+  m_header->trailerOffset = offset_of(&f, &f.trailer);
+  m_header->trailerSize = static_cast<uint32_t>(sizeof(TelemetryTrailerState));
+  m_header->trailerCount = MAX_TRAILERS;
+  m_header->trailerWheelsOffset =
+      offset_of(&f.trailer[0], &f.trailer[0].wheels);
+  m_header->wheelSize = static_cast<uint32_t>(sizeof(TelemetryWheel));
+  m_header->wheelCount = MAX_WHEEL_COUNT;
+  m_header->version = SHARED_FRAME_VERSION;
+  /* Readers check the magic last, write it once everything else is set */
+  std::atomic_thread_fence(std::memory_order_release);
+  m_header->magic = SHARED_FRAME_MAGIC;
+}
+
+SharedFramePublisher::~SharedFramePublisher() {
+  if (m_region != nullptr) {
+    munmap(m_region, m_size);
+    shm_unlink(m_name.c_str());
+  }
+}
+
+void SharedFramePublisher::Publish(const TelemetryFrame &frame) {
+  const uint32_t sequence =
+      m_header->sequence.load(std::memory_order_relaxed);
+  m_header->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  m_frame->gameTime = frame.gameTime;
+  m_frame->localScale = frame.localScale;
+  m_frame->multiplayerTimeOffset = frame.multiplayerTimeOffset;
+  m_frame->restStop = frame.restStop;
+  m_frame->paused = frame.paused;
+  m_frame->idle = frame.idle;
+  m_frame->jobCargoDamage = frame.job.cargoDamage;
+  m_frame->truck = frame.truck;
+  for (size_t i = 0; i < MAX_TRAILERS; ++i) {
+    m_frame->trailer[i] = frame.trailer[i];
+  }
+
+  /* Sequentially consistent so a reader that just started waiting is seen */
+  m_header->sequence.store(sequence + 2, std::memory_order_seq_cst);
+#ifdef __linux__
+  if (m_header->waiters.load(std::memory_order_seq_cst) > 0) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_header->sequence),
+            FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+  }
+#endif
+}
+
+#endif
@@ -0,0 +1,130 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "snapshot.h"
+#include "event_queue.h"
+
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+void SnapshotService::Update(const MessageRef &event,
+                             const std::string &type) {
+  if (type == EVENT_FRAME) {
+    m_keyframe = event;
+    m_version++;
+    return;
+  }
+  if (type != EVENT_GAMEPLAY && type != EVENT_CONFIG) {
+    return;
+  }
+  /* Gameplay events and config messages are rare, parsing them is fine */
+  const nlohmann::json parsed = nlohmann::json::parse(*event, nullptr, false);
+  if (type == EVENT_CONFIG) {
+    updateConfig(parsed, event);
+    return;
+  }
+  const nlohmann::json::json_pointer eventType("/payload/eventType");
+  if (!parsed.contains(eventType) || !parsed[eventType].is_string()) {
+    return;
+  }
+  const std::string key = parsed[eventType].get<std::string>();
+  auto previous = std::find_if(
+      m_events.begin(), m_events.end(),
+      [&key](const auto &entry) noexcept { return entry.first == key; });
+  if (previous != m_events.end()) {
+    m_events.erase(previous);
+  } else if (m_events.size() >= SNAPSHOT_MAX_EVENTS) {
+    m_events.erase(m_events.begin());
+  }
+  m_events.emplace_back(key, event);
+  m_version++;
+}
+
+void SnapshotService::updateConfig(const nlohmann::json &parsed,
+                                   const MessageRef &event) {
+  const nlohmann::json::json_pointer block("/payload/block");
+  if (!parsed.contains(block) || !parsed[block].is_string()) {
+    return;
+  }
+  std::string key = parsed[block].get<std::string>();
+  const nlohmann::json::json_pointer index("/payload/index");
+  if (parsed.contains(index)) {
+    key += '.';
+    key += parsed[index].dump();
+  }
+  auto previous = std::find_if(
+      m_configs.begin(), m_configs.end(),
+      [&key](const auto &entry) noexcept { return entry.first == key; });
+  if (previous != m_configs.end()) {
+    previous->second = event;
+  } else {
+    m_configs.emplace_back(key, event);
+  }
+  m_config.clear();
+  m_version++;
+}
+
+const std::string &SnapshotService::Config() {
+  if (!m_config.empty()) {
+    return m_config;
+  }
+  m_config = "[";
+  for (size_t i = 0; i < m_configs.size(); i++) {
+    if (i > 0) {
+      m_config += ',';
+    }
+    m_config += *m_configs[i].second;
+  }
+  m_config += ']';
+  return m_config;
+}
+
+const std::string &SnapshotService::Keyframe() const {
+  static const std::string none;
+  return m_keyframe ? *m_keyframe : none;
+}
+
+const std::vector<SnapshotMessage> &SnapshotService::Bundle() {
+  if (m_bundleVersion == m_version) {
+    return m_bundle;
+  }
+  m_bundleVersion = m_version;
+  m_bundle.clear();
+  if (!m_keyframe) {
+    return m_bundle;
+  }
+  /* The events are JSON already, no need to parse them again */
+  m_summary = "{\"payload\":{\"events\":[";
+  for (size_t i = 0; i < m_events.size(); i++) {
+    if (i > 0) {
+      m_summary += ',';
+    }
+    m_summary += *m_events[i].second;
+  }
+  m_summary += "],\"session\":";
+  m_summary += std::to_string(m_session);
+  m_summary += "},\"payloadType\":\"snapshot\"}";
+  m_bundle.push_back({&m_summary, EVENT_SNAPSHOT});
+  for (const auto &config : m_configs) {
+    m_bundle.push_back({&*config.second, EVENT_CONFIG});
+  }
+  m_bundle.push_back({&*m_keyframe, EVENT_FRAME});
+  return m_bundle;
+}
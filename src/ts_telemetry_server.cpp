@@ -25,15 +25,23 @@ If not, see <https://www.gnu.org/licenses/>.
 #include "scs_sdk/scssdk.h"
 #include "scs_sdk/scssdk_telemetry.h"
 
+#include "allocation_stats.h"
+#include "channel_registry.h"
 #include "config_handler.h"
 #include "event_queue.h"
+#include "frame_scheduler.h"
 #include "json_telemetry_serializer.h"
+#include "metrics.h"
 #include "network_handler.h"
-#include "scs_variable_saver.h"
+#include "plugin_options.h"
+#include "shared_frame_publisher.h"
 #include "telemetry.h"
 
+#include <algorithm>
+#include <charconv>
 #include <string.h>
 #include <thread>
+#include <utility>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -44,8 +52,20 @@ If not, see <https://www.gnu.org/licenses/>.
 EventQueue eventQueue;
 TelemetryFrame telemetryData = {};
 bool frameChanged = true;
+/* Set by events that have to reach the clients even in idle mode */
+bool frameForced = true;
+FrameScheduler frameScheduler;
+/* Of the last frame, the next one gets a buffer at least that big */
+size_t frameSize = 0;
+/* Frames keep a copy of the telemetry for the tiers and dialects */
+bool frameKept = false;
+/* Of the largest config message, the next one gets a buffer that big */
+size_t configSize = 0;
 
 AbstractTelemetrySerializer *serializer = nullptr;
+ChannelRegistry *channelRegistry = nullptr;
+SharedFramePublisher *sharedFrame = nullptr;
+PluginOptions pluginOptions;
 
 std::jthread *networkThread;
 
@@ -54,17 +74,72 @@ scs_log_t gameLog;
 SCSAPI_VOID telemetry_frame_start(const scs_event_t UNUSED(event),
                                   const void *const UNUSED(event_info),
                                   scs_context_t UNUSED(context)) {
-  /* Nothing useful here yet */
+  CallbackTimer timer(MetricCallback::FrameStart);
+  AllocationScope scope(AllocationStage::Other);
+  /* UDP viewers and the shared frame read all of it, clients their tiers */
+  const bool local = sharedFrame != nullptr || !pluginOptions.udpTarget.empty();
+  const uint32_t tiers = NetworkHandler::GetTierDemand();
+  const uint32_t full = 1u << static_cast<unsigned>(LodTier::Full);
+  const uint32_t noWheels = 1u << static_cast<unsigned>(LodTier::NoWheels);
+  ChannelDemand demand;
+  demand.truck = local || tiers != 0;
+  demand.wheels = local || (tiers & full) != 0;
+  demand.trailers = local || (tiers & (full | noWheels)) != 0;
+  if (channelRegistry->Update(demand)) {
+    frameForced = true;
+  }
+  /* A new reader of the tiers or dialects shouldn't wait for a heartbeat */
+  const bool keep = NetworkHandler::GetVariantDemand();
+  if (keep && !frameKept) {
+    frameForced = true;
+  }
+  frameKept = keep;
 }
 
 SCSAPI_VOID telemetry_frame_end(const scs_event_t UNUSED(event),
                                 const void *const UNUSED(event_info),
                                 scs_context_t UNUSED(context)) {
-  if (frameChanged) {
-    eventQueue.PushEvent(serializer->SerializeFrame(&telemetryData),
-                         EVENT_FRAME);
+  CallbackTimer timer(MetricCallback::FrameEnd);
+  AllocationScope scope(AllocationStage::Other);
+  const int64_t now = message_clock_ns();
+  const bool emit =
+      frameScheduler.ShouldEmit(&telemetryData, frameChanged, frameForced);
+  /* Local readers get every change, the idle mode only throttles the network */
+  if (sharedFrame != nullptr && (frameChanged || frameForced)) {
+    scope.Enter(AllocationStage::Snapshot);
+    sharedFrame->Publish(telemetryData);
+  }
+  if (emit) {
+    const int64_t snapshot = message_clock_ns();
+    /* Written straight into a pooled buffer that has room for the last one */
+    scope.Enter(AllocationStage::Queue);
+    MessageRef frame = eventQueue.Acquire(frameSize);
+    MessageTrace &trace = frame.Trace();
+    trace.points[static_cast<size_t>(TracePoint::FrameEnd)] = now;
+    trace.points[static_cast<size_t>(TracePoint::Snapshot)] = snapshot;
+    if (pluginOptions.timestamps) {
+      frame.SetTimestamp(now);
+    }
+    scope.Enter(AllocationStage::Encode);
+    trace.Mark(TracePoint::EncodeStart);
+    serializer->SerializeFrame(&telemetryData, &*frame);
+    trace.Mark(TracePoint::EncodeEnd);
+    frameSize = frame->size();
+    Metrics::Pipeline().framesEmitted.Add();
+    Metrics::CountMessage(MetricMessage::Frame, frameSize,
+                          trace.At(TracePoint::EncodeStart),
+                          trace.At(TracePoint::EncodeEnd));
+    if (frameKept) {
+      scope.Enter(AllocationStage::Snapshot);
+      frame.KeepFrame(telemetryData);
+    }
+    scope.Enter(AllocationStage::Queue);
+    eventQueue.PushEvent(std::move(frame), EVENT_FRAME);
+  } else {
+    Metrics::Pipeline().framesSuppressed.Add();
   }
   frameChanged = false;
+  frameForced = false;
 }
 
 SCSAPI_VOID telemetry_pause(const scs_event_t UNUSED(event),
@@ -72,438 +147,146 @@ SCSAPI_VOID telemetry_pause(const scs_event_t UNUSED(event),
                             scs_context_t UNUSED(context)) {
   telemetryData.paused = !telemetryData.paused;
   frameChanged = true;
+  frameForced = true;
+}
+
+/* Tells the clients about the block, the frames that follow refer to it */
+static void push_config(TelemetryConfigBlock block, size_t index = 0) {
+  telemetryData.configVersion++;
+  AllocationScope scope(AllocationStage::Queue);
+  MessageRef config = eventQueue.Acquire(configSize);
+  if (pluginOptions.timestamps) {
+    config.SetTimestamp(message_clock_ns());
+  }
+  scope.Enter(AllocationStage::Encode);
+  const int64_t start = message_clock_ns();
+  serializer->SerializeConfig(&telemetryData, block, index, &*config);
+  configSize = std::max(configSize, config->size());
+  Metrics::CountMessage(MetricMessage::Config, config->size(), start,
+                        message_clock_ns());
+  scope.Enter(AllocationStage::Queue);
+  eventQueue.PushEvent(std::move(config), EVENT_CONFIG);
+  frameChanged = true;
+  frameForced = true;
 }
 
 SCSAPI_VOID telemetry_configuration(const scs_event_t UNUSED(event),
                                     const void *const event_info,
                                     scs_context_t UNUSED(context)) {
+  CallbackTimer timer(MetricCallback::Configuration);
   auto info = static_cast<const scs_telemetry_configuration_t *>(event_info);
+  AllocationScope scope(AllocationStage::Store);
   if (strcmp(SCS_TELEMETRY_CONFIG_truck, info->id) == 0) {
     ConfigHandler::HandleTruckConfig(info->attributes, &telemetryData.truck);
+    push_config(TelemetryConfigBlock::Truck);
   } else if (strcmp(SCS_TELEMETRY_CONFIG_job, info->id) == 0) {
     ConfigHandler::HandleJobConfig(info->attributes, &telemetryData.job);
+    push_config(TelemetryConfigBlock::Job);
   } else if (strcmp(SCS_TELEMETRY_CONFIG_controls, info->id) == 0) {
     ConfigHandler::HandleControlConfig(info->attributes, &telemetryData.truck);
+    push_config(TelemetryConfigBlock::Truck);
   } else if (strncmp(SCS_TELEMETRY_CONFIG_trailer, info->id, 7) == 0) {
-    size_t id_len = strlen(info->id);
-    if (id_len == 7) {
-      ConfigHandler::HandleTrailerConfig(info->attributes,
-                                         &telemetryData.trailer[0]);
-    } else {
-      std::string id(info->id);
-      int trailerId = atoi(id.substr(id.find(".") + 1).c_str());
-      if (trailerId > 9) {
+    /* Either "trailer" or "trailer.<index>" */
+    unsigned trailerId = 0;
+    if (info->id[7] == '.') {
+      const char *first = info->id + 8;
+      const auto result =
+          std::from_chars(first, first + strlen(first), trailerId);
+      if (result.ec != std::errc() || trailerId >= MAX_TRAILERS) {
         return;
       }
-      ConfigHandler::HandleTrailerConfig(info->attributes,
-                                         &telemetryData.trailer[trailerId]);
+    } else if (info->id[7] != '\0') {
+      return;
     }
-  } else {
-    return;
+    ConfigHandler::HandleTrailerConfig(info->attributes,
+                                       &telemetryData.trailer[trailerId]);
+    push_config(TelemetryConfigBlock::Trailer, trailerId);
   }
-  frameChanged = true;
 }
 
 SCSAPI_VOID telemetry_gameplay(const scs_event_t UNUSED(event),
                                const void *const event_info,
                                scs_context_t UNUSED(context)) {
+  CallbackTimer timer(MetricCallback::Gameplay);
   auto info = static_cast<const scs_telemetry_gameplay_event_t *>(event_info);
-  if (std::string(info->id).find("job") != std::string::npos) {
+  AllocationScope scope(AllocationStage::Store);
+  TelemetryGameplayEvent gameplayEvent;
+  gameplayEvent.eventType = info->id;
+  if (gameplayEvent.eventType.starts_with("job.")) {
     telemetryData.job = {};
+    push_config(TelemetryConfigBlock::Job);
   }
-  TelemetryGameplayEvent eventObj = {};
-  eventObj.eventType = info->id;
+  TelemetryGameplayAttribute *const attributes = gameplayEvent.attributes;
   for (auto attr = info->attributes; attr->name; ++attr) {
     switch (attr->value.type) {
     case SCS_VALUE_TYPE_string:
-      eventObj.attributes[std::string(attr->name)] =
-          attr->value.value_string.value;
-      break;
     case SCS_VALUE_TYPE_float:
-      eventObj.attributes[std::string(attr->name)] =
-          attr->value.value_float.value;
-      break;
     case SCS_VALUE_TYPE_double:
-      eventObj.attributes[std::string(attr->name)] =
-          attr->value.value_double.value;
-      break;
     case SCS_VALUE_TYPE_s32:
-      eventObj.attributes[std::string(attr->name)] =
-          attr->value.value_s32.value;
-      break;
     case SCS_VALUE_TYPE_s64:
-      eventObj.attributes[std::string(attr->name)] =
-          attr->value.value_s64.value;
-      break;
     case SCS_VALUE_TYPE_u32:
-      eventObj.attributes[std::string(attr->name)] =
-          attr->value.value_u32.value;
-      break;
     case SCS_VALUE_TYPE_u64:
-      eventObj.attributes[std::string(attr->name)] =
-          attr->value.value_u64.value;
-      break;
-    case SCS_VALUE_TYPE_bool:
-      eventObj.attributes[std::string(attr->name)] =
-          attr->value.value_bool.value != 0;
+    case SCS_VALUE_TYPE_bool: {
+      /* A repeated name keeps the last value, each name is one key */
+      const std::string_view name = attr->name;
+      TelemetryGameplayAttribute *attribute = std::find_if(
+          attributes, attributes + gameplayEvent.attributeCount,
+          [name](const TelemetryGameplayAttribute &other) {
+            return other.name == name;
+          });
+      if (attribute == attributes + gameplayEvent.attributeCount) {
+        if (gameplayEvent.attributeCount == MAX_GAMEPLAY_ATTRIBUTES) {
+          break;
+        }
+        gameplayEvent.attributeCount++;
+        attribute->name = name;
+        attribute->key = gameplay_attribute_key(name);
+      }
+      attribute->value = attr->value;
       break;
+    }
     default:
       break;
     }
   }
-  eventQueue.PushEvent(serializer->SerializeEvent(&eventObj), EVENT_GAMEPLAY);
-}
-
-SCSAPI_VOID channel_wrapper(scs_string_t name, scs_u32_t index,
-                            const scs_value_t *value, scs_context_t context) {
-  switch (value->type) {
-  case SCS_VALUE_TYPE_bool:
-    ScsVariableSaver::StoreScsBool(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_double:
-    ScsVariableSaver::StoreScsDouble(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_float:
-    ScsVariableSaver::StoreScsFloat(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_s32:
-    ScsVariableSaver::StoreScsS32(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_s64:
-    ScsVariableSaver::StoreScsS64(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_u32:
-    ScsVariableSaver::StoreScsU32(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_u64:
-    ScsVariableSaver::StoreScsU64(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_string:
-    ScsVariableSaver::StoreScsString(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_dvector:
-    ScsVariableSaver::StoreScsVector(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_euler:
-    ScsVariableSaver::StoreScsOrientation(name, index, value, context);
-    break;
-  case SCS_VALUE_TYPE_dplacement:
-    ScsVariableSaver::StoreScsPlacement(name, index, value, context);
-    break;
-  default:
-    gameLog(SCS_LOG_TYPE_warning,
-            "TSTelemetryServer: Invalid channel value type!");
-    return;
+  scope.Enter(AllocationStage::Queue);
+  MessageRef message = eventQueue.Acquire(GAMEPLAY_EVENT_RESERVE);
+  if (pluginOptions.timestamps) {
+    message.SetTimestamp(message_clock_ns());
   }
-  frameChanged = true;
+  scope.Enter(AllocationStage::Encode);
+  const int64_t start = message_clock_ns();
+  serializer->SerializeEvent(&gameplayEvent, &*message);
+  Metrics::CountMessage(MetricMessage::Gameplay, message->size(), start,
+                        message_clock_ns());
+  scope.Enter(AllocationStage::Queue);
+  eventQueue.PushEvent(std::move(message), EVENT_GAMEPLAY);
 }
 
-/* The handling of the trailer indexes in channel names is ugly */
-const char *trailer_indexed_channel_name(std::string channel_name,
-                                         scs_u32_t trailer_index) {
-  return channel_name
-      .replace(0, 7, std::string("trailer.") + std::to_string(trailer_index))
-      .c_str();
-}
-
-#define REGISTER_CHANNEL(name, i, type, context)                               \
-  registerChannel(name, i, type, scs_u32_t(0), channel_wrapper, context)
-SCSAPI_VOID
-register_channels(scs_telemetry_register_for_channel_t registerChannel) {
-  /* General channels */
-  REGISTER_CHANNEL(SCS_TELEMETRY_CHANNEL_game_time, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_u32, &telemetryData.gameTime);
-  REGISTER_CHANNEL(SCS_TELEMETRY_CHANNEL_local_scale, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.localScale);
-  REGISTER_CHANNEL(SCS_TELEMETRY_CHANNEL_multiplayer_time_offset, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_s32, &telemetryData.multiplayerTimeOffset);
-  REGISTER_CHANNEL(SCS_TELEMETRY_CHANNEL_next_rest_stop, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_s32, &telemetryData.restStop);
-
-  /* Non-indexed truck channels */
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_world_placement, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_dplacement,
-                   &telemetryData.truck.worldPlacement);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_local_linear_velocity,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_dvector,
-                   &telemetryData.truck.localLinearVelocity);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_local_linear_acceleration,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_dvector,
-                   &telemetryData.truck.localLinearAcceleration);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_local_angular_acceleration,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_dvector,
-                   &telemetryData.truck.localAngularAcceleration);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_local_angular_velocity,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_dvector,
-                   &telemetryData.truck.localAngularVelocity);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_cabin_offset, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_dplacement,
-                   &telemetryData.truck.cabin.offset);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_cabin_angular_acceleration,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_dvector,
-                   &telemetryData.truck.cabin.angularAcceleration);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_cabin_angular_velocity,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_dvector,
-                   &telemetryData.truck.cabin.angularVelocity);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_head_offset, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_dplacement, &telemetryData.truck.headOffset);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_speed, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.speed);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_engine_rpm, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.engine.rpm);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_engine_gear, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_s32, &telemetryData.truck.engine.gear);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_engine_enabled, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.engine.enabled);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_displayed_gear, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_s32, &telemetryData.truck.displayedGear);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_input_steering, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.input.steering);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_input_brake, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.input.brake);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_input_throttle, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.input.throttle);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_input_clutch, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.input.clutch);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_effective_steering, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.effective.steering);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_effective_brake, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.effective.brake);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_effective_throttle, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.effective.throttle);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_effective_clutch, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.effective.clutch);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_cruise_control, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.cruiseControl);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_parking_brake, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.brake.parking);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_motor_brake, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.brake.motor);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_retarder_level, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_u32, &telemetryData.truck.brake.retarder);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_brake_air_pressure, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.brake.airPressure);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_brake_air_pressure_warning,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_bool,
-                   &telemetryData.truck.brake.airPressureWarning);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_brake_air_pressure_emergency,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_bool,
-                   &telemetryData.truck.brake.airPressureEmergency);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_brake_temperature, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.brake.temperature);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_fuel, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.fuel.amount);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_fuel_average_consumption,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.fuel.averageConsumption);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_fuel_range, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.fuel.range);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_fuel_warning, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.fuel.warning);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_adblue, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.adblue.amount);
-  /* Not supported by the latest game version (yet) */
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_adblue_average_consumption,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.adblue.averageConsumption);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_adblue_warning, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.adblue.warning);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_oil_pressure, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.oil.pressure);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_oil_temperature, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.oil.temperature);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_oil_pressure_warning,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_bool,
-                   &telemetryData.truck.oil.pressureWarning);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_water_temperature, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.waterTemperature);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_water_temperature_warning,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_bool,
-                   &telemetryData.truck.waterTemperatureWarning);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_battery_voltage, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.batteryVoltage);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_battery_voltage_warning,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_bool,
-                   &telemetryData.truck.batteryVoltageWarning);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_electric_enabled, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.electricEnabled);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_lblinker, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.leftBlinker);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_rblinker, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.rightBlinker);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_hazard_warning, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.hazardWarning);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_lblinker, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.light.leftBlinker);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_rblinker, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool,
-                   &telemetryData.truck.light.rightBlinker);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_parking, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.light.parking);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_low_beam, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.light.lowBeam);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_high_beam, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.light.highBeam);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_aux_front, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_u32, &telemetryData.truck.light.auxFront);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_aux_roof, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_u32, &telemetryData.truck.light.auxRoof);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_beacon, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.light.beacon);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_brake, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.light.brake);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_light_reverse, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.light.reverse);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wipers, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.wipers);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_dashboard_backlight, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.dashboardBacklight);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_differential_lock, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.differentialLock);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_lift_axle, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.liftAxle);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_lift_axle_indicator, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.liftAxleIndicator);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_trailer_lift_axle, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_bool, &telemetryData.truck.trailerLiftAxle);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_trailer_lift_axle_indicator,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_bool,
-                   &telemetryData.truck.trailerLiftAxleIndicator);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wear_cabin, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.wear.cabin);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wear_chassis, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.wear.chassis);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wear_engine, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.wear.engine);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wear_transmission, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.wear.transmission);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wear_wheels, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.wear.wheels);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_odometer, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.odometer);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_navigation_distance, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.navigation.distance);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_navigation_speed_limit,
-                   SCS_U32_NIL, SCS_VALUE_TYPE_double,
-                   &telemetryData.truck.navigation.speed_limit);
-  REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_navigation_time, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_double, &telemetryData.truck.navigation.time);
-
-  /* Indexed truck channels */
-  /* Wheels */
-  for (scs_u32_t j = 0; j < MAX_WHEEL_COUNT; ++j) {
-    REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wheel_susp_deflection, j,
-                     SCS_VALUE_TYPE_double,
-                     &telemetryData.truck.wheels[j].suspensionDeflection);
-    REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wheel_rotation, j,
-                     SCS_VALUE_TYPE_double,
-                     &telemetryData.truck.wheels[j].rotation);
-    REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wheel_velocity, j,
-                     SCS_VALUE_TYPE_double,
-                     &telemetryData.truck.wheels[j].velocity);
-    REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wheel_steering, j,
-                     SCS_VALUE_TYPE_double,
-                     &telemetryData.truck.wheels[j].steering);
-    REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wheel_lift, j,
-                     SCS_VALUE_TYPE_double,
-                     &telemetryData.truck.wheels[j].lift);
-    REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wheel_lift_offset, j,
-                     SCS_VALUE_TYPE_double,
-                     &telemetryData.truck.wheels[j].liftOffset);
-    REGISTER_CHANNEL(SCS_TELEMETRY_TRUCK_CHANNEL_wheel_on_ground, j,
-                     SCS_VALUE_TYPE_bool,
-                     &telemetryData.truck.wheels[j].isOnGround);
+/*
+ * Frees whatever init got to, it's also called when init fails halfway,
+ * the game only calls scs_telemetry_shutdown after a successful init
+ */
+static void shutdown() {
+  const bool running = networkThread != nullptr;
+  if (running) {
+    /* The destructor of jthread does the stop request and joins the thread
+     * automatically, don't do that twice */
+    delete networkThread;
+    networkThread = nullptr;
+    NetworkHandler::Cleanup();
   }
-  /* Trailer channels */
-  for (scs_u32_t i = 0; i < MAX_TRAILERS; ++i) {
-    /* Non-indexed */
-    REGISTER_CHANNEL(trailer_indexed_channel_name(
-                         SCS_TELEMETRY_TRAILER_CHANNEL_connected, i),
-                     SCS_U32_NIL, SCS_VALUE_TYPE_bool,
-                     &telemetryData.trailer[i].connected);
-    REGISTER_CHANNEL(trailer_indexed_channel_name(
-                         SCS_TELEMETRY_TRAILER_CHANNEL_cargo_damage, i),
-                     SCS_U32_NIL, SCS_VALUE_TYPE_double,
-                     &telemetryData.trailer[i].cargoDamage);
-    REGISTER_CHANNEL(trailer_indexed_channel_name(
-                         SCS_TELEMETRY_TRAILER_CHANNEL_world_placement, i),
-                     SCS_U32_NIL, SCS_VALUE_TYPE_dplacement,
-                     &telemetryData.trailer[i].worldPlacement);
-    REGISTER_CHANNEL(
-        trailer_indexed_channel_name(
-            SCS_TELEMETRY_TRAILER_CHANNEL_local_linear_velocity, i),
-        SCS_U32_NIL, SCS_VALUE_TYPE_dvector,
-        &telemetryData.trailer[i].localLinearVelocity);
-    REGISTER_CHANNEL(
-        trailer_indexed_channel_name(
-            SCS_TELEMETRY_TRAILER_CHANNEL_local_linear_acceleration, i),
-        SCS_U32_NIL, SCS_VALUE_TYPE_dvector,
-        &telemetryData.trailer[i].localLinearAcceleration);
-    REGISTER_CHANNEL(
-        trailer_indexed_channel_name(
-            SCS_TELEMETRY_TRAILER_CHANNEL_local_angular_acceleration, i),
-        SCS_U32_NIL, SCS_VALUE_TYPE_dvector,
-        &telemetryData.trailer[i].localAngularAcceleration);
-    REGISTER_CHANNEL(trailer_indexed_channel_name(
-                         SCS_TELEMETRY_TRAILER_CHANNEL_wear_body, i),
-                     SCS_U32_NIL, SCS_VALUE_TYPE_double,
-                     &telemetryData.trailer[i].wear.body);
-    REGISTER_CHANNEL(trailer_indexed_channel_name(
-                         SCS_TELEMETRY_TRAILER_CHANNEL_wear_chassis, i),
-                     SCS_U32_NIL, SCS_VALUE_TYPE_double,
-                     &telemetryData.trailer[i].wear.chassis);
-    REGISTER_CHANNEL(trailer_indexed_channel_name(
-                         SCS_TELEMETRY_TRAILER_CHANNEL_wear_wheels, i),
-                     SCS_U32_NIL, SCS_VALUE_TYPE_double,
-                     &telemetryData.trailer[i].wear.wheels);
-
-    /* Indexed(what?!) */
-    /* Wheels */
-    for (scs_u32_t j = 0; j < MAX_WHEEL_COUNT; ++j) {
-      REGISTER_CHANNEL(
-          trailer_indexed_channel_name(
-              SCS_TELEMETRY_TRAILER_CHANNEL_wheel_susp_deflection, i),
-          j, SCS_VALUE_TYPE_double,
-          &telemetryData.trailer[i].wheels[j].suspensionDeflection);
-      REGISTER_CHANNEL(trailer_indexed_channel_name(
-                           SCS_TELEMETRY_TRAILER_CHANNEL_wheel_rotation, i),
-                       j, SCS_VALUE_TYPE_double,
-                       &telemetryData.trailer[i].wheels[j].rotation);
-      REGISTER_CHANNEL(trailer_indexed_channel_name(
-                           SCS_TELEMETRY_TRAILER_CHANNEL_wheel_velocity, i),
-                       j, SCS_VALUE_TYPE_double,
-                       &telemetryData.trailer[i].wheels[j].velocity);
-      REGISTER_CHANNEL(trailer_indexed_channel_name(
-                           SCS_TELEMETRY_TRAILER_CHANNEL_wheel_steering, i),
-                       j, SCS_VALUE_TYPE_double,
-                       &telemetryData.trailer[i].wheels[j].steering);
-      REGISTER_CHANNEL(trailer_indexed_channel_name(
-                           SCS_TELEMETRY_TRAILER_CHANNEL_wheel_lift, i),
-                       j, SCS_VALUE_TYPE_double,
-                       &telemetryData.trailer[i].wheels[j].lift);
-      REGISTER_CHANNEL(trailer_indexed_channel_name(
-                           SCS_TELEMETRY_TRAILER_CHANNEL_wheel_lift_offset, i),
-                       j, SCS_VALUE_TYPE_double,
-                       &telemetryData.trailer[i].wheels[j].liftOffset);
-      REGISTER_CHANNEL(trailer_indexed_channel_name(
-                           SCS_TELEMETRY_TRAILER_CHANNEL_wheel_on_ground, i),
-                       j, SCS_VALUE_TYPE_bool,
-                       &telemetryData.trailer[i].wheels[j].isOnGround);
-    }
+  delete serializer;
+  serializer = nullptr;
+  /* The SDK drops the registrations itself after shutdown */
+  delete channelRegistry;
+  channelRegistry = nullptr;
+  /* Unlinks the shared memory object */
+  delete sharedFrame;
+  sharedFrame = nullptr;
+  if (running) {
+    gameLog(SCS_LOG_TYPE_message, "TSTelemetryServer: Cleanup successful!");
   }
-
-  /* Job channels */
-  REGISTER_CHANNEL(SCS_TELEMETRY_JOB_CHANNEL_cargo_damage, SCS_U32_NIL,
-                   SCS_VALUE_TYPE_float, &telemetryData.job.cargoDamage);
 }
 
 SCSAPI_RESULT
@@ -514,7 +297,10 @@ scs_telemetry_init(const scs_u32_t version,
   const scs_telemetry_init_params_v101_t *const version_params =
       static_cast<const scs_telemetry_init_params_v101_t *>(params);
   gameLog = version_params->common.log;
+  /* The game calls every callback from the thread it initializes us on */
+  AllocationStats::NameThread("game");
   auto registerChannel = version_params->register_for_channel;
+  auto unregisterChannel = version_params->unregister_from_channel;
   auto registerEvent = version_params->register_for_event;
   scs_u32_t minSupportedVersion = scs_u32_t(0);
 
@@ -536,6 +322,20 @@ scs_telemetry_init(const scs_u32_t version,
 
   serializer = new JsonTelemetrySerializer;
 
+  pluginOptions = PluginOptionsLoader::Load();
+  if (!pluginOptions.sharedMemoryName.empty()) {
+    /* Optional, the plugin keeps working without it */
+    try {
+      sharedFrame = new SharedFramePublisher(pluginOptions.sharedMemoryName);
+      gameLog(SCS_LOG_TYPE_message,
+              "TSTelemetryServer: Publishing frames in shared memory!");
+    } catch (std::exception &e) {
+      std::string error = "TSTelemetryServer: ";
+      error.append(e.what());
+      gameLog(SCS_LOG_TYPE_warning, error.c_str());
+    }
+  }
+
   const auto eventRegistration =
       (registerEvent(SCS_TELEMETRY_EVENT_configuration, telemetry_configuration,
                      NULL) == SCS_RESULT_ok) &&
@@ -552,40 +352,30 @@ scs_telemetry_init(const scs_u32_t version,
   if (!eventRegistration) {
     gameLog(SCS_LOG_TYPE_error,
             "TSTelemetryServer: Unable to register events!");
+    shutdown();
     return SCS_RESULT_generic_error;
   }
   gameLog(SCS_LOG_TYPE_message, "TSTelemetryServer: Registered events!");
 
-  register_channels(registerChannel);
-  gameLog(SCS_LOG_TYPE_message, "TSTelemetryServer: Registered channels!");
+  channelRegistry =
+      new ChannelRegistry(registerChannel, unregisterChannel, &telemetryData);
+  gameLog(SCS_LOG_TYPE_message,
+          "TSTelemetryServer: Registered required channels, the rest follows "
+          "the connected clients!");
 
   try {
-    networkThread = NetworkHandler::GetEventThread(&eventQueue);
+    networkThread = NetworkHandler::GetEventThread(&eventQueue, pluginOptions);
   } catch (std::exception &e) {
     std::string error = "TSTelemetryServer: ";
     error.append(e.what());
     gameLog(SCS_LOG_TYPE_error, error.c_str());
+    shutdown();
     return SCS_RESULT_generic_error;
   }
   gameLog(SCS_LOG_TYPE_message, "TSTelemetryServer: Plugin init complete!");
   return SCS_RESULT_ok;
 }
 
-inline void shutdown() {
-  if (networkThread != nullptr) {
-    /* The destructor of jthread does the stop request and joins the thread
-     * automatically, don't do that twice */
-    delete networkThread;
-    networkThread = nullptr;
-    NetworkHandler::Cleanup();
-    if (serializer != nullptr) {
-      delete serializer;
-      serializer = nullptr;
-    }
-    gameLog(SCS_LOG_TYPE_message, "TSTelemetryServer: Cleanup successful!");
-  }
-}
-
 SCSAPI_VOID scs_telemetry_shutdown() { shutdown(); }
 
 #ifdef _WIN32
@@ -0,0 +1,110 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "udp_publisher.h"
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#endif
+
+UdpPublisher::UdpPublisher(const std::string &target, int redundancy)
+    : m_redundancy(redundancy) {
+  const size_t colon = target.rfind(':');
+  unsigned short port = 0;
+  memset(&m_target, 0, sizeof(m_target));
+  m_target.sin_family = AF_INET;
+  if (colon == std::string::npos ||
+      std::from_chars(target.data() + colon + 1,
+                      target.data() + target.size(), port)
+              .ec != std::errc() ||
+      inet_pton(AF_INET, target.substr(0, colon).c_str(),
+                &m_target.sin_addr) != 1) {
+    throw std::runtime_error("Invalid UDP target, expected address:port!");
+  }
+  m_target.sin_port = htons(port);
+
+  m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+  if (m_socket == INVALID_SOCKET) {
+    throw std::runtime_error("Unable to create UDP socket!");
+  }
+  const uint32_t address = ntohl(m_target.sin_addr.s_addr);
+  int flag = 1;
+  int ttl = UDP_MULTICAST_TTL;
+  /* 224.0.0.0/4 is multicast, anything else may be a broadcast address */
+  const int result =
+      (address >> 28) == 0xE
+          ? setsockopt(m_socket, IPPROTO_IP, IP_MULTICAST_TTL,
+                       reinterpret_cast<char *>(&ttl), sizeof(ttl))
+          : setsockopt(m_socket, SOL_SOCKET, SO_BROADCAST,
+                       reinterpret_cast<char *>(&flag), sizeof(flag));
+  if (result < 0) {
+    CLOSE_SOCKET(m_socket);
+    throw std::runtime_error("Unable to set UDP socket options!");
+  }
+}
+
+UdpPublisher::~UdpPublisher() { CLOSE_SOCKET(m_socket); }
+
+void UdpPublisher::Publish(const std::string &event, bool frame) {
+  if (!frame) {
+    const uint32_t sequence = ++m_eventSequence;
+    send(event, UdpStream::Event, sequence);
+    if (m_redundancy > 0) {
+      m_repeats.push_back({event, sequence, m_redundancy});
+    }
+    return;
+  }
+  send(event, UdpStream::Frame, ++m_frameSequence);
+  for (Repeat &repeat : m_repeats) {
+    send(repeat.event, UdpStream::Event, repeat.sequence);
+    --repeat.remaining;
+  }
+  std::erase_if(m_repeats, [](const Repeat &repeat) noexcept {
+    return repeat.remaining <= 0;
+  });
+}
+
+void UdpPublisher::send(const std::string &event, UdpStream stream,
+                        uint32_t sequence) {
+  UdpFragmentHeader header;
+  header.magic = UDP_MAGIC;
+  header.sequence = sequence;
+  header.messageSize = static_cast<uint32_t>(event.size());
+  header.fragmentCount = static_cast<uint16_t>(
+      (event.size() + UDP_FRAGMENT_PAYLOAD - 1) / UDP_FRAGMENT_PAYLOAD);
+  header.stream = stream;
+  for (uint16_t i = 0; i < header.fragmentCount; ++i) {
+    const size_t offset = static_cast<size_t>(i) * UDP_FRAGMENT_PAYLOAD;
+    const size_t size =
+        std::min<size_t>(event.size() - offset, UDP_FRAGMENT_PAYLOAD);
+    header.fragmentIndex = i;
+    UdpWire::WriteHeader(header, m_datagram);
+    memcpy(m_datagram + UDP_HEADER_SIZE, event.data() + offset, size);
+    /* Best effort, receivers cope with anything that gets lost */
+    sendto(m_socket, reinterpret_cast<const char *>(m_datagram),
+           static_cast<int>(UDP_HEADER_SIZE + size), 0,
+           reinterpret_cast<const struct sockaddr *>(&m_target),
+           sizeof(m_target));
+  }
+}
@@ -0,0 +1,354 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "websocket.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+#ifdef TSTS_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+/* The handshake is the only user, speed doesn't matter */
+void sha1(std::string_view message, unsigned char digest[20]) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476,
+                   0xC3D2E1F0};
+  std::string data(message);
+  const uint64_t bits = static_cast<uint64_t>(message.size()) * 8;
+  data.push_back('\x80');
+  while (data.size() % 64 != 56) {
+    data.push_back('\0');
+  }
+  for (int i = 7; i >= 0; --i) {
+    data.push_back(static_cast<char>(bits >> (i * 8)));
+  }
+  auto rotl = [](uint32_t x, int n) { return x << n | x >> (32 - n); };
+  for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; ++i) {
+      const auto *p =
+          reinterpret_cast<const unsigned char *>(data.data() + chunk + i * 4);
+      w[i] = static_cast<uint32_t>(p[0]) << 24 |
+             static_cast<uint32_t>(p[1]) << 16 |
+             static_cast<uint32_t>(p[2]) << 8 | p[3];
+    }
+    for (int i = 16; i < 80; ++i) {
+      w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; ++i) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+      const uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = temp;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+  for (int i = 0; i < 20; ++i) {
+    digest[i] = static_cast<unsigned char>(h[i / 4] >> (24 - (i % 4) * 8));
+  }
+}
+
+std::string base64(const unsigned char *data, size_t size) {
+  static const char alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < size; i += 3) {
+    const uint32_t n = static_cast<uint32_t>(data[i]) << 16 |
+                       (i + 1 < size ? data[i + 1] << 8 : 0) |
+                       (i + 2 < size ? data[i + 2] : 0);
+    out.push_back(alphabet[n >> 18 & 63]);
+    out.push_back(alphabet[n >> 12 & 63]);
+    out.push_back(i + 1 < size ? alphabet[n >> 6 & 63] : '=');
+    out.push_back(i + 2 < size ? alphabet[n & 63] : '=');
+  }
+  return out;
+}
+
+/*
+ * Accepts the first permessage-deflate offer whose parameters the plugin
+ * supports and returns the matching response, empty if there's none.
+ */
+std::string negotiateDeflate(std::string_view offers,
+                             DeflateParameters *deflate) {
+#ifdef TSTS_WITH_ZLIB
+  while (!offers.empty()) {
+    const size_t comma = offers.find(',');
+    std::string_view offer = offers.substr(0, comma);
+    offers = comma == std::string_view::npos ? std::string_view()
+                                             : offers.substr(comma + 1);
+    const size_t semicolon = offer.find(';');
+    if (HttpParser::Trim(offer.substr(0, semicolon)) != "permessage-deflate") {
+      continue;
+    }
+    DeflateParameters parameters;
+    std::string response = "permessage-deflate";
+    bool supported = true;
+    offer = semicolon == std::string_view::npos ? std::string_view()
+                                                : offer.substr(semicolon + 1);
+    while (!offer.empty() && supported) {
+      const size_t next = offer.find(';');
+      const std::string_view parameter =
+          HttpParser::Trim(offer.substr(0, next));
+      offer = next == std::string_view::npos ? std::string_view()
+                                             : offer.substr(next + 1);
+      const size_t equals = parameter.find('=');
+      const std::string_view name = parameter.substr(0, equals);
+      std::string_view value =
+          equals == std::string_view::npos
+              ? std::string_view()
+              : HttpParser::Trim(parameter.substr(equals + 1));
+      if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        value = value.substr(1, value.size() - 2);
+      }
+      if (name == "server_no_context_takeover") {
+        parameters.noContextTakeover = true;
+        response.append("; server_no_context_takeover");
+      } else if (name == "server_max_window_bits") {
+        /* zlib can't do raw deflate with 8 bit windows */
+        int bits = 0;
+        std::from_chars(value.data(), value.data() + value.size(), bits);
+        supported = bits >= 9 && bits <= 15;
+        parameters.windowBits = bits;
+        response.append("; server_max_window_bits=").append(value);
+      } else if (name != "client_no_context_takeover" &&
+                 name != "client_max_window_bits") {
+        /* The plugin never inflates, client parameters don't matter */
+        supported = false;
+      }
+    }
+    if (supported) {
+      parameters.enabled = true;
+      *deflate = parameters;
+      return response;
+    }
+  }
+#else
+  (void)offers;
+  (void)deflate;
+#endif
+  return std::string();
+}
+
+} // namespace
+
+bool WebSocket::IsUpgrade(const HttpRequest &request) {
+  return request.method == "GET" &&
+         request.HeaderHasToken("Upgrade", "websocket") &&
+         request.HeaderHasToken("Connection", "Upgrade") &&
+         request.Header("Sec-WebSocket-Version") == "13" &&
+         !request.Header("Sec-WebSocket-Key").empty();
+}
+
+std::string WebSocket::Handshake(const HttpRequest &request,
+                                 DeflateParameters *deflate) {
+  unsigned char digest[20];
+  std::string key(request.Header("Sec-WebSocket-Key"));
+  key.append("258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+  sha1(key, digest);
+  std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+                         "Upgrade: websocket\r\n"
+                         "Connection: Upgrade\r\n"
+                         "Sec-WebSocket-Accept: ";
+  response.append(base64(digest, sizeof(digest))).append("\r\n");
+  const std::string extension =
+      negotiateDeflate(request.Header("Sec-WebSocket-Extensions"), deflate);
+  if (!extension.empty()) {
+    response.append("Sec-WebSocket-Extensions: ")
+        .append(extension)
+        .append("\r\n");
+  }
+  response.append("\r\n");
+  return response;
+}
+
+void WebSocket::AppendHeader(std::string *out, uint8_t opcode,
+                             size_t payloadSize, bool compressed) {
+  out->push_back(static_cast<char>(0x80 | (compressed ? 0x40 : 0) | opcode));
+  if (payloadSize < 126) {
+    out->push_back(static_cast<char>(payloadSize));
+  } else if (payloadSize <= 0xFFFF) {
+    out->push_back(126);
+    out->push_back(static_cast<char>(payloadSize >> 8));
+    out->push_back(static_cast<char>(payloadSize));
+  } else {
+    out->push_back(127);
+    for (int i = 7; i >= 0; --i) {
+      out->push_back(
+          static_cast<char>(static_cast<uint64_t>(payloadSize) >> (i * 8)));
+    }
+  }
+}
+
+size_t WebSocket::ParseClientFrame(std::string_view buffer,
+                                   WebSocketFrame *frame) {
+  if (buffer.size() < 2) {
+    return 0;
+  }
+  const auto *in = reinterpret_cast<const unsigned char *>(buffer.data());
+  /* Clients have to mask their frames */
+  if (!(in[1] & 0x80)) {
+    return SIZE_MAX;
+  }
+  size_t header = 2;
+  uint64_t payloadSize = in[1] & 0x7F;
+  if (payloadSize == 126) {
+    header += 2;
+  } else if (payloadSize == 127) {
+    header += 8;
+  }
+  if (buffer.size() < header + 4) {
+    return 0;
+  }
+  if (payloadSize >= 126) {
+    payloadSize = 0;
+    for (size_t i = 2; i < header; ++i) {
+      payloadSize = payloadSize << 8 | in[i];
+    }
+  }
+  if (payloadSize > WEBSOCKET_MAX_CLIENT_FRAME) {
+    return SIZE_MAX;
+  }
+  const size_t size = header + 4 + static_cast<size_t>(payloadSize);
+  if (buffer.size() < size) {
+    return 0;
+  }
+  const unsigned char *mask = in + header;
+  frame->fin = in[0] & 0x80;
+  frame->compressed = in[0] & 0x40;
+  frame->opcode = in[0] & 0x0F;
+  frame->payload.assign(buffer.data() + header + 4,
+                        static_cast<size_t>(payloadSize));
+  for (size_t i = 0; i < frame->payload.size(); ++i) {
+    frame->payload[i] = static_cast<char>(frame->payload[i] ^ mask[i % 4]);
+  }
+  return size;
+}
+
+#ifdef TSTS_WITH_ZLIB
+MessageDeflater::MessageDeflater(const DeflateParameters &parameters)
+    : m_stream(new z_stream), m_inflate(new z_stream),
+      m_noContextTakeover(parameters.noContextTakeover) {
+  memset(m_stream, 0, sizeof(z_stream));
+  memset(m_inflate, 0, sizeof(z_stream));
+  /* Negative window bits give a raw deflate stream without zlib header */
+  deflateInit2(m_stream, WEBSOCKET_DEFLATE_LEVEL, Z_DEFLATED,
+               -parameters.windowBits, 8, Z_DEFAULT_STRATEGY);
+  /* Clients may keep their window, so does the inflater */
+  inflateInit2(m_inflate, -15);
+}
+
+MessageDeflater::~MessageDeflater() {
+  deflateEnd(m_stream);
+  inflateEnd(m_inflate);
+  delete m_stream;
+  delete m_inflate;
+}
+
+bool MessageDeflater::Decompress(std::string_view message, std::string *out) {
+  /* Put back the end of the flush the client left out */
+  std::string input(message);
+  input.append("\x00\x00\xff\xff", 4);
+  m_inflate->next_in = reinterpret_cast<Bytef *>(input.data());
+  m_inflate->avail_in = static_cast<uInt>(input.size());
+  out->clear();
+  char buffer[4096];
+  do {
+    m_inflate->next_out = reinterpret_cast<Bytef *>(buffer);
+    m_inflate->avail_out = sizeof(buffer);
+    const int result = inflate(m_inflate, Z_SYNC_FLUSH);
+    if (result != Z_OK && result != Z_BUF_ERROR) {
+      return false;
+    }
+    out->append(buffer, sizeof(buffer) - m_inflate->avail_out);
+    if (out->size() > WEBSOCKET_MAX_CLIENT_FRAME) {
+      return false;
+    }
+    if (result == Z_BUF_ERROR) {
+      break;
+    }
+  } while (m_inflate->avail_in != 0 || m_inflate->avail_out == 0);
+  return true;
+}
+
+bool MessageDeflater::Compress(std::string_view message, std::string *out) {
+  out->resize(deflateBound(m_stream, static_cast<uLong>(message.size())) + 16);
+  m_stream->next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(message.data()));
+  m_stream->avail_in = static_cast<uInt>(message.size());
+  size_t used = 0;
+  for (;;) {
+    m_stream->next_out = reinterpret_cast<Bytef *>(out->data() + used);
+    m_stream->avail_out = static_cast<uInt>(out->size() - used);
+    const int result = deflate(m_stream, Z_SYNC_FLUSH);
+    if (result != Z_OK && result != Z_BUF_ERROR) {
+      return false;
+    }
+    used = out->size() - m_stream->avail_out;
+    if (m_stream->avail_out != 0) {
+      break;
+    }
+    out->resize(out->size() * 2);
+  }
+  /* The flush ends in 00 00 FF FF, which the receiver adds back */
+  out->resize(used - 4);
+  if (m_noContextTakeover) {
+    deflateReset(m_stream);
+  }
+  return true;
+}
+#else
+MessageDeflater::MessageDeflater(const DeflateParameters &parameters)
+    : m_noContextTakeover(parameters.noContextTakeover) {}
+
+MessageDeflater::~MessageDeflater() {}
+
+bool MessageDeflater::Compress(std::string_view, std::string *) {
+  return false;
+}
+
+bool MessageDeflater::Decompress(std::string_view, std::string *) {
+  return false;
+}
+#endif
@@ -0,0 +1,454 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "drive_profile.h"
+#include "synthetic_config.h"
+
+#include "scs_sdk/common/scssdk_telemetry_common_channels.h"
+#include "scs_sdk/common/scssdk_telemetry_common_gameplay_events.h"
+#include "scs_sdk/common/scssdk_telemetry_trailer_common_channels.h"
+#include "scs_sdk/common/scssdk_telemetry_truck_common_channels.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+#define WHEEL_RADIUS 0.52
+#define TRAILER_SPACING 13.6
+/* Litres per metre */
+#define FUEL_CONSUMPTION 0.00035
+#define HIGHWAY_SPEED 24.0
+#define CITY_SPEED 13.9
+/* Accelerate, cruise, brake, wait at the lights */
+#define CITY_CYCLE 40.0
+
+const double Pi = 3.14159265358979323846;
+
+const std::vector<DriveProfile> profiles = {
+    {"highway", "cruising on the motorway with one trailer", 1, 6, 0, 0,
+     false},
+    {"city", "stop and go through town with one trailer", 1, 6, 0, 0, true},
+    {"combination", "a ten trailer combination on the motorway", 10, 4, 0, 0,
+     false},
+    {"config-burst", "the motorway with a configuration burst every second",
+     1, 6, 60, 0, false},
+    {"gameplay", "the motorway with a gameplay event every 10 frames", 1, 6, 0,
+     10, false},
+};
+
+bool is(std::string_view name, const char *channel) { return name == channel; }
+
+/* Trailer channels are "trailer.<index>.<rest>", or "trailer.<rest>" */
+bool trailer_channel(std::string_view name, unsigned *trailer,
+                     std::string_view *rest) {
+  if (name.substr(0, 8) != "trailer.") {
+    return false;
+  }
+  name.remove_prefix(8);
+  *trailer = 0;
+  const auto result =
+      std::from_chars(name.data(), name.data() + name.size(), *trailer);
+  if (result.ptr != name.data() && *result.ptr == '.') {
+    name.remove_prefix(static_cast<size_t>(result.ptr - name.data()) + 1);
+  }
+  *rest = name;
+  return true;
+}
+
+bool is_trailer(std::string_view rest, const char *channel) {
+  return rest == std::string_view(channel).substr(8);
+}
+
+bool set_number(scs_value_t *value, scs_value_type_t type, double number) {
+  switch (type) {
+  case SCS_VALUE_TYPE_float:
+    value->value_float.value = static_cast<scs_float_t>(number);
+    return true;
+  case SCS_VALUE_TYPE_double:
+    value->value_double.value = number;
+    return true;
+  case SCS_VALUE_TYPE_s32:
+    value->value_s32.value = static_cast<scs_s32_t>(std::lround(number));
+    return true;
+  case SCS_VALUE_TYPE_u32:
+    value->value_u32.value =
+        static_cast<scs_u32_t>(std::max(0L, std::lround(number)));
+    return true;
+  case SCS_VALUE_TYPE_s64:
+    value->value_s64.value = static_cast<scs_s64_t>(std::llround(number));
+    return true;
+  case SCS_VALUE_TYPE_u64:
+    value->value_u64.value =
+        static_cast<scs_u64_t>(std::max(0LL, std::llround(number)));
+    return true;
+  case SCS_VALUE_TYPE_bool:
+    value->value_bool.value = number != 0.0 ? 1 : 0;
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool set_vector(scs_value_t *value, scs_value_type_t type, double x, double y,
+                double z) {
+  if (type == SCS_VALUE_TYPE_fvector) {
+    value->value_fvector.x = static_cast<scs_float_t>(x);
+    value->value_fvector.y = static_cast<scs_float_t>(y);
+    value->value_fvector.z = static_cast<scs_float_t>(z);
+    return true;
+  }
+  if (type == SCS_VALUE_TYPE_dvector) {
+    value->value_dvector.x = x;
+    value->value_dvector.y = y;
+    value->value_dvector.z = z;
+    return true;
+  }
+  return false;
+}
+
+/* The SDK has angles in turns, 0.25 is 90 degrees */
+bool set_placement(scs_value_t *value, scs_value_type_t type, double x,
+                   double y, double z, double heading) {
+  const double turns = heading / (2.0 * Pi);
+  switch (type) {
+  case SCS_VALUE_TYPE_fplacement:
+    value->value_fplacement.position.x = static_cast<scs_float_t>(x);
+    value->value_fplacement.position.y = static_cast<scs_float_t>(y);
+    value->value_fplacement.position.z = static_cast<scs_float_t>(z);
+    value->value_fplacement.orientation.heading =
+        static_cast<scs_float_t>(turns);
+    return true;
+  case SCS_VALUE_TYPE_dplacement:
+    value->value_dplacement.position.x = x;
+    value->value_dplacement.position.y = y;
+    value->value_dplacement.position.z = z;
+    value->value_dplacement.orientation.heading =
+        static_cast<scs_float_t>(turns);
+    return true;
+  case SCS_VALUE_TYPE_euler:
+    value->value_euler.heading = static_cast<scs_float_t>(turns);
+    return true;
+  default:
+    return set_vector(value, type, x, y, z);
+  }
+}
+
+scs_named_value_t attribute(scs_string_t name, scs_value_type_t type) {
+  scs_named_value_t attr = {};
+  attr.name = name;
+  attr.index = SCS_U32_NIL;
+  attr.value.type = type;
+  return attr;
+}
+
+scs_named_value_t string_attribute(scs_string_t name, scs_string_t text) {
+  scs_named_value_t attr = attribute(name, SCS_VALUE_TYPE_string);
+  attr.value.value_string.value = text;
+  return attr;
+}
+
+scs_named_value_t money_attribute(scs_string_t name, scs_s64_t amount) {
+  scs_named_value_t attr = attribute(name, SCS_VALUE_TYPE_s64);
+  attr.value.value_s64.value = amount;
+  return attr;
+}
+
+} // namespace
+
+const DriveProfile *DriveSimulation::Find(std::string_view name) {
+  for (const DriveProfile &profile : profiles) {
+    if (name == profile.name) {
+      return &profile;
+    }
+  }
+  return nullptr;
+}
+
+const std::vector<DriveProfile> &DriveSimulation::Profiles() {
+  return profiles;
+}
+
+DriveSimulation::DriveSimulation(const DriveProfile &profile,
+                                 double frameSeconds)
+    : m_profile(profile), m_frameSeconds(frameSeconds) {
+  m_configuration.push_back({"truck", SyntheticConfig::Truck()});
+  m_configuration.push_back({"controls", SyntheticConfig::Controls()});
+  m_configuration.push_back({"job", SyntheticConfig::Job()});
+  for (unsigned i = 0; i < profile.trailers; i++) {
+    m_configuration.push_back(
+        {"trailer." + std::to_string(i),
+         SyntheticConfig::Trailer(profile.trailerWheels)});
+  }
+  m_gameplay.push_back(
+      {SCS_TELEMETRY_GAMEPLAY_EVENT_player_fined,
+       {string_attribute(SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_fine_offence,
+                         "speeding"),
+        money_attribute(SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_fine_amount,
+                        300),
+        scs_named_value_t{}}});
+  m_gameplay.push_back(
+      {SCS_TELEMETRY_GAMEPLAY_EVENT_player_tollgate_paid,
+       {money_attribute(SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_pay_amount, 120),
+        scs_named_value_t{}}});
+  m_gameplay.push_back(
+      {SCS_TELEMETRY_GAMEPLAY_EVENT_player_use_ferry,
+       {money_attribute(SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_pay_amount, 800),
+        string_attribute(SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_source_name,
+                         "Rostock"),
+        string_attribute(SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_target_name,
+                         "Trelleborg"),
+        string_attribute(SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_source_id,
+                         "rostock"),
+        string_attribute(SCS_TELEMETRY_GAMEPLAY_EVENT_ATTRIBUTE_target_id,
+                         "trelleborg"),
+        scs_named_value_t{}}});
+}
+
+void DriveSimulation::Advance() {
+  m_frame++;
+  m_time = static_cast<double>(m_frame) * m_frameSeconds;
+  const double previousSpeed = m_speed;
+  const double previousHeading = m_heading;
+  if (m_profile.stopAndGo) {
+    const double phase = std::fmod(m_time, CITY_CYCLE);
+    if (phase < 10.0) {
+      m_speed = CITY_SPEED * phase / 10.0;
+      m_throttle = 0.7;
+      m_brake = 0.0;
+    } else if (phase < 25.0) {
+      m_speed = CITY_SPEED;
+      m_throttle = 0.3;
+      m_brake = 0.0;
+    } else if (phase < 30.0) {
+      m_speed = CITY_SPEED * (30.0 - phase) / 5.0;
+      m_throttle = 0.0;
+      m_brake = 0.5;
+    } else {
+      m_speed = 0.0;
+      m_throttle = 0.0;
+      m_brake = 0.2;
+    }
+    /* Indicates for the turn at the end of every other block */
+    const bool turning = std::fmod(m_time, 2.0 * CITY_CYCLE) >= CITY_CYCLE;
+    m_blinker = turning && phase >= 22.0 && phase < 30.0 &&
+                std::fmod(phase, 0.8) < 0.4;
+    m_heading = 0.25 * Pi * std::floor(m_time / (2.0 * CITY_CYCLE));
+    m_stopped = phase >= 30.0;
+  } else {
+    m_speed = HIGHWAY_SPEED + 2.0 * std::sin(m_time / 20.0);
+    m_throttle = 0.45 + 0.1 * std::cos(m_time / 20.0);
+    m_brake = 0.0;
+    m_blinker = false;
+    m_heading = 0.3 * std::sin(m_time / 60.0);
+    m_stopped = false;
+  }
+  m_acceleration = (m_speed - previousSpeed) / m_frameSeconds;
+  m_yawRate = (m_heading - previousHeading) / m_frameSeconds;
+  m_distance += m_speed * m_frameSeconds;
+  m_x -= std::sin(m_heading) * m_speed * m_frameSeconds;
+  m_z -= std::cos(m_heading) * m_speed * m_frameSeconds;
+}
+
+bool DriveSimulation::Value(std::string_view name, scs_u32_t index,
+                            scs_value_type_t type, scs_value_t *value) const {
+  *value = {};
+  value->type = type;
+  const double wheelTurns = m_distance / (2.0 * Pi * WHEEL_RADIUS);
+  const double wheelVelocity = m_speed / (2.0 * Pi * WHEEL_RADIUS);
+  const int gear =
+      m_speed < 0.1 ? 0 : std::min(12, 1 + static_cast<int>(m_speed / 2.3));
+  const double fuel = 800.0 - m_distance * FUEL_CONSUMPTION;
+  unsigned trailer;
+  std::string_view rest;
+  if (trailer_channel(name, &trailer, &rest)) {
+    if (is_trailer(rest, SCS_TELEMETRY_TRAILER_CHANNEL_connected)) {
+      return set_number(value, type, trailer < m_profile.trailers);
+    }
+    if (trailer >= m_profile.trailers) {
+      return false;
+    }
+    const double behind = TRAILER_SPACING * (trailer + 1);
+    if (is_trailer(rest, SCS_TELEMETRY_TRAILER_CHANNEL_world_placement)) {
+      return set_placement(value, type, m_x + std::sin(m_heading) * behind,
+                           1.0, m_z + std::cos(m_heading) * behind,
+                           m_heading);
+    }
+    if (is_trailer(rest, SCS_TELEMETRY_TRAILER_CHANNEL_local_linear_velocity)) {
+      return set_vector(value, type, 0.0, 0.0, -m_speed);
+    }
+    if (is_trailer(rest,
+                   SCS_TELEMETRY_TRAILER_CHANNEL_local_linear_acceleration)) {
+      return set_vector(value, type, 0.0, 0.0, -m_acceleration);
+    }
+    if (is_trailer(rest, SCS_TELEMETRY_TRAILER_CHANNEL_wheel_rotation)) {
+      return set_number(value, type, std::fmod(wheelTurns, 1.0));
+    }
+    if (is_trailer(rest, SCS_TELEMETRY_TRAILER_CHANNEL_wheel_velocity)) {
+      return set_number(value, type, wheelVelocity);
+    }
+    if (is_trailer(rest, SCS_TELEMETRY_TRAILER_CHANNEL_wheel_on_ground)) {
+      return set_number(value, type, 1.0);
+    }
+    if (is_trailer(rest, SCS_TELEMETRY_TRAILER_CHANNEL_wheel_susp_deflection)) {
+      return set_number(value, type,
+                        0.02 * std::sin(m_distance / 3.0 + index));
+    }
+    if (is_trailer(rest, SCS_TELEMETRY_TRAILER_CHANNEL_wear_body)) {
+      return set_number(value, type, 0.01 + m_distance * 1e-8);
+    }
+    return set_number(value, type, 0.0) ||
+           set_placement(value, type, 0.0, 0.0, 0.0, 0.0);
+  }
+  if (is(name, SCS_TELEMETRY_CHANNEL_game_time)) {
+    return set_number(value, type, 480.0 + std::floor(m_time * 0.3));
+  }
+  if (is(name, SCS_TELEMETRY_CHANNEL_local_scale)) {
+    return set_number(value, type, 19.0);
+  }
+  if (is(name, SCS_TELEMETRY_CHANNEL_next_rest_stop)) {
+    return set_number(value, type, 660.0 - std::floor(m_time * 0.3));
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_world_placement)) {
+    return set_placement(value, type, m_x, 1.0, m_z, m_heading);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_local_linear_velocity)) {
+    return set_vector(value, type, 0.0, 0.0, -m_speed);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_local_linear_acceleration)) {
+    return set_vector(value, type, 0.0, 0.0, -m_acceleration);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_local_angular_velocity)) {
+    return set_vector(value, type, 0.0, m_yawRate / (2.0 * Pi), 0.0);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_speed)) {
+    return set_number(value, type, m_speed);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_engine_rpm)) {
+    const double rpm =
+        gear == 0 ? 650.0 : 900.0 + std::fmod(m_speed, 2.3) / 2.3 * 700.0;
+    return set_number(value, type, rpm);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_engine_gear) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_displayed_gear)) {
+    return set_number(value, type, gear);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_engine_enabled) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_electric_enabled) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_light_low_beam) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_light_parking) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_wheel_on_ground)) {
+    return set_number(value, type, 1.0);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_input_throttle) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_effective_throttle)) {
+    return set_number(value, type, m_throttle);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_input_brake) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_effective_brake)) {
+    return set_number(value, type, m_brake);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_input_steering) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_effective_steering)) {
+    return set_number(value, type, 0.5 * m_yawRate);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_parking_brake)) {
+    return set_number(value, type, m_stopped);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_light_brake)) {
+    return set_number(value, type, m_brake > 0.0);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_lblinker) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_light_lblinker)) {
+    return set_number(value, type, m_blinker);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_cruise_control)) {
+    return set_number(value, type, m_profile.stopAndGo ? 0.0 : HIGHWAY_SPEED);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_brake_air_pressure)) {
+    return set_number(value, type, 120.0 - 10.0 * m_brake);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_fuel)) {
+    return set_number(value, type, fuel);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_fuel_range)) {
+    return set_number(value, type, fuel / FUEL_CONSUMPTION / 1000.0);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_fuel_average_consumption)) {
+    return set_number(value, type, FUEL_CONSUMPTION * 1000.0);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_oil_pressure)) {
+    return set_number(value, type, 40.0 + 0.01 * m_speed);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_oil_temperature) ||
+      is(name, SCS_TELEMETRY_TRUCK_CHANNEL_water_temperature)) {
+    return set_number(value, type, 85.0 + 5.0 * std::sin(m_time / 300.0));
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_battery_voltage)) {
+    return set_number(value, type, 27.5);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_odometer)) {
+    return set_number(value, type, 120000.0 + m_distance / 1000.0);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_navigation_distance)) {
+    return set_number(value, type, std::max(0.0, 180000.0 - m_distance));
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_navigation_time)) {
+    return set_number(value, type,
+                      std::max(0.0, 180000.0 - m_distance) / HIGHWAY_SPEED);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_navigation_speed_limit)) {
+    return set_number(value, type,
+                      m_profile.stopAndGo ? CITY_SPEED : HIGHWAY_SPEED + 1.0);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_wheel_rotation)) {
+    return set_number(value, type, std::fmod(wheelTurns, 1.0));
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_wheel_velocity)) {
+    return set_number(value, type, wheelVelocity);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_wheel_steering)) {
+    return set_number(value, type, index < 2 ? 0.5 * m_yawRate : 0.0);
+  }
+  if (is(name, SCS_TELEMETRY_TRUCK_CHANNEL_wheel_susp_deflection)) {
+    return set_number(value, type, 0.02 * std::sin(m_distance / 3.0 + index));
+  }
+  /* Everything else stays at rest */
+  return set_number(value, type, 0.0) ||
+         set_placement(value, type, 0.0, 0.0, 0.0, 0.0);
+}
+
+const std::vector<DriveEvent> &DriveSimulation::Configuration() const {
+  static const std::vector<DriveEvent> none;
+  const bool due =
+      m_frame == 0 || (m_profile.configInterval != 0 &&
+                       m_frame % m_profile.configInterval == 0);
+  return due ? m_configuration : none;
+}
+
+const DriveEvent *DriveSimulation::Gameplay() const {
+  if (m_profile.gameplayInterval == 0 || m_frame == 0 ||
+      m_frame % m_profile.gameplayInterval != 0) {
+    return nullptr;
+  }
+  return &m_gameplay[(m_frame / m_profile.gameplayInterval) %
+                     m_gameplay.size()];
+}
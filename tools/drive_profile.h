@@ -0,0 +1,98 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+
+#ifndef DRIVE_PROFILE_H
+#define DRIVE_PROFILE_H
+
+#include "scs_sdk/scssdk_value.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Deterministic synthetic drives for the SDK host. Every channel value is a
+ * function of the simulated time, so two runs of a profile feed the plugin
+ * exactly the same telemetry.
+ */
+struct DriveProfile {
+  const char *name;
+  const char *description;
+  unsigned trailers;
+  unsigned trailerWheels;
+  /* Frames between configuration bursts, 0 for the one at the start */
+  unsigned configInterval;
+  /* Frames between gameplay events, 0 for none */
+  unsigned gameplayInterval;
+  /* Stops at junctions and lights instead of cruising */
+  bool stopAndGo;
+};
+
+/* A configuration or gameplay event, attributes end with a NULL name */
+struct DriveEvent {
+  std::string id;
+  std::vector<scs_named_value_t> attributes;
+};
+
+class DriveSimulation {
+public:
+  static const DriveProfile *Find(std::string_view name);
+  static const std::vector<DriveProfile> &Profiles();
+
+  DriveSimulation(const DriveProfile &profile, double frameSeconds);
+  /* Moves on to the next frame */
+  void Advance();
+  unsigned long long Frame() const { return m_frame; }
+  double Time() const { return m_time; }
+
+  /*
+   * The value of a channel in the current frame, converted to the type it
+   * was registered with. False if the channel has no value to offer.
+   */
+  bool Value(std::string_view name, scs_u32_t index, scs_value_type_t type,
+             scs_value_t *value) const;
+  /* The configuration burst due this frame, empty if there is none */
+  const std::vector<DriveEvent> &Configuration() const;
+  /* The gameplay event due this frame, nullptr if there is none */
+  const DriveEvent *Gameplay() const;
+
+private:
+  const DriveProfile &m_profile;
+  double m_frameSeconds;
+  unsigned long long m_frame = 0;
+  double m_time = 0.0;
+  double m_speed = 0.0;
+  double m_acceleration = 0.0;
+  double m_distance = 0.0;
+  double m_heading = 0.0;
+  double m_yawRate = 0.0;
+  double m_x = 0.0;
+  double m_z = 0.0;
+  double m_throttle = 0.0;
+  double m_brake = 0.0;
+  bool m_blinker = false;
+  bool m_stopped = false;
+  std::vector<DriveEvent> m_configuration;
+  std::vector<DriveEvent> m_gameplay;
+};
+
+#endif
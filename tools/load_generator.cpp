@@ -0,0 +1,1041 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Load generator for the fan-out of the network thread: opens many
+ * connections over TCP, the Unix domain socket and WebSockets, decodes
+ * every message and reports throughput, end-to-end latency, gaps in the
+ * sequence of gameplay events and config messages and reconnects per
+ * client. Meant to run next to tsts_sdk_host on one machine, with the
+ * plugin started with TSTS_TIMESTAMPS=1 so messages carry the monotonic
+ * time the game produced them.
+ *
+ * Usage: tsts_load_generator [options] <count>x<transport>[,key=value...]...
+ * Transports are tcp, unix and ws. Keys are dialect, qos, lod and
+ * compression, sent as commands after connecting, and rate, the messages
+ * per second the client reads at most. E.g. 20xtcp 4xunix,dialect=short
+ * 2xws,qos=reliable,rate=10
+ * Options: --host <address> --port <tcp port> --ws-port <http port>
+ * --unix <path> --seconds <duration> --parse (parse every message fully)
+ */
+
+#include "compression.h"
+#include "latency_histogram.h"
+#include "message_pool.h"
+
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef TSTS_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef TSTS_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+#define DEFAULT_PORT "3101"
+#define DEFAULT_UNIX_SOCKET "/tmp/tstelemetry.sock"
+#define DEFAULT_SECONDS 10
+#define RECONNECT_DELAY_MS 200
+#define RECEIVE_TIMEOUT_MS 100
+/* Sequence numbers that may still arrive out of order */
+#define SEQUENCE_WINDOW 4096
+/* Largest SOCK_SEQPACKET message the plugin sends */
+#define PACKET_BUFFER_SIZE (16 * 1024 * 1024)
+
+using Clock = std::chrono::steady_clock;
+
+enum class Transport { Tcp, Unix, WebSocket };
+
+struct ClientOptions {
+  Transport transport = Transport::Tcp;
+  std::string dialect;
+  std::string qos;
+  std::string lod;
+  std::string compression;
+  /* Messages per second, 0 reads as fast as they come */
+  double rate = 0.0;
+  std::string label;
+};
+
+struct Target {
+  std::string host = "127.0.0.1";
+  std::string port = DEFAULT_PORT;
+  std::string wsPort;
+  std::string unixPath = DEFAULT_UNIX_SOCKET;
+};
+
+/*
+ * Counts the sequence numbers of gameplay events and config messages that
+ * never arrived. Replays after a reconnect may bring them late, so a
+ * number only counts as missing once it has fallen out of the window
+ * behind the highest one seen. Frames are numbered on their own and
+ * skipped by design, they aren't tracked.
+ */
+class SequenceTracker {
+public:
+  bool Started() const { return m_started; }
+  uint64_t Highest() const { return m_highest; }
+  uint64_t Missing() const { return m_missing; }
+  uint64_t Reordered() const { return m_reordered; }
+  uint64_t Duplicates() const { return m_duplicates; }
+
+  void Receive(uint64_t seq) {
+    if (!m_started) {
+      m_started = true;
+      m_highest = seq;
+      m_seen.assign(SEQUENCE_WINDOW, true);
+      return;
+    }
+    if (seq > m_highest) {
+      for (uint64_t s = m_highest + 1; s <= seq; s++) {
+        std::vector<bool>::reference slot = m_seen[s % SEQUENCE_WINDOW];
+        if (!slot) {
+          m_missing++;
+        }
+        slot = s == seq;
+      }
+      m_highest = seq;
+    } else if (m_highest - seq >= SEQUENCE_WINDOW) {
+      /* Counted as missing already, replayed after a reconnect */
+      m_missing = m_missing > 0 ? m_missing - 1 : 0;
+      m_reordered++;
+    } else if (m_seen[seq % SEQUENCE_WINDOW]) {
+      m_duplicates++;
+    } else {
+      m_seen[seq % SEQUENCE_WINDOW] = true;
+      m_reordered++;
+    }
+  }
+
+  /* The numbers still missing in the window count as well */
+  void Finish() {
+    if (m_started) {
+      m_missing += static_cast<uint64_t>(
+          std::count(m_seen.begin(), m_seen.end(), false));
+      m_seen.assign(SEQUENCE_WINDOW, true);
+    }
+  }
+
+private:
+  bool m_started = false;
+  uint64_t m_highest = 0;
+  uint64_t m_missing = 0;
+  uint64_t m_reordered = 0;
+  uint64_t m_duplicates = 0;
+  std::vector<bool> m_seen;
+};
+
+/* Undoes the compression of compression.h, one stream per connection */
+class Decompressor {
+public:
+  explicit Decompressor(Compression compression) : m_compression(compression) {
+#ifdef TSTS_WITH_ZLIB
+    if (compression == Compression::Deflate) {
+      memset(&m_inflate, 0, sizeof(m_inflate));
+      inflateInit2(&m_inflate, -15);
+    }
+#endif
+#ifdef TSTS_WITH_ZSTD
+    if (compression == Compression::Zstd) {
+      m_zstd = ZSTD_createDCtx();
+      ZSTD_DCtx_loadDictionary(m_zstd, FrameDictionary, FrameDictionarySize);
+    }
+#endif
+  }
+  ~Decompressor() {
+#ifdef TSTS_WITH_ZLIB
+    if (m_compression == Compression::Deflate) {
+      inflateEnd(&m_inflate);
+    }
+#endif
+#ifdef TSTS_WITH_ZSTD
+    ZSTD_freeDCtx(m_zstd);
+#endif
+  }
+  Decompressor(const Decompressor &) = delete;
+  Decompressor &operator=(const Decompressor &) = delete;
+
+  static bool Available(Compression compression) {
+    switch (compression) {
+#ifdef TSTS_WITH_ZLIB
+    case Compression::Deflate:
+      return true;
+#endif
+#ifdef TSTS_WITH_ZSTD
+    case Compression::Zstd:
+      return true;
+#endif
+    default:
+      return compression == Compression::None;
+    }
+  }
+
+  /* Replaces out with the message, false if it can't be decoded */
+  bool Decode(std::string_view message, std::string *out) {
+    if (message.empty()) {
+      return false;
+    }
+    const uint8_t flags = static_cast<uint8_t>(message[0]);
+    message.remove_prefix(1);
+    if (flags & COMPRESSION_FLAG_RAW) {
+      out->assign(message);
+      return true;
+    }
+    if (flags & COMPRESSION_FLAG_RESET) {
+      reset();
+      m_synced = true;
+    }
+    if (!m_synced) {
+      return false;
+    }
+    out->clear();
+#ifdef TSTS_WITH_ZLIB
+    if (m_compression == Compression::Deflate) {
+      return inflateMessage(message, out);
+    }
+#endif
+#ifdef TSTS_WITH_ZSTD
+    if (m_compression == Compression::Zstd) {
+      return decompressMessage(message, out);
+    }
+#endif
+    return false;
+  }
+
+private:
+  void reset() {
+#ifdef TSTS_WITH_ZLIB
+    if (m_compression == Compression::Deflate) {
+      inflateReset(&m_inflate);
+      inflateSetDictionary(&m_inflate, FrameDictionary,
+                           static_cast<uInt>(FrameDictionarySize));
+    }
+#endif
+#ifdef TSTS_WITH_ZSTD
+    if (m_compression == Compression::Zstd) {
+      /* Keeps the dictionary */
+      ZSTD_DCtx_reset(m_zstd, ZSTD_reset_session_only);
+    }
+#endif
+  }
+
+#ifdef TSTS_WITH_ZLIB
+  bool inflateMessage(std::string_view message, std::string *out) {
+    m_inflate.next_in =
+        reinterpret_cast<Bytef *>(const_cast<char *>(message.data()));
+    m_inflate.avail_in = static_cast<uInt>(message.size());
+    size_t used = 0;
+    out->resize(message.size() * 8 + 1024);
+    for (;;) {
+      m_inflate.next_out = reinterpret_cast<Bytef *>(out->data() + used);
+      m_inflate.avail_out = static_cast<uInt>(out->size() - used);
+      const int result = inflate(&m_inflate, Z_SYNC_FLUSH);
+      if (result != Z_OK && result != Z_BUF_ERROR) {
+        return false;
+      }
+      used = out->size() - m_inflate.avail_out;
+      if (m_inflate.avail_in == 0 && m_inflate.avail_out != 0) {
+        break;
+      }
+      out->resize(out->size() * 2);
+    }
+    out->resize(used);
+    return true;
+  }
+#endif
+
+#ifdef TSTS_WITH_ZSTD
+  bool decompressMessage(std::string_view message, std::string *out) {
+    ZSTD_inBuffer input = {message.data(), message.size(), 0};
+    out->resize(message.size() * 8 + 1024);
+    ZSTD_outBuffer output = {out->data(), out->size(), 0};
+    for (;;) {
+      const size_t result = ZSTD_decompressStream(m_zstd, &output, &input);
+      if (ZSTD_isError(result)) {
+        return false;
+      }
+      if (input.pos == input.size && output.pos < output.size) {
+        break;
+      }
+      if (output.pos == output.size) {
+        out->resize(out->size() * 2);
+        output.dst = out->data();
+        output.size = out->size();
+      }
+    }
+    out->resize(output.pos);
+    return true;
+  }
+#endif
+
+  Compression m_compression;
+  bool m_synced = false;
+#ifdef TSTS_WITH_ZLIB
+  z_stream m_inflate;
+#endif
+#ifdef TSTS_WITH_ZSTD
+  ZSTD_DCtx *m_zstd = nullptr;
+#endif
+};
+
+enum class ReceiveResult { Message, Timeout, Closed };
+
+/* One connection and its framing, see the Compression section of README */
+class Connection {
+public:
+  ~Connection() { Close(); }
+
+  bool Open(const Target &target, Transport transport) {
+    Close();
+    m_transport = transport;
+    m_buffer.clear();
+    m_offset = 0;
+    m_lengthFramed = false;
+    m_packets = false;
+    if (transport == Transport::Unix) {
+      if (!connectUnix(target.unixPath)) {
+        return false;
+      }
+    } else {
+      const std::string &port =
+          transport == Transport::WebSocket ? target.wsPort : target.port;
+      if (!connectTcp(target.host, port)) {
+        return false;
+      }
+    }
+    timeval timeout = {0, RECEIVE_TIMEOUT_MS * 1000};
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return transport != Transport::WebSocket || handshake(target);
+  }
+
+  void Close() {
+    if (m_socket >= 0) {
+      close(m_socket);
+      m_socket = -1;
+    }
+  }
+
+  /* Everything after the compression answer comes length framed */
+  void SetLengthFramed() { m_lengthFramed = true; }
+
+  bool Send(std::string_view command) {
+    std::string out;
+    if (m_transport == Transport::WebSocket) {
+      /* Client frames are masked, RFC 6455 section 5.3 */
+      const uint8_t mask[4] = {0x37, 0xfa, 0x21, 0x3d};
+      out.push_back(static_cast<char>(0x80 | 0x1));
+      if (command.size() < 126) {
+        out.push_back(static_cast<char>(0x80 | command.size()));
+      } else {
+        out.push_back(static_cast<char>(0x80 | 126));
+        out.push_back(static_cast<char>(command.size() >> 8));
+        out.push_back(static_cast<char>(command.size() & 0xff));
+      }
+      out.append(reinterpret_cast<const char *>(mask), 4);
+      for (size_t i = 0; i < command.size(); i++) {
+        out.push_back(static_cast<char>(command[i] ^ mask[i % 4]));
+      }
+    } else {
+      out.assign(command);
+      if (!m_packets) {
+        out.push_back('\0');
+      }
+    }
+    return sendAll(out);
+  }
+
+  /*
+   * The next message as it came off the wire, still compressed if the
+   * connection is. Valid until the next call.
+   */
+  ReceiveResult Receive(std::string_view *message, size_t *wireBytes) {
+    if (m_packets) {
+      return receivePacket(message, wireBytes);
+    }
+    compact();
+    for (;;) {
+      size_t consumed = 0;
+      if (m_transport == Transport::WebSocket ? parseWebSocket(message,
+                                                               &consumed)
+                                              : parseStream(message,
+                                                            &consumed)) {
+        *wireBytes = consumed;
+        return ReceiveResult::Message;
+      }
+      const ReceiveResult result = fill();
+      if (result != ReceiveResult::Message) {
+        return result;
+      }
+    }
+  }
+
+private:
+  bool connectTcp(const std::string &host, const std::string &port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+      return false;
+    }
+    for (addrinfo *a = addresses; a != nullptr; a = a->ai_next) {
+      m_socket = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+      if (m_socket < 0) {
+        continue;
+      }
+      if (connect(m_socket, a->ai_addr, a->ai_addrlen) == 0) {
+        break;
+      }
+      close(m_socket);
+      m_socket = -1;
+    }
+    freeaddrinfo(addresses);
+    if (m_socket < 0) {
+      return false;
+    }
+    const int one = 1;
+    setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+  }
+
+  /* SOCK_SEQPACKET where the plugin has it, a stream socket otherwise */
+  bool connectUnix(const std::string &path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    for (int type : {SOCK_SEQPACKET, SOCK_STREAM}) {
+      m_socket = socket(AF_UNIX, type, 0);
+      if (m_socket < 0) {
+        continue;
+      }
+      if (connect(m_socket, reinterpret_cast<sockaddr *>(&address),
+                  sizeof(address)) == 0) {
+        m_packets = type == SOCK_SEQPACKET;
+        return true;
+      }
+      close(m_socket);
+      m_socket = -1;
+    }
+    return false;
+  }
+
+  bool handshake(const Target &target) {
+    const std::string request =
+        "GET / HTTP/1.1\r\nHost: " + target.host + ":" + target.wsPort +
+        "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "Sec-WebSocket-Version: 13\r\n\r\n";
+    if (!sendAll(request)) {
+      return false;
+    }
+    const auto deadline = Clock::now() + std::chrono::seconds(2);
+    size_t end;
+    while ((end = m_buffer.find("\r\n\r\n")) == std::string::npos) {
+      if (fill() == ReceiveResult::Closed || Clock::now() > deadline) {
+        return false;
+      }
+    }
+    const bool upgraded = m_buffer.compare(0, 12, "HTTP/1.1 101") == 0;
+    m_offset = end + 4;
+    return upgraded;
+  }
+
+  bool sendAll(std::string_view data) {
+    while (!data.empty()) {
+      const ssize_t sent = send(m_socket, data.data(), data.size(),
+                                MSG_NOSIGNAL);
+      if (sent < 0 && errno == EINTR) {
+        continue;
+      }
+      if (sent <= 0) {
+        return false;
+      }
+      data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+  }
+
+  ReceiveResult fill() {
+    char chunk[65536];
+    const ssize_t received = recv(m_socket, chunk, sizeof(chunk), 0);
+    if (received > 0) {
+      m_buffer.append(chunk, static_cast<size_t>(received));
+      return ReceiveResult::Message;
+    }
+    if (received < 0 &&
+        (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      return ReceiveResult::Timeout;
+    }
+    return ReceiveResult::Closed;
+  }
+
+  void compact() {
+    if (m_offset > 0 && m_offset * 2 >= m_buffer.size()) {
+      m_buffer.erase(0, m_offset);
+      m_offset = 0;
+    }
+  }
+
+  ReceiveResult receivePacket(std::string_view *message, size_t *wireBytes) {
+    m_packet.resize(PACKET_BUFFER_SIZE);
+    const ssize_t received =
+        recv(m_socket, m_packet.data(), m_packet.size(), 0);
+    if (received > 0) {
+      *message = std::string_view(m_packet.data(),
+                                  static_cast<size_t>(received));
+      *wireBytes = static_cast<size_t>(received);
+      return ReceiveResult::Message;
+    }
+    if (received < 0 &&
+        (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      return ReceiveResult::Timeout;
+    }
+    return ReceiveResult::Closed;
+  }
+
+  bool parseStream(std::string_view *message, size_t *consumed) {
+    const std::string_view rest = std::string_view(m_buffer).substr(m_offset);
+    if (m_lengthFramed) {
+      if (rest.size() < 4) {
+        return false;
+      }
+      const auto *header = reinterpret_cast<const uint8_t *>(rest.data());
+      const size_t length = size_t(header[0]) << 24 | size_t(header[1]) << 16 |
+                            size_t(header[2]) << 8 | size_t(header[3]);
+      if (rest.size() < 4 + length) {
+        return false;
+      }
+      *message = rest.substr(4, length);
+      *consumed = 4 + length;
+    } else {
+      const size_t end = rest.find('\0');
+      if (end == std::string_view::npos) {
+        return false;
+      }
+      *message = rest.substr(0, end);
+      *consumed = end + 1;
+    }
+    m_offset += *consumed;
+    return true;
+  }
+
+  /* Server frames aren't masked, fragments are put together */
+  bool parseWebSocket(std::string_view *message, size_t *consumed) {
+    *consumed = 0;
+    for (;;) {
+      const std::string_view rest =
+          std::string_view(m_buffer).substr(m_offset);
+      if (rest.size() < 2) {
+        return false;
+      }
+      const auto *header = reinterpret_cast<const uint8_t *>(rest.data());
+      const bool fin = header[0] & 0x80;
+      const uint8_t opcode = header[0] & 0x0f;
+      size_t length = header[1] & 0x7f;
+      size_t used = 2;
+      if (length == 126) {
+        if (rest.size() < 4) {
+          return false;
+        }
+        length = size_t(header[2]) << 8 | header[3];
+        used = 4;
+      } else if (length == 127) {
+        if (rest.size() < 10) {
+          return false;
+        }
+        length = 0;
+        for (int i = 0; i < 8; i++) {
+          length = length << 8 | header[2 + i];
+        }
+        used = 10;
+      }
+      if (rest.size() < used + length) {
+        return false;
+      }
+      const std::string_view payload = rest.substr(used, length);
+      m_offset += used + length;
+      *consumed += used + length;
+      if (opcode == 0x9) {
+        /* Ping, the plugin doesn't send them but a proxy might */
+        continue;
+      }
+      if (opcode == 0x8) {
+        m_message.clear();
+        *message = m_message;
+        return true;
+      }
+      if (opcode != 0x0) {
+        m_message.clear();
+      }
+      m_message.append(payload);
+      if (fin) {
+        *message = m_message;
+        return true;
+      }
+    }
+  }
+
+  int m_socket = -1;
+  Transport m_transport = Transport::Tcp;
+  bool m_lengthFramed = false;
+  bool m_packets = false;
+  std::string m_buffer;
+  size_t m_offset = 0;
+  std::string m_message;
+  std::string m_packet;
+};
+
+/* The top level fields the plugin appends after the payload */
+struct Envelope {
+  std::string_view type;
+  uint64_t seq = 0;
+  int64_t timestamp = 0;
+};
+
+bool read_number(std::string_view message, std::string_view key,
+                 size_t from, int64_t *value) {
+  const size_t at = message.find(key, from);
+  if (at == std::string_view::npos) {
+    return false;
+  }
+  const char *start = message.data() + at + key.size();
+  return std::from_chars(start, message.data() + message.size(), *value).ec ==
+         std::errc();
+}
+
+/*
+ * The keys are sorted and the payload comes first, so the envelope is
+ * found from the end without parsing the frame.
+ */
+bool read_envelope(std::string_view message, Envelope *envelope) {
+  static const std::string_view typeKey = "\"payloadType\":\"";
+  const size_t at = message.rfind(typeKey);
+  if (at == std::string_view::npos) {
+    return false;
+  }
+  const size_t start = at + typeKey.size();
+  const size_t end = message.find('"', start);
+  if (end == std::string_view::npos) {
+    return false;
+  }
+  envelope->type = message.substr(start, end - start);
+  int64_t value = 0;
+  envelope->seq =
+      read_number(message, "\"seq\":", end, &value) ? uint64_t(value) : 0;
+  envelope->timestamp =
+      read_number(message, "\"timestamp\":", end, &value) ? value : 0;
+  return true;
+}
+
+struct ClientStats {
+  uint64_t messages = 0;
+  uint64_t frames = 0;
+  uint64_t events = 0;
+  uint64_t bytes = 0;
+  uint64_t invalid = 0;
+  uint64_t reconnects = 0;
+  /* Closed before the first message, e.g. beyond MAX_CLIENTS */
+  uint64_t refused = 0;
+  uint64_t failedConnects = 0;
+  uint64_t resumed = 0;
+  uint64_t resynced = 0;
+  uint64_t tierChanges = 0;
+  LatencyHistogram latency;
+  SequenceTracker sequence;
+};
+
+class Client {
+public:
+  Client(const Target &target, const ClientOptions &options, bool parse)
+      : m_target(target), m_options(options), m_parse(parse) {}
+
+  const ClientOptions &Options() const { return m_options; }
+  const ClientStats &Stats() const { return m_stats; }
+
+  void Run(Clock::time_point deadline) {
+    bool connected = false;
+    auto nextRead = Clock::now();
+    while (Clock::now() < deadline) {
+      if (!connected) {
+        connected = connect();
+        if (!connected) {
+          m_stats.failedConnects++;
+          std::this_thread::sleep_for(
+              std::chrono::milliseconds(RECONNECT_DELAY_MS));
+          continue;
+        }
+      }
+      std::string_view message;
+      size_t wireBytes = 0;
+      const ReceiveResult result = m_connection.Receive(&message, &wireBytes);
+      if (result == ReceiveResult::Timeout) {
+        continue;
+      }
+      if (result == ReceiveResult::Closed || message.empty()) {
+        /* Dropped by the plugin, e.g. for falling too far behind */
+        connected = false;
+        m_connection.Close();
+        (m_received ? m_stats.reconnects : m_stats.refused)++;
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(RECONNECT_DELAY_MS));
+        continue;
+      }
+      m_received = true;
+      m_stats.bytes += wireBytes;
+      if (!handle(message)) {
+        m_stats.invalid++;
+      }
+      if (m_options.rate > 0) {
+        nextRead += std::chrono::nanoseconds(
+            static_cast<int64_t>(1e9 / m_options.rate));
+        std::this_thread::sleep_until(nextRead);
+      }
+    }
+    m_connection.Close();
+    m_stats.sequence.Finish();
+  }
+
+private:
+  bool connect() {
+    if (!m_connection.Open(m_target, m_options.transport)) {
+      return false;
+    }
+    m_bundle = false;
+    m_received = false;
+    m_decompressor.reset();
+    std::string commands[] = {
+        m_options.qos.empty() ? "" : "{\"qos\":\"" + m_options.qos + "\"}",
+        m_options.lod.empty() ? "" : "{\"lod\":\"" + m_options.lod + "\"}",
+        m_options.dialect.empty()
+            ? ""
+            : "{\"dialect\":\"" + m_options.dialect + "\"}",
+        m_options.compression.empty()
+            ? ""
+            : "{\"compression\":\"" + m_options.compression + "\"}",
+    };
+    for (const std::string &command : commands) {
+      if (!command.empty() && !m_connection.Send(command)) {
+        return false;
+      }
+    }
+    /* Picks up the gameplay events sent while it was away */
+    m_replaying = m_session != 0 && m_stats.sequence.Started();
+    if (m_replaying) {
+      const std::string resume =
+          "{\"resume\":" + std::to_string(m_stats.sequence.Highest()) +
+          ",\"session\":" + std::to_string(m_session) + "}";
+      if (!m_connection.Send(resume)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool handle(std::string_view message) {
+    if (m_decompressor != nullptr) {
+      if (!m_decompressor->Decode(message, &m_decoded)) {
+        return false;
+      }
+      message = m_decoded;
+    }
+    const int64_t now = message_clock_ns();
+    m_stats.messages++;
+    if (m_parse &&
+        nlohmann::json::parse(message, nullptr, false).is_discarded()) {
+      return false;
+    }
+    Envelope envelope;
+    if (!read_envelope(message, &envelope)) {
+      return false;
+    }
+    if (envelope.type == "snapshot") {
+      int64_t session = 0;
+      if (read_number(message, "\"session\":", 0, &session)) {
+        m_session = static_cast<uint64_t>(session);
+      }
+      m_bundle = true;
+      return true;
+    }
+    if (envelope.type == "compression") {
+      Compression compression = Compression::None;
+      if (message.find("\"compression\":\"none\"") == std::string_view::npos &&
+          MessageCompressor::Parse(m_options.compression, &compression)) {
+        m_decompressor = std::make_unique<Decompressor>(compression);
+        m_connection.SetLengthFramed();
+      }
+      return true;
+    }
+    if (envelope.type == "resume" || envelope.type == "resync") {
+      m_replaying = false;
+      (envelope.type == "resume" ? m_stats.resumed : m_stats.resynced)++;
+      return true;
+    }
+    if (envelope.type == "lod") {
+      m_stats.tierChanges++;
+      return true;
+    }
+    if (envelope.seq == 0) {
+      /* Answers to commands and dialect headers */
+      return true;
+    }
+    const bool frame = envelope.type == "frame";
+    (frame ? m_stats.frames : m_stats.events)++;
+    /*
+     * Replayed messages come before the snapshot message, the bundle ends
+     * with the latest frame and live messages follow it
+     */
+    if (m_bundle) {
+      m_bundle = !frame;
+      return true;
+    }
+    if (!frame) {
+      m_stats.sequence.Receive(envelope.seq);
+    }
+    if (envelope.timestamp != 0 && !m_replaying) {
+      m_stats.latency.Record(now - envelope.timestamp);
+    }
+    return true;
+  }
+
+  const Target &m_target;
+  ClientOptions m_options;
+  bool m_parse;
+  Connection m_connection;
+  std::unique_ptr<Decompressor> m_decompressor;
+  std::string m_decoded;
+  bool m_bundle = false;
+  bool m_received = false;
+  bool m_replaying = false;
+  uint64_t m_session = 0;
+  ClientStats m_stats;
+};
+
+bool parse_group(std::string_view spec, unsigned *count,
+                 ClientOptions *options) {
+  const size_t x = spec.find('x');
+  if (x == std::string_view::npos ||
+      std::from_chars(spec.data(), spec.data() + x, *count).ec !=
+          std::errc() ||
+      *count == 0) {
+    return false;
+  }
+  options->label = std::string(spec.substr(x + 1));
+  spec.remove_prefix(x + 1);
+  const size_t comma = spec.find(',');
+  const std::string_view transport = spec.substr(0, comma);
+  if (transport == "tcp") {
+    options->transport = Transport::Tcp;
+  } else if (transport == "unix") {
+    options->transport = Transport::Unix;
+  } else if (transport == "ws") {
+    options->transport = Transport::WebSocket;
+  } else {
+    return false;
+  }
+  spec = comma == std::string_view::npos ? std::string_view()
+                                         : spec.substr(comma + 1);
+  while (!spec.empty()) {
+    const size_t next = spec.find(',');
+    const std::string_view pair = spec.substr(0, next);
+    spec = next == std::string_view::npos ? std::string_view()
+                                          : spec.substr(next + 1);
+    const size_t equals = pair.find('=');
+    if (equals == std::string_view::npos) {
+      return false;
+    }
+    const std::string_view key = pair.substr(0, equals);
+    const std::string value(pair.substr(equals + 1));
+    if (key == "dialect") {
+      options->dialect = value;
+    } else if (key == "qos") {
+      options->qos = value;
+    } else if (key == "lod") {
+      options->lod = value;
+    } else if (key == "compression") {
+      Compression compression;
+      if (!MessageCompressor::Parse(value, &compression) ||
+          !Decompressor::Available(compression)) {
+        fprintf(stderr, "compression %s isn't built in\n", value.c_str());
+        return false;
+      }
+      options->compression = value;
+    } else if (key == "rate") {
+      options->rate = atof(value.c_str());
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+void usage() {
+  fprintf(stderr,
+          "usage: tsts_load_generator [--host address] [--port port] "
+          "[--ws-port port]\n"
+          "         [--unix path] [--seconds duration] [--parse] "
+          "<count>x<transport>[,key=value...]...\n"
+          "transports: tcp, unix, ws\n"
+          "keys: dialect, qos, lod, compression, rate (messages per "
+          "second)\n");
+}
+
+double us(uint64_t nanoseconds) {
+  return static_cast<double>(nanoseconds) / 1e3;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Target target;
+  double seconds = DEFAULT_SECONDS;
+  bool parse = false;
+  std::vector<std::pair<unsigned, ClientOptions>> groups;
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--host" && hasValue) {
+      target.host = argv[++i];
+    } else if (arg == "--port" && hasValue) {
+      target.port = argv[++i];
+    } else if (arg == "--ws-port" && hasValue) {
+      target.wsPort = argv[++i];
+    } else if (arg == "--unix" && hasValue) {
+      target.unixPath = argv[++i];
+    } else if (arg == "--seconds" && hasValue) {
+      seconds = atof(argv[++i]);
+    } else if (arg == "--parse") {
+      parse = true;
+    } else {
+      unsigned count = 0;
+      ClientOptions options;
+      if (!parse_group(arg, &count, &options)) {
+        fprintf(stderr, "can't read %s\n", argv[i]);
+        usage();
+        return 1;
+      }
+      if (options.transport == Transport::WebSocket && target.wsPort.empty()) {
+        fprintf(stderr, "ws clients need --ws-port, see TSTS_HTTP_PORT\n");
+        return 1;
+      }
+      groups.emplace_back(count, options);
+    }
+  }
+  if (groups.empty()) {
+    usage();
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<Client>> clients;
+  for (const auto &[count, options] : groups) {
+    for (unsigned c = 0; c < count; c++) {
+      clients.push_back(std::make_unique<Client>(target, options, parse));
+    }
+  }
+  const auto start = Clock::now();
+  const auto deadline =
+      start + std::chrono::nanoseconds(static_cast<int64_t>(seconds * 1e9));
+  std::vector<std::thread> threads;
+  for (std::unique_ptr<Client> &client : clients) {
+    threads.emplace_back([&client, deadline]() { client->Run(deadline); });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  const double elapsed =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  printf("%zu clients for %.1f s\n", clients.size(), elapsed);
+  printf("%4s %-28s %8s %8s %7s %9s %9s %9s %7s %6s %5s %6s %7s\n", "#",
+         "client", "msgs/s", "frames/s", "MB/s", "p50 us", "p99 us",
+         "p999 us", "gaps", "reord", "dups", "reconn", "refused");
+  LatencyHistogram total;
+  ClientStats sum;
+  for (size_t i = 0; i < clients.size(); i++) {
+    const ClientStats &stats = clients[i]->Stats();
+    printf("%4zu %-28s %8.1f %8.1f %7.2f %9.1f %9.1f %9.1f %7llu %6llu "
+           "%5llu %6llu %7llu\n",
+           i, clients[i]->Options().label.c_str(),
+           static_cast<double>(stats.messages) / elapsed,
+           static_cast<double>(stats.frames) / elapsed,
+           static_cast<double>(stats.bytes) / elapsed / 1e6,
+           us(stats.latency.Percentile(0.5)),
+           us(stats.latency.Percentile(0.99)),
+           us(stats.latency.Percentile(0.999)),
+           static_cast<unsigned long long>(stats.sequence.Missing()),
+           static_cast<unsigned long long>(stats.sequence.Reordered()),
+           static_cast<unsigned long long>(stats.sequence.Duplicates()),
+           static_cast<unsigned long long>(stats.reconnects),
+           static_cast<unsigned long long>(stats.refused));
+    total.Merge(stats.latency);
+    sum.messages += stats.messages;
+    sum.frames += stats.frames;
+    sum.bytes += stats.bytes;
+    sum.invalid += stats.invalid;
+    sum.reconnects += stats.reconnects;
+    sum.refused += stats.refused;
+    sum.failedConnects += stats.failedConnects;
+    sum.resumed += stats.resumed;
+    sum.resynced += stats.resynced;
+    sum.tierChanges += stats.tierChanges;
+  }
+  printf("total: %.1f msgs/s, %.1f frames/s, %.2f MB/s, %llu undecodable, "
+         "%llu reconnects (%llu resumed, %llu resynced), %llu refused and "
+         "%llu failed connects, %llu detail tier changes\n",
+         static_cast<double>(sum.messages) / elapsed,
+         static_cast<double>(sum.frames) / elapsed,
+         static_cast<double>(sum.bytes) / elapsed / 1e6,
+         static_cast<unsigned long long>(sum.invalid),
+         static_cast<unsigned long long>(sum.reconnects),
+         static_cast<unsigned long long>(sum.resumed),
+         static_cast<unsigned long long>(sum.resynced),
+         static_cast<unsigned long long>(sum.refused),
+         static_cast<unsigned long long>(sum.failedConnects),
+         static_cast<unsigned long long>(sum.tierChanges));
+  if (total.Count() > 0) {
+    total.Print(stdout, "end-to-end latency, all clients");
+  } else {
+    printf("no timestamps, start the plugin with TSTS_TIMESTAMPS=1\n");
+  }
+  return 0;
+}
@@ -0,0 +1,194 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by the
+Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the
+GNU Lesser General Public License along with TSTelemetryServer.
+If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Stands in for the game: loads the plugin library, initializes it the way
+ * ETS2 does and drives it with one of the synthetic drives in
+ * drive_profile.h, so the whole plugin, network thread included, can be
+ * profiled and load tested without the game.
+ * Usage: tsts_sdk_host <plugin library> [profile] [frames] [frames per
+ * second, 0 runs flat out]. Without arguments it lists the profiles.
+ */
+
+#include "drive_profile.h"
+#include "latency_histogram.h"
+#include "sdk_stub.h"
+
+#include "scs_sdk/scssdk_telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#define HOST_DEFAULT_PROFILE "highway"
+#define HOST_DEFAULT_FRAMES 3600
+#define HOST_DEFAULT_RATE 60
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+typedef SCSAPI_RESULT (*InitFunction)(const scs_u32_t,
+                                      const scs_telemetry_init_params_t *);
+typedef SCSAPI_VOID (*ShutdownFunction)();
+
+uint64_t elapsed_ns(Clock::time_point start) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           start)
+          .count());
+}
+
+void usage() {
+  fprintf(stderr, "usage: tsts_sdk_host <plugin library> [profile] [frames] "
+                  "[frames per second, 0 runs flat out]\nprofiles:\n");
+  for (const DriveProfile &profile : DriveSimulation::Profiles()) {
+    fprintf(stderr, "  %-14s %s\n", profile.name, profile.description);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    usage();
+    return 1;
+  }
+  const char *profileName = argc > 2 ? argv[2] : HOST_DEFAULT_PROFILE;
+  const long long frames = argc > 3 ? atoll(argv[3]) : HOST_DEFAULT_FRAMES;
+  const double rate = argc > 4 ? atof(argv[4]) : HOST_DEFAULT_RATE;
+  const DriveProfile *profile = DriveSimulation::Find(profileName);
+  if (profile == nullptr) {
+    fprintf(stderr, "unknown profile %s\n", profileName);
+    usage();
+    return 1;
+  }
+
+#ifdef _WIN32
+  HMODULE library = LoadLibraryA(argv[1]);
+  if (library == nullptr) {
+    fprintf(stderr, "can't load %s: error %lu\n", argv[1], GetLastError());
+    return 1;
+  }
+  auto init = reinterpret_cast<InitFunction>(
+      GetProcAddress(library, "scs_telemetry_init"));
+  auto shutdown = reinterpret_cast<ShutdownFunction>(
+      GetProcAddress(library, "scs_telemetry_shutdown"));
+#else
+  void *library = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+  if (library == nullptr) {
+    fprintf(stderr, "can't load %s: %s\n", argv[1], dlerror());
+    return 1;
+  }
+  auto init = reinterpret_cast<InitFunction>(
+      dlsym(library, "scs_telemetry_init"));
+  auto shutdown = reinterpret_cast<ShutdownFunction>(
+      dlsym(library, "scs_telemetry_shutdown"));
+#endif
+  if (init == nullptr || shutdown == nullptr) {
+    fprintf(stderr, "%s is not a telemetry plugin\n", argv[1]);
+    return 1;
+  }
+
+  scs_telemetry_init_params_v101_t params;
+  SdkStub::FillParams(&params);
+  const auto initStart = Clock::now();
+  if (init(SCS_TELEMETRY_VERSION_1_01, &params) != SCS_RESULT_ok) {
+    fprintf(stderr, "scs_telemetry_init failed\n");
+    return 1;
+  }
+  const uint64_t initNs = elapsed_ns(initStart);
+
+  const double frameSeconds = rate > 0 ? 1.0 / rate : 1.0 / HOST_DEFAULT_RATE;
+  DriveSimulation drive(*profile, frameSeconds);
+  LatencyHistogram frameTimes;
+  LatencyHistogram frameEndTimes;
+  LatencyHistogram configTimes;
+  size_t channelCalls = 0;
+  const auto start = Clock::now();
+  auto deadline = start;
+
+  /* The game is paused while it loads, the simulation starts with the drive */
+  SdkStub::Fire(SCS_TELEMETRY_EVENT_started, nullptr);
+  for (long long f = 0; f < frames; ++f) {
+    const auto frameStart = Clock::now();
+    const std::vector<DriveEvent> &configuration = drive.Configuration();
+    if (!configuration.empty()) {
+      for (const DriveEvent &config : configuration) {
+        SdkStub::SendConfiguration(config);
+      }
+      configTimes.Record(elapsed_ns(frameStart));
+    }
+    scs_telemetry_frame_start_t frameInfo = {};
+    frameInfo.flags = f == 0 ? SCS_TELEMETRY_FRAME_START_FLAG_timer_restart : 0;
+    const auto time = static_cast<scs_timestamp_t>(drive.Time() * 1e6);
+    frameInfo.render_time = time;
+    frameInfo.simulation_time = time;
+    frameInfo.paused_simulation_time = time;
+    SdkStub::Fire(SCS_TELEMETRY_EVENT_frame_start, &frameInfo);
+    if (const DriveEvent *gameplay = drive.Gameplay()) {
+      SdkStub::SendGameplay(*gameplay);
+    }
+    channelCalls += SdkStub::SendChannels(drive);
+    const auto frameEnd = Clock::now();
+    SdkStub::Fire(SCS_TELEMETRY_EVENT_frame_end, nullptr);
+    frameEndTimes.Record(elapsed_ns(frameEnd));
+    frameTimes.Record(elapsed_ns(frameStart));
+    drive.Advance();
+    if (rate > 0) {
+      deadline += std::chrono::nanoseconds(static_cast<long long>(1e9 / rate));
+      std::this_thread::sleep_until(deadline);
+    }
+  }
+  SdkStub::Fire(SCS_TELEMETRY_EVENT_paused, nullptr);
+  const double seconds = static_cast<double>(elapsed_ns(start)) / 1e9;
+
+  printf("profile %s, %lld frames in %.2f s (%.0f frames/s)\n", profile->name,
+         frames, seconds, static_cast<double>(frames) / seconds);
+  printf("init %.2f ms, %zu channels registered at the end (%zu in all), "
+         "%.1f callbacks per frame\n",
+         static_cast<double>(initNs) / 1e6, SdkStub::ChannelCount(),
+         SdkStub::ChannelRegistrations(),
+         frames > 0 ? static_cast<double>(channelCalls) /
+                          static_cast<double>(frames)
+                    : 0.0);
+  frameTimes.Print(stdout, "whole frame, events and channels");
+  frameEndTimes.Print(stdout, "frame_end callback");
+  if (configTimes.Count() > 0) {
+    configTimes.Print(stdout, "configuration burst");
+  }
+  fflush(stdout);
+
+  shutdown();
+#ifdef _WIN32
+  FreeLibrary(library);
+#else
+  dlclose(library);
+#endif
+  return 0;
+}
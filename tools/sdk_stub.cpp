@@ -0,0 +1,179 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+#include "sdk_stub.h"
+
+#include "scs_sdk/eurotrucks2/scssdk_eut2.h"
+#include "scs_sdk/eurotrucks2/scssdk_telemetry_eut2.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct EventRegistration {
+  scs_telemetry_event_callback_t callback = nullptr;
+  scs_context_t context = nullptr;
+};
+
+struct ChannelRegistration {
+  std::string name;
+  scs_u32_t index;
+  scs_value_type_t type;
+  scs_u32_t flags;
+  scs_telemetry_channel_callback_t callback;
+  scs_context_t context;
+  /* What the plugin saw last, callbacks without each_frame only get changes */
+  scs_value_t last;
+  bool delivered;
+};
+
+EventRegistration events[SCS_TELEMETRY_EVENT_gameplay + 1];
+std::vector<ChannelRegistration> channels;
+size_t channelRegistrations = 0;
+
+SCSAPI_VOID log_message(const scs_log_type_t type, const scs_string_t message) {
+  const char *prefix = type == SCS_LOG_TYPE_error     ? "error"
+                       : type == SCS_LOG_TYPE_warning ? "warning"
+                                                      : "message";
+  fprintf(stderr, "[%s] %s\n", prefix, message);
+}
+
+SCSAPI_RESULT register_event(const scs_event_t event,
+                             const scs_telemetry_event_callback_t callback,
+                             const scs_context_t context) {
+  if (event == SCS_TELEMETRY_EVENT_invalid ||
+      event > SCS_TELEMETRY_EVENT_gameplay) {
+    return SCS_RESULT_unsupported;
+  }
+  if (events[event].callback != nullptr) {
+    return SCS_RESULT_already_registered;
+  }
+  events[event] = {callback, context};
+  return SCS_RESULT_ok;
+}
+
+SCSAPI_RESULT unregister_event(const scs_event_t event) {
+  if (event == SCS_TELEMETRY_EVENT_invalid ||
+      event > SCS_TELEMETRY_EVENT_gameplay ||
+      events[event].callback == nullptr) {
+    return SCS_RESULT_not_found;
+  }
+  events[event] = {};
+  return SCS_RESULT_ok;
+}
+
+std::vector<ChannelRegistration>::iterator
+find_channel(scs_string_t name, scs_u32_t index, scs_value_type_t type) {
+  for (auto it = channels.begin(); it != channels.end(); ++it) {
+    if (it->index == index && it->type == type && it->name == name) {
+      return it;
+    }
+  }
+  return channels.end();
+}
+
+SCSAPI_RESULT
+register_channel(const scs_string_t name, const scs_u32_t index,
+                 const scs_value_type_t type, const scs_u32_t flags,
+                 const scs_telemetry_channel_callback_t callback,
+                 const scs_context_t context) {
+  if (find_channel(name, index, type) != channels.end()) {
+    return SCS_RESULT_already_registered;
+  }
+  ChannelRegistration channel = {name, index, type, flags, callback,
+                                 context, {}, false};
+  channels.push_back(std::move(channel));
+  channelRegistrations++;
+  return SCS_RESULT_ok;
+}
+
+SCSAPI_RESULT unregister_channel(const scs_string_t name,
+                                 const scs_u32_t index,
+                                 const scs_value_type_t type) {
+  auto it = find_channel(name, index, type);
+  if (it == channels.end()) {
+    return SCS_RESULT_not_found;
+  }
+  channels.erase(it);
+  return SCS_RESULT_ok;
+}
+
+} // namespace
+
+void SdkStub::FillParams(scs_telemetry_init_params_v101_t *params) {
+  *params = {};
+  params->common.game_name = "Euro Truck Simulator 2";
+  params->common.game_id = SCS_GAME_ID_EUT2;
+  params->common.game_version = SCS_TELEMETRY_EUT2_GAME_VERSION_CURRENT;
+  params->common.log = log_message;
+  params->register_for_event = register_event;
+  params->unregister_from_event = unregister_event;
+  params->register_for_channel = register_channel;
+  params->unregister_from_channel = unregister_channel;
+}
+
+void SdkStub::Fire(scs_event_t event, const void *info) {
+  if (events[event].callback != nullptr) {
+    events[event].callback(event, info, events[event].context);
+  }
+}
+
+void SdkStub::SendConfiguration(const DriveEvent &config) {
+  scs_telemetry_configuration_t info;
+  info.id = config.id.c_str();
+  info.attributes = config.attributes.data();
+  Fire(SCS_TELEMETRY_EVENT_configuration, &info);
+}
+
+void SdkStub::SendGameplay(const DriveEvent &gameplay) {
+  scs_telemetry_gameplay_event_t info;
+  info.id = gameplay.id.c_str();
+  info.attributes = gameplay.attributes.data();
+  Fire(SCS_TELEMETRY_EVENT_gameplay, &info);
+}
+
+size_t SdkStub::SendChannels(const DriveSimulation &drive) {
+  size_t calls = 0;
+  scs_value_t value;
+  for (ChannelRegistration &channel : channels) {
+    if (!drive.Value(channel.name, channel.index, channel.type, &value)) {
+      continue;
+    }
+    const bool changed = !channel.delivered ||
+                         memcmp(&value, &channel.last, sizeof(value)) != 0;
+    if (!changed && !(channel.flags & SCS_TELEMETRY_CHANNEL_FLAG_each_frame)) {
+      continue;
+    }
+    channel.last = value;
+    channel.delivered = true;
+    channel.callback(channel.name.c_str(), channel.index, &value,
+                     channel.context);
+    calls++;
+  }
+  return calls;
+}
+
+size_t SdkStub::ChannelCount() { return channels.size(); }
+
+size_t SdkStub::ChannelRegistrations() { return channelRegistrations; }
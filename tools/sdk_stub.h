@@ -0,0 +1,49 @@
+/*
+This file is part of TSTelemetryServer.
+
+Copyright (C) 2024 OrkenWhite.
+
+TSTelemetryServer is free software: you can redistribute it and/or modify it 
+under the terms of the GNU Lesser General Public License as published by the 
+Free Software Foundation, either version 3 of the License, 
+or (at your option) any later version.
+
+TSTelemetryServer is distributed in the hope that it will be useful, 
+but WITHOUT ANY WARRANTY; without even the implied warranty of 
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the 
+GNU Lesser General Public License along with TSTelemetryServer. 
+If not, see <https://www.gnu.org/licenses/>. 
+*/
+
+#ifndef SDK_STUB_H
+#define SDK_STUB_H
+
+#include "drive_profile.h"
+
+#include "scs_sdk/scssdk_telemetry.h"
+
+#include <cstddef>
+
+/*
+ * The game's side of the telemetry SDK, for the SDK host and the
+ * benchmarks that drive the plugin: keeps the registrations of the plugin
+ * and calls its callbacks like the game does, with the values of a
+ * DriveSimulation. Single threaded, like the game's callbacks.
+ */
+namespace SdkStub {
+/* Fills in the game, the log and the registration functions */
+void FillParams(scs_telemetry_init_params_v101_t *params);
+void Fire(scs_event_t event, const void *info);
+void SendConfiguration(const DriveEvent &config);
+void SendGameplay(const DriveEvent &gameplay);
+/* Hands the new values to the plugin, returns the callbacks made */
+size_t SendChannels(const DriveSimulation &drive);
+size_t ChannelCount();
+/* Every registration so far, including the channels dropped since */
+size_t ChannelRegistrations();
+} // namespace SdkStub
+
+#endif
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""
+Trains the compression dictionary for frames, see "Compression" in README.md.
+
+Synthetic messages are derived from example_frame.json and
+example_config.json by jittering every number the way the game does (single
+precision floats printed as doubles). Frames connect a varying number of
+trailers, listed as the plugin lists them. The zstd CLI trains on them.
+
+usage: tools/train_dictionary.py [output] [dictionary id]
+"""
+
+import json
+import os
+import random
+import struct
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+SAMPLES = 2000
+CONFIG_SAMPLES = 500  # Sent on every change and to every new client
+DICTIONARY_SIZE = 32768  # All of it fits the deflate window
+
+
+def as_float32(value):
+    return struct.unpack("f", struct.pack("f", value))[0]
+
+
+def jitter(node, rng, zero):
+    if isinstance(node, dict):
+        return {key: jitter(value, rng, zero) for key, value in node.items()}
+    if isinstance(node, list):
+        return [jitter(value, rng, zero) for value in node]
+    if isinstance(node, bool):
+        return False if zero else (node if rng.random() < 0.9 else not node)
+    if isinstance(node, int):
+        return 0 if zero else max(0, node + rng.randint(-3, 3))
+    if isinstance(node, float):
+        if zero:
+            return 0.0
+        scale = rng.choice([0.01, 1.0, 100.0, 10000.0])
+        return as_float32(node + rng.uniform(-1.0, 1.0) * scale)
+    return node
+
+
+def serialized(message, rng):
+    message["seq"] = rng.randint(1, 1 << 24)
+    return json.dumps(message, separators=(",", ":"), sort_keys=True,
+                      ensure_ascii=False)
+
+
+def synthetic_frame(example, rng):
+    frame = json.loads(json.dumps(example))
+    payload = frame["payload"]
+    connected = rng.choice([0, 0, 1, 1, 1, 2, 3])
+    payload["truck"] = jitter(payload["truck"], rng, False)
+    trailer = payload["trailer"][0]
+    payload["trailer"] = [
+        jitter(trailer, rng, False) for _ in range(connected)
+    ]
+    for trailer in payload["trailer"]:
+        trailer["connected"] = True
+    payload["configVersion"] = rng.randint(1, 1 << 10)
+    payload["gameTime"] = rng.randint(0, 1 << 20)
+    payload["paused"] = rng.random() < 0.1
+    payload["idle"] = payload["paused"]
+    return serialized(frame, rng)
+
+
+def synthetic_config(examples, rng):
+    config = jitter(rng.choice(examples), rng, False)
+    payload = config["payload"]
+    payload["version"] = rng.randint(1, 1 << 10)
+    if "index" in payload:
+        payload["index"] = rng.randint(0, 3)
+    return serialized(config, rng)
+
+
+def main():
+    output = sys.argv[1] if len(sys.argv) > 1 else os.path.join(
+        ROOT, "dictionaries", "frame_v2.zdict")
+    dictionary_id = sys.argv[2] if len(sys.argv) > 2 else "2"
+    with open(os.path.join(ROOT, "example_frame.json")) as f:
+        example = json.load(f)
+    with open(os.path.join(ROOT, "example_config.json")) as f:
+        configs = json.load(f)
+    rng = random.Random(3101)
+    with tempfile.TemporaryDirectory() as samples:
+        for i in range(SAMPLES + CONFIG_SAMPLES):
+            with open(os.path.join(samples, "%05d.json" % i), "w",
+                      encoding="utf-8") as f:
+                f.write(synthetic_frame(example, rng) if i < SAMPLES else
+                        synthetic_config(configs, rng))
+        subprocess.check_call([
+            "zstd", "--train", "-q", "-r", samples, "-o", output,
+            "--maxdict=%d" % DICTIONARY_SIZE, "--dictID=" + dictionary_id
+        ])
+
+
+if __name__ == "__main__":
+    main()